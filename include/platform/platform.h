@@ -46,8 +46,39 @@
 #define PLATFORM_WF_RESIZABLE 8  // window is resizable using cursor
 #define PLATFORM_WF_UNMAPPED  16 // will start unmapped
 
+// MF = memory flag
+
+#define PLATFORM_MF_NORMAL     0
+#define PLATFORM_MF_HUGE_PAGES 1  // falls back to transparent huge pages, then normal pages
+#define PLATFORM_MF_PREFAULT   2  // back every page now instead of on first touch
+#define PLATFORM_MF_SEQUENTIAL 4  // access pattern hints
+#define PLATFORM_MF_RANDOM     8
+#define PLATFORM_MF_WILLNEED   16
+
+// SF = settings flag
+
+// window system events are read and translated on a background thread as they
+// arrive, platform_poll_event and platform_wait_events then never touch the
+// window system and platform_handle_events does nothing. events have to be
+// polled from the thread that destroys windows
+// NOTE: only implemented on linux, ignored elsewhere
+#define PLATFORM_SF_EVENT_THREAD 1
+
+// the window system library used on linux, ignored elsewhere
+#define PLATFORM_BACKEND_DEFAULT  0 // xlib
+#define PLATFORM_BACKEND_XLIB     1
+// requests that have a reply are sent without waiting and only
+// collected when the reply is needed.
+// NOTE: never sends PLATFORM_EVENT_RAW_MOTION, it does not link xcb-xinput
+#define PLATFORM_BACKEND_XCB      2
+// windows only exist in memory and events come from platform_headless_inject_event,
+// needs no window system at all
+#define PLATFORM_BACKEND_HEADLESS 3
+
 typedef struct {
-	char* app_name;
+	char*    app_name;
+	uint32_t flags;
+	uint32_t backend;
 } platform_settings_t;
 
 typedef struct platform_window_t platform_window_t;
@@ -77,30 +108,472 @@ platform_window_t* platform_create_window(const platform_window_create_info_t cr
 void platform_destroy_window(platform_window_t* window, platform_allocation_callbacks_t* allocator);
 void platform_get_window_position(const platform_window_t* window, int32_t* x, int32_t* y);
 void platform_get_window_size(const platform_window_t* window, uint32_t* width, uint32_t* height);
+// the getters above return state cached from window events,
+// this queries the window system directly and updates that cache
+void platform_refresh_window_state(platform_window_t* window);
+// the setters only record the change, they are sent together by the next
+// platform_handle_events, platform_wait_events or platform_flush. setting
+// what the window already has sends nothing, so calling them every frame is cheap.
+// the getters keep returning the old state until the window system reports the change
+// NOTE: with PLATFORM_SF_EVENT_THREAD they have to be called from the polling thread
 void platform_set_window_position(platform_window_t* window, const int32_t x, const int32_t y);
 void platform_set_window_size(platform_window_t* window, const uint32_t width, const uint32_t height);
 void platform_get_window_name(const platform_window_t* window, char* name, uint32_t max_len);
 void platform_set_window_name(platform_window_t* window, const char* name);
+// sends the changes made by the setters right away
+void platform_flush(void);
 
 void platform_map_window(platform_window_t* window);
 void platform_unmap_window(platform_window_t* window);
 
+int8_t platform_window_is_mapped(const platform_window_t* window);
+int8_t platform_window_has_focus(const platform_window_t* window);
 int8_t platform_window_should_close(const platform_window_t* window);
 
+typedef struct {
+	int32_t  x, y;
+	uint32_t width, height;
+} platform_rect_t;
+
+// pixels are 0x00RRGGBB, rows are stride pixels apart
+typedef struct {
+	uint32_t* pixels;
+	uint32_t  width, height;
+	uint32_t  stride;
+} platform_framebuffer_t;
+
+// memory the size of the window to draw into with the cpu, it keeps its contents
+// between presents and is replaced when the window size changes. where the window
+// system allows it the server reads the pixels straight from this memory, so it
+// has to be asked for again after every present. returns 0 when the window
+// system's pixel format is not supported
+int8_t platform_window_get_framebuffer(platform_window_t* window, platform_framebuffer_t* framebuffer);
+// shows the framebuffer, only the damaged rectangles are sent to the window
+// system. no rectangles means the whole window
+void platform_window_present(platform_window_t* window, const platform_rect_t* damage, const uint32_t damage_count);
+
+// drawing helpers for framebuffers, or any pixels in their format. they use the
+// widest simd instructions the cpu has, rectangles are cut off at the edges
+void platform_framebuffer_fill(platform_framebuffer_t* framebuffer, const platform_rect_t* rect, const uint32_t color);
+// width x height rgba pixels, bytes in that order with rows stride bytes apart,
+// written to x, y. alpha is dropped, with premultiply the colors are multiplied
+// by it first and it is kept in the top byte, which shows the image over black
+void platform_framebuffer_write_rgba(platform_framebuffer_t* framebuffer, const int32_t x, const int32_t y,
+                                     const uint8_t* pixels, const uint32_t width, const uint32_t height,
+                                     const uint32_t stride, const int8_t premultiply);
+
+#define PLATFORM_FILTER_NEAREST  0
+#define PLATFORM_FILTER_BILINEAR 1
+
+// scales all of src onto all of dst, like an image of a fixed size onto the
+// framebuffer of a window the user resized. sizes up to 65535 pixels, the two
+// must not overlap
+void platform_framebuffer_scale(platform_framebuffer_t* dst, const platform_framebuffer_t* src, const uint32_t filter);
+
+#define PLATFORM_MAX_MONITORS 16
+
+typedef struct {
+	char     name[32];
+	// in pixels of the virtual screen all monitors are part of
+	int32_t  x, y;
+	uint32_t width, height;
+	uint32_t refresh_mhz; // millihertz, 0 when unknown
+	uint32_t dpi;         // 0 when the monitor does not report its physical size
+	int8_t   primary;
+} platform_monitor_t;
+
+// the monitor layout is kept up to date from window system events, so these
+// are cheap enough to call every frame. the primary monitor comes first,
+// returns how many monitors were written
+// NOTE: the xcb backend reports the whole screen as one monitor without a
+// refresh rate, headless reports none
+uint32_t platform_get_monitors(platform_monitor_t* monitors, const uint32_t max_count);
+// the monitor with the largest part of the window on it, by the cached window
+// position, or the primary one if the window is on none.
+// returns 0 when there are no monitors
+int8_t platform_window_get_monitor(const platform_window_t* window, platform_monitor_t* monitor);
+
 #ifdef PLATFORM_VULKAN
 char** platform_vulkan_required_extensions(uint32_t* extension_count);
 VkSurfaceKHR platform_vulkan_create_surface(platform_window_t* window, VkInstance instance);
 #endif // PLATFORM_VULKAN
 
+#define PLATFORM_WAIT_INFINITE UINT64_MAX
+
 void platform_handle_events(void);
+// blocks until window system events arrive, platform_wake is called or
+// timeout_ns passes, then handles any pending events like platform_handle_events
+// returns 0 if the timeout passed without anything happening
+int8_t platform_wait_events(const uint64_t timeout_ns);
+// safe to call from any thread, interrupts platform_wait_events. does nothing
+// before platform_init or after platform_shutdown
+void platform_wake(void);
+
+#define PLATFORM_EVENT_NONE       0
+#define PLATFORM_EVENT_CLOSE      1 // the window manager asked the window to close
+#define PLATFORM_EVENT_RESIZE     2
+#define PLATFORM_EVENT_MOVE       3
+#define PLATFORM_EVENT_EXPOSE     4 // part of the window has to be redrawn
+#define PLATFORM_EVENT_MAP        5
+#define PLATFORM_EVENT_UNMAP      6
+#define PLATFORM_EVENT_FOCUS_IN   7
+#define PLATFORM_EVENT_FOCUS_OUT  8
+#define PLATFORM_EVENT_MOUSE_MOVE 9
+#define PLATFORM_EVENT_KEY_DOWN   10
+#define PLATFORM_EVENT_KEY_UP     11
+#define PLATFORM_EVENT_MOUSE_DOWN 12
+#define PLATFORM_EVENT_MOUSE_UP   13
+#define PLATFORM_EVENT_WHEEL      14
+// unaccelerated device motion, only sent when the window system supports it
+// and never by the xcb backend
+#define PLATFORM_EVENT_RAW_MOTION 15
+
+// keys that produce an ascii character use its lowercase form (including
+// escape, enter as '\r', tab and backspace), other keys start at 256
+#define PLATFORM_KEY_UNKNOWN       0
+#define PLATFORM_KEY_INSERT        256
+#define PLATFORM_KEY_DELETE        257
+#define PLATFORM_KEY_RIGHT         258
+#define PLATFORM_KEY_LEFT          259
+#define PLATFORM_KEY_DOWN          260
+#define PLATFORM_KEY_UP            261
+#define PLATFORM_KEY_PAGE_UP       262
+#define PLATFORM_KEY_PAGE_DOWN     263
+#define PLATFORM_KEY_HOME          264
+#define PLATFORM_KEY_END           265
+#define PLATFORM_KEY_CAPS_LOCK     266
+#define PLATFORM_KEY_LEFT_SHIFT    267
+#define PLATFORM_KEY_RIGHT_SHIFT   268
+#define PLATFORM_KEY_LEFT_CONTROL  269
+#define PLATFORM_KEY_RIGHT_CONTROL 270
+#define PLATFORM_KEY_LEFT_ALT      271
+#define PLATFORM_KEY_RIGHT_ALT     272
+#define PLATFORM_KEY_LEFT_SUPER    273
+#define PLATFORM_KEY_RIGHT_SUPER   274
+#define PLATFORM_KEY_F1            275 // F1 to F12 follow in order
+
+#define PLATFORM_MOD_SHIFT   1
+#define PLATFORM_MOD_CONTROL 2
+#define PLATFORM_MOD_ALT     4
+#define PLATFORM_MOD_SUPER   8
+
+#define PLATFORM_MOUSE_BUTTON_LEFT    1
+#define PLATFORM_MOUSE_BUTTON_MIDDLE  2
+#define PLATFORM_MOUSE_BUTTON_RIGHT   3
+#define PLATFORM_MOUSE_BUTTON_BACK    4
+#define PLATFORM_MOUSE_BUTTON_FORWARD 5
+
+typedef struct {
+	uint32_t           type;
+	platform_window_t* window;
+	// platform_get_timestamp clock. input events carry the time the window system
+	// gives them, other events the time they were handled
+	uint64_t           timestamp;
+	union {
+		struct { uint32_t width, height; } resize;
+		struct { int32_t x, y; } move;
+		// the union of every area reported since the last poll
+		struct { int32_t x, y; uint32_t width, height; } expose;
+		// window coordinates
+		struct { int32_t x, y; } mouse_move;
+		struct {
+			uint32_t key;
+			uint32_t scancode; // position on the keyboard, independent of the layout
+			uint32_t modifiers;
+			int8_t   repeat;
+		} key;
+		struct { int32_t x, y; uint32_t button; uint32_t modifiers; } mouse_button;
+		// in wheel steps, positive is up and to the right
+		struct { float x, y; } wheel;
+		// device units
+		struct { double x, y; } raw_motion;
+	};
+} platform_event_t;
+
+// takes the oldest event filled in by platform_handle_events, returns 0 when there are none left.
+// consecutive resize, move, expose and mouse move events for a window arrive as one
+int8_t platform_poll_event(platform_event_t* event);
+// events lost because the queue was full when they arrived, the first loss is also logged as a warning
+uint64_t platform_event_dropped_count(void);
+
+// NOTE: only with PLATFORM_BACKEND_HEADLESS, which is linux only. with any other
+// backend injecting returns 0 and there are no window pixels
+// queues an event as if the window system sent it, the window state changes when
+// platform_handle_events takes it (close, resize, move, map, unmap and focus events).
+// events have to be injected from one thread at a time, which does not have to be
+// the one polling them. a timestamp of 0 is replaced with the current time.
+// returns 0 when the backlog is full, platform_handle_events makes room
+int8_t platform_headless_inject_event(const platform_event_t* event);
+// the memory the window is presented into, width * height pixels
+// of 0x00RRGGBB in rows without padding. replaced when the window is resized
+uint32_t* platform_headless_window_pixels(platform_window_t* window, uint32_t* width, uint32_t* height);
 
 void platform_terminal_print(const char* msg, const uint8_t forground, const uint8_t background, const uint8_t flags);
 void platform_terminal_print_error(const char* msg, const uint8_t forground, const uint8_t background, const uint8_t flags);
 
+typedef struct {
+	const char* text;
+	uint8_t     forground;
+	uint8_t     background;
+	uint8_t     flags;
+} platform_terminal_span_t;
+
+// prints every span with its own colors in a single write
+void platform_terminal_print_spans(const platform_terminal_span_t* spans, const uint32_t span_count);
+void platform_terminal_print_spans_error(const platform_terminal_span_t* spans, const uint32_t span_count);
+
+// what a print does when the async buffer is full
+#define PLATFORM_TERMINAL_OVERFLOW_BLOCK 0 // wait for the writer thread to make room
+#define PLATFORM_TERMINAL_OVERFLOW_DROP  1 // discard the message
+#define PLATFORM_TERMINAL_OVERFLOW_COUNT 2 // discard the message and print how many were lost once there is room
+
+// after this, terminal prints only copy the formatted message into a buffer
+// of at least buffer_size bytes and a background thread writes it out
+// NOTE: windows prints are always synchronous, there this returns 0
+int8_t platform_terminal_async_start(uint64_t buffer_size, const uint8_t overflow_policy);
+// writes everything still buffered and stops the writer thread, also done by platform_shutdown
+void platform_terminal_async_stop(void);
+// blocks until everything printed before the call has been written
+void platform_terminal_flush(void);
+uint64_t platform_terminal_dropped_count(void);
+
+// keeps line_count lines at the bottom of the terminal that are updated in place,
+// terminal prints appear above them. updates only send the characters that changed
+// and are sent at most refresh_rate times per second (0 for no limit)
+// NOTE: not available on windows, there this returns 0
+int8_t platform_terminal_status_begin(const uint32_t line_count, const uint32_t refresh_rate);
+// leaves the last state on screen
+void platform_terminal_status_end(void);
+void platform_terminal_status_set_line(const uint32_t line, const char* text, const uint8_t forground, const uint8_t background, const uint8_t flags);
+// draws the changes since the last update if the refresh rate allows it
+void platform_terminal_status_update(void);
+
+#define PLATFORM_LOG_LEVEL_TRACE 0
+#define PLATFORM_LOG_LEVEL_DEBUG 1
+#define PLATFORM_LOG_LEVEL_INFO  2
+#define PLATFORM_LOG_LEVEL_WARN  3 // warnings and errors go to stderr
+#define PLATFORM_LOG_LEVEL_ERROR 4
+
+// log calls below this level are removed at compile time
+#ifndef PLATFORM_LOG_MIN_LEVEL
+#define PLATFORM_LOG_MIN_LEVEL PLATFORM_LOG_LEVEL_TRACE
+#endif // PLATFORM_LOG_MIN_LEVEL
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PLATFORM_PRINTF_FORMAT(fmt_index, first_arg) __attribute__((format(printf, fmt_index, first_arg)))
+#else
+#define PLATFORM_PRINTF_FORMAT(fmt_index, first_arg)
+#endif
+
+// formats straight into the terminal output buffer and prints it as one line
+// with a level prefix, messages longer than the buffer are cut off
+#define platform_log(level, ...) \
+	do { if((level) >= PLATFORM_LOG_MIN_LEVEL) platform_log_write((level), __VA_ARGS__); } while(0)
+// only copies fmt and the arguments while async output is running, the writer thread
+// does the formatting. fmt has to stay valid until then (a string literal), %s arguments
+// are copied. formats right away like platform_log when that is not possible
+#define platform_log_deferred(level, ...) \
+	do { if((level) >= PLATFORM_LOG_MIN_LEVEL) platform_log_deferred_write((level), __VA_ARGS__); } while(0)
+
+void platform_log_write(const uint8_t level, const char* fmt, ...) PLATFORM_PRINTF_FORMAT(2, 3);
+void platform_log_deferred_write(const uint8_t level, const char* fmt, ...) PLATFORM_PRINTF_FORMAT(2, 3);
+
 void* platform_map_memory(void* addr_hint, uint64_t size);
 int8_t platform_unmap_memory(void* addr, uint64_t size);
+// granted_page_size receives the page size the mapping was rounded up to, when it is larger
+// than platform_get_page_size() the mapping must be unmapped with the rounded size.
+// transparent huge pages are a request to the kernel, not a guarantee, so the
+// granted size does not promise the memory is backed by huge pages
+void* platform_map_memory_ex(void* addr_hint, uint64_t size, const uint32_t flags, uint64_t* granted_page_size);
+
+// reserves address space without backing it with memory, pages must be
+// committed before they are touched. addresses and sizes passed to the
+// functions below should be multiples of platform_get_page_size(), and
+// reservations start on a platform_get_allocation_granularity() boundary
+void* platform_reserve_memory(void* addr_hint, uint64_t size);
+int8_t platform_commit_memory(void* addr, uint64_t size);
+// contents of decommitted pages are lost
+int8_t platform_decommit_memory(void* addr, uint64_t size);
+// addr and size must be the whole reservation
+int8_t platform_release_memory(void* addr, uint64_t size);
+uint64_t platform_get_page_size(void);
+uint64_t platform_get_allocation_granularity(void);
+
+// bump allocator over a reserved address range, pages are committed as it grows
+typedef struct {
+	uint8_t* base;
+	uint64_t reserved;
+	uint64_t committed;
+	uint64_t offset;
+	uint64_t last_offset; // start of the most recent allocation
+} platform_arena_t;
+
+int8_t platform_arena_create(platform_arena_t* arena, const uint64_t reserve_size);
+void platform_arena_destroy(platform_arena_t* arena);
+void* platform_arena_alloc(platform_arena_t* arena, const uint64_t size, const uint64_t alignment);
+// everything allocated after the marker was taken is freed by set_marker
+uint64_t platform_arena_get_marker(const platform_arena_t* arena);
+void platform_arena_set_marker(platform_arena_t* arena, const uint64_t marker);
+// committed pages are kept so refilling the arena does not fault
+void platform_arena_reset(platform_arena_t* arena);
+// free only gives memory back for the most recent allocation,
+// the arena must outlive the returned callbacks
+platform_allocation_callbacks_t platform_arena_callbacks(platform_arena_t* arena);
+
+// two arenas used on alternating frames, memory allocated
+// during a frame stays valid until the end of the next one
+typedef struct {
+	platform_arena_t arenas[2];
+	uint32_t current;
+} platform_frame_arena_t;
+
+int8_t platform_frame_arena_create(platform_frame_arena_t* frame_arena, const uint64_t reserve_size_per_frame);
+void platform_frame_arena_destroy(platform_frame_arena_t* frame_arena);
+// switches to the other arena and resets it
+platform_arena_t* platform_frame_arena_begin(platform_frame_arena_t* frame_arena);
+
+// power of two size classes from 16 to 2048 bytes carved out of 64 KiB slabs,
+// each thread keeps a small cache of free objects per class so most calls take no lock.
+// larger allocations are mapped directly. memory is only returned to the system on destroy
+typedef struct platform_slab_allocator_t platform_slab_allocator_t;
+
+platform_slab_allocator_t* platform_slab_allocator_create(void);
+void platform_slab_allocator_destroy(platform_slab_allocator_t* allocator);
+void* platform_slab_alloc(platform_slab_allocator_t* allocator, const uint64_t size, const uint64_t alignment);
+void platform_slab_free(platform_slab_allocator_t* allocator, void* addr);
+platform_allocation_callbacks_t platform_slab_callbacks(platform_slab_allocator_t* allocator);
+
+// wraps another allocator (or the default one when inner is NULL) and counts what goes through it.
+// allocations made while a thread has a tag set are also counted under that tag,
+// tags are compared by pointer so string literals work best. counting is done per thread,
+// so the peak may be off by up to 64 KiB for every thread using the allocator
+#define PLATFORM_TRACKING_SIZE_CLASSES 32
+#define PLATFORM_TRACKING_MAX_TAGS     32
+
+typedef struct {
+	const char* tag;
+	uint64_t    live_bytes;
+	uint64_t    live_count;
+} platform_tracking_tag_stats_t;
+
+typedef struct {
+	uint64_t live_bytes;
+	uint64_t peak_bytes;
+	uint64_t live_count;
+	uint64_t total_allocations;
+	uint64_t total_frees;
+	// index i counts allocations of size [2^(i-1), 2^i), the last one also everything larger
+	uint64_t size_class_counts[PLATFORM_TRACKING_SIZE_CLASSES];
+	uint32_t tag_count;
+	platform_tracking_tag_stats_t tags[PLATFORM_TRACKING_MAX_TAGS];
+} platform_allocation_stats_t;
 
+typedef struct platform_tracking_allocator_t platform_tracking_allocator_t;
+
+platform_tracking_allocator_t* platform_tracking_allocator_create(const char* name, const platform_allocation_callbacks_t* inner);
+void platform_tracking_allocator_destroy(platform_tracking_allocator_t* tracker);
+platform_allocation_callbacks_t platform_tracking_callbacks(platform_tracking_allocator_t* tracker);
+// returns the previous tag of the calling thread, NULL clears it
+const char* platform_tracking_set_tag(const char* tag);
+void platform_tracking_get_stats(const platform_tracking_allocator_t* tracker, platform_allocation_stats_t* stats);
+// prints every tracking allocator that still has live allocations, also called by platform_shutdown
+void platform_tracking_report_leaks(void);
+
+// monotonic, in units of 1 / platform_get_timestamp_frequency() seconds (nanoseconds)
 uint64_t platform_get_timestamp(void);
+uint64_t platform_get_timestamp_frequency(void);
+// measures the cpu tick rate (rdtsc on x86, requires an invariant tsc) against
+// platform_get_timestamp over the given time, returns 0 if not supported.
+// once calibrated, platform_get_fast_timestamp reads the tick counter directly
+// instead of calling into the kernel, otherwise it falls back to platform_get_timestamp
+int8_t platform_calibrate_fast_timestamp(const uint32_t miliseconds);
+uint64_t platform_get_fast_timestamp(void);
+// 0 if not calibrated
+uint64_t platform_get_fast_timestamp_tick_frequency(void);
 void platform_sleep_miliseconds(const uint32_t miliseconds);
+// sleeps until platform_get_timestamp() >= deadline_ns, the last stretch
+// is spent spinning so the wakeup is not late by the scheduler's slack
+void platform_sleep_until(const uint64_t deadline_ns);
+
+// paces a loop to a fixed period, deadlines are kept on a fixed grid
+// so being late on one frame does not push back the following ones
+typedef struct {
+	uint64_t period_ns;
+	uint64_t next_deadline_ns;
+} platform_frame_pacer_t;
+
+void platform_frame_pacer_init(platform_frame_pacer_t* pacer, const uint64_t period_ns);
+// sleeps until the next deadline and returns it, deadlines that were
+// already missed are skipped instead of being run back to back
+uint64_t platform_frame_pacer_wait(platform_frame_pacer_t* pacer);
+
+#ifdef PLATFORM_VULKAN
+// present mode picked by the swapchain helper, each one falls back to the
+// next and in the end to fifo which every driver has
+#define PLATFORM_LATENCY_VSYNC  0 // fifo, never tears, frames queue up behind vblank
+#define PLATFORM_LATENCY_LOW    1 // mailbox, never tears, the newest frame is shown at vblank
+#define PLATFORM_LATENCY_LOWEST 2 // immediate, tears, then mailbox
+
+#define PLATFORM_SWAPCHAIN_MAX_FRAMES 4
+#define PLATFORM_SWAPCHAIN_MAX_IMAGES 8
+
+// an optional helper on top of platform_vulkan_create_surface, it owns the
+// swapchain, its image views and the synchronization of the frames in flight.
+// the app owns everything else, including the surface
+typedef struct platform_swapchain_t platform_swapchain_t;
+
+typedef struct {
+	VkPhysicalDevice   physical_device;
+	VkDevice           device;
+	VkQueue            present_queue;
+	VkSurfaceKHR       surface;
+	platform_window_t* window;
+	// VK_FORMAT_UNDEFINED or not supported takes B8G8R8A8_SRGB if possible
+	VkFormat           format;
+	// 0 means VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT
+	VkImageUsageFlags  usage;
+	uint32_t           latency; // PLATFORM_LATENCY_*
+	// 1 to PLATFORM_SWAPCHAIN_MAX_FRAMES, 0 means 2
+	uint32_t           frames_in_flight;
+} platform_swapchain_create_info_t;
+
+typedef struct {
+	uint32_t    frame_index; // for the app's own per frame resources
+	uint32_t    image_index;
+	VkImage     image;
+	VkImageView image_view;
+	VkExtent2D  extent;
+	VkFormat    format;
+	// the submit of the frame waits on image_available, signals render_finished and fence
+	VkSemaphore image_available;
+	VkSemaphore render_finished;
+	VkFence     fence;
+} platform_swapchain_frame_t;
+
+// of the last presented frame, in nanoseconds
+typedef struct {
+	uint64_t fence_wait_ns; // waiting for the gpu to finish the frame that used the same resources
+	uint64_t acquire_ns;    // in vkAcquireNextImageKHR, waiting for an image to be free
+	uint64_t cpu_ns;        // from acquire returning until present was called
+	uint64_t present_ns;    // in vkQueuePresentKHR
+	uint64_t frame_ns;      // from the previous present to this one
+} platform_swapchain_timing_t;
+
+// returns NULL if the surface can not be used, a window of size 0 is fine
+platform_swapchain_t* platform_swapchain_create(const platform_swapchain_create_info_t* create_info, platform_allocation_callbacks_t* allocator);
+void platform_swapchain_destroy(platform_swapchain_t* swapchain, platform_allocation_callbacks_t* allocator);
+// waits until the next frame's resources are free and acquires an image. the
+// swapchain is recreated first when the window's size changed or the last
+// present said it is out of date. returns 0 when there is nothing to draw to,
+// like a minimized window, then the frame is skipped without a submit
+int8_t platform_swapchain_acquire(platform_swapchain_t* swapchain, platform_swapchain_frame_t* frame);
+// presents the acquired image after the app submitted the frame
+// returns 0 if the swapchain has to be recreated, the next acquire does that
+int8_t platform_swapchain_present(platform_swapchain_t* swapchain);
+// recreates at the next acquire, also for the same size
+void platform_swapchain_invalidate(platform_swapchain_t* swapchain);
+VkPresentModeKHR platform_swapchain_present_mode(const platform_swapchain_t* swapchain);
+void platform_swapchain_get_timing(const platform_swapchain_t* swapchain, platform_swapchain_timing_t* timing);
+#endif // PLATFORM_VULKAN
 
 #endif // PLATFORM_H
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include "platform/platform.h"
+#include <string.h>
+
+// committing in larger steps keeps the number of syscalls down while the arena grows
+#define ARENA_COMMIT_STEP (64 * 1024)
+
+static inline uint64_t align_up(const uint64_t value, const uint64_t alignment) {
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+int8_t platform_arena_create(platform_arena_t* arena, const uint64_t reserve_size) {
+	uint64_t size = align_up(reserve_size, platform_get_allocation_granularity());
+	arena->base = platform_reserve_memory(NULL, size);
+	if(arena->base == NULL) return 0;
+	arena->reserved = size;
+	arena->committed = 0;
+	arena->offset = 0;
+	arena->last_offset = 0;
+	return 1;
+}
+
+void platform_arena_destroy(platform_arena_t* arena) {
+	if(arena->base != NULL) platform_release_memory(arena->base, arena->reserved);
+	arena->base = NULL;
+	arena->reserved = 0;
+	arena->committed = 0;
+	arena->offset = 0;
+	arena->last_offset = 0;
+}
+
+static inline int8_t arena_ensure_committed(platform_arena_t* arena, const uint64_t end) {
+	if(end <= arena->committed) return 1;
+	uint64_t step = ARENA_COMMIT_STEP > platform_get_page_size() ? ARENA_COMMIT_STEP : platform_get_page_size();
+	uint64_t new_committed = align_up(end, step);
+	if(new_committed > arena->reserved) new_committed = arena->reserved;
+	if(!platform_commit_memory(arena->base + arena->committed, new_committed - arena->committed)) return 0;
+	arena->committed = new_committed;
+	return 1;
+}
+
+void* platform_arena_alloc(platform_arena_t* arena, const uint64_t size, const uint64_t alignment) {
+	uint64_t start = align_up(arena->offset, alignment != 0 ? alignment : 1);
+	uint64_t end = start + size;
+	if(end > arena->reserved) return NULL;
+	if(!arena_ensure_committed(arena, end)) return NULL;
+	arena->last_offset = start;
+	arena->offset = end;
+	return arena->base + start;
+}
+
+uint64_t platform_arena_get_marker(const platform_arena_t* arena) {
+	return arena->offset;
+}
+
+void platform_arena_set_marker(platform_arena_t* arena, const uint64_t marker) {
+	if(marker > arena->offset) return;
+	arena->offset = marker;
+	if(arena->last_offset > marker) arena->last_offset = marker;
+}
+
+void platform_arena_reset(platform_arena_t* arena) {
+	arena->offset = 0;
+	arena->last_offset = 0;
+}
+
+static void* arena_callback_alloc(void* user_data, uint64_t size, uint64_t alignment) {
+	return platform_arena_alloc(user_data, size, alignment);
+}
+
+// only the most recent allocation can actually be given back
+static void arena_callback_free(void* user_data, void* addr) {
+	platform_arena_t* arena = user_data;
+	if(addr != NULL && (uint8_t*)addr == arena->base + arena->last_offset) {
+		arena->offset = arena->last_offset;
+	}
+}
+
+static void* arena_callback_realloc(void* user_data, void* addr, uint64_t size) {
+	platform_arena_t* arena = user_data;
+	if(addr == NULL) return platform_arena_alloc(arena, size, 16);
+
+	uint64_t offset = (uint8_t*)addr - arena->base;
+	// the most recent allocation can grow or shrink in place
+	if(offset == arena->last_offset) {
+		if(offset + size > arena->reserved) return NULL;
+		if(!arena_ensure_committed(arena, offset + size)) return NULL;
+		arena->offset = offset + size;
+		return addr;
+	}
+
+	void* new_addr = platform_arena_alloc(arena, size, 16);
+	if(new_addr == NULL) return NULL;
+	// the old size is not known, but everything up to the previous
+	// top of the arena is readable and no larger than the old block
+	uint64_t available = arena->last_offset - offset;
+	memcpy(new_addr, addr, size < available ? size : available);
+	return new_addr;
+}
+
+platform_allocation_callbacks_t platform_arena_callbacks(platform_arena_t* arena) {
+	platform_allocation_callbacks_t callbacks;
+	callbacks.alloc = arena_callback_alloc;
+	callbacks.free = arena_callback_free;
+	callbacks.realloc = arena_callback_realloc;
+	callbacks.user_data = arena;
+	return callbacks;
+}
+
+int8_t platform_frame_arena_create(platform_frame_arena_t* frame_arena, const uint64_t reserve_size_per_frame) {
+	if(!platform_arena_create(&frame_arena->arenas[0], reserve_size_per_frame)) return 0;
+	if(!platform_arena_create(&frame_arena->arenas[1], reserve_size_per_frame)) {
+		platform_arena_destroy(&frame_arena->arenas[0]);
+		return 0;
+	}
+	frame_arena->current = 0;
+	return 1;
+}
+
+void platform_frame_arena_destroy(platform_frame_arena_t* frame_arena) {
+	platform_arena_destroy(&frame_arena->arenas[0]);
+	platform_arena_destroy(&frame_arena->arenas[1]);
+}
+
+platform_arena_t* platform_frame_arena_begin(platform_frame_arena_t* frame_arena) {
+	frame_arena->current ^= 1;
+	platform_arena_reset(&frame_arena->arenas[frame_arena->current]);
+	return &frame_arena->arenas[frame_arena->current];
+}
@@ -0,0 +1,83 @@
+#include "event_queue.h"
+#include <stddef.h>
+
+static inline int8_t coalescable(const uint32_t type) {
+	return type == PLATFORM_EVENT_RESIZE || type == PLATFORM_EVENT_MOVE ||
+	       type == PLATFORM_EVENT_EXPOSE || type == PLATFORM_EVENT_MOUSE_MOVE;
+}
+
+static void merge(platform_event_t* pending, const platform_event_t* event) {
+	if(event->type == PLATFORM_EVENT_EXPOSE) {
+		int32_t x0 = pending->expose.x < event->expose.x ? pending->expose.x : event->expose.x;
+		int32_t y0 = pending->expose.y < event->expose.y ? pending->expose.y : event->expose.y;
+		int32_t pending_x1 = pending->expose.x + (int32_t)pending->expose.width;
+		int32_t pending_y1 = pending->expose.y + (int32_t)pending->expose.height;
+		int32_t event_x1 = event->expose.x + (int32_t)event->expose.width;
+		int32_t event_y1 = event->expose.y + (int32_t)event->expose.height;
+		int32_t x1 = pending_x1 > event_x1 ? pending_x1 : event_x1;
+		int32_t y1 = pending_y1 > event_y1 ? pending_y1 : event_y1;
+		pending->expose.x = x0;
+		pending->expose.y = y0;
+		pending->expose.width = x1 - x0;
+		pending->expose.height = y1 - y0;
+		pending->timestamp = event->timestamp;
+		return;
+	}
+	// everything else only needs the latest state
+	*pending = *event;
+}
+
+void event_queue_init(event_queue_t* queue) {
+	queue->head = 0;
+	queue->tail = 0;
+	atomic_store_explicit(&queue->dropped, 0, memory_order_relaxed);
+}
+
+void event_queue_push(event_queue_t* queue, const platform_event_t* event) {
+	if(coalescable(event->type)) {
+		uint32_t scan = queue->tail - queue->head;
+		if(scan > EVENT_QUEUE_COALESCE_SCAN) scan = EVENT_QUEUE_COALESCE_SCAN;
+		for(uint32_t i = 1; i <= scan; i++) {
+			platform_event_t* pending = &queue->events[(queue->tail - i) & (EVENT_QUEUE_CAPACITY - 1)];
+			if(pending->type == event->type && pending->window == event->window) {
+				merge(pending, event);
+				return;
+			}
+			// a close, focus change or similar keeps its place relative to both events
+			if(pending->type != PLATFORM_EVENT_NONE && !coalescable(pending->type)) break;
+		}
+	}
+	if(queue->tail - queue->head == EVENT_QUEUE_CAPACITY) {
+		if(atomic_fetch_add_explicit(&queue->dropped, 1, memory_order_relaxed) == 0) {
+			platform_log(PLATFORM_LOG_LEVEL_WARN, "event queue is full, events are being dropped");
+		}
+		return;
+	}
+	queue->events[queue->tail & (EVENT_QUEUE_CAPACITY - 1)] = *event;
+	queue->tail++;
+}
+
+int8_t event_queue_pop(event_queue_t* queue, platform_event_t* event) {
+	while(queue->head != queue->tail) {
+		*event = queue->events[queue->head & (EVENT_QUEUE_CAPACITY - 1)];
+		queue->head++;
+		if(event->type != PLATFORM_EVENT_NONE) return 1;
+	}
+	return 0;
+}
+
+const platform_event_t* event_queue_peek(event_queue_t* queue) {
+	while(queue->head != queue->tail) {
+		const platform_event_t* event = &queue->events[queue->head & (EVENT_QUEUE_CAPACITY - 1)];
+		if(event->type != PLATFORM_EVENT_NONE) return event;
+		queue->head++;
+	}
+	return NULL;
+}
+
+void event_queue_remove_window(event_queue_t* queue, const platform_window_t* window) {
+	for(uint32_t i = queue->head; i != queue->tail; i++) {
+		platform_event_t* pending = &queue->events[i & (EVENT_QUEUE_CAPACITY - 1)];
+		if(pending->window == window) pending->type = PLATFORM_EVENT_NONE;
+	}
+}
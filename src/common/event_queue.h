@@ -0,0 +1,30 @@
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include "platform/platform.h"
+#include <stdatomic.h>
+
+#define EVENT_QUEUE_CAPACITY 1024 // power of two
+// how far back a new event looks for one it can be merged into
+#define EVENT_QUEUE_COALESCE_SCAN 64
+
+// fixed size ring of events, filled by the backend while handling
+// window system events and drained by platform_poll_event
+typedef struct {
+	platform_event_t     events[EVENT_QUEUE_CAPACITY];
+	uint32_t             head; // next event to poll
+	uint32_t             tail; // next free slot
+	atomic_uint_fast64_t dropped; // read from any thread
+} event_queue_t;
+
+void event_queue_init(event_queue_t* queue);
+// merges resize, move, expose and mouse move events into a pending one of the same
+// type and window when nothing that has to stay in order lies between them
+void event_queue_push(event_queue_t* queue, const platform_event_t* event);
+int8_t event_queue_pop(event_queue_t* queue, platform_event_t* event);
+// the next event without removing it, NULL when the queue is empty
+const platform_event_t* event_queue_peek(event_queue_t* queue);
+// pending events of a destroyed window are turned into PLATFORM_EVENT_NONE and skipped
+void event_queue_remove_window(event_queue_t* queue, const platform_window_t* window);
+
+#endif // EVENT_QUEUE_H
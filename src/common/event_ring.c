@@ -0,0 +1,45 @@
+#include "event_ring.h"
+
+void event_ring_init(event_ring_t* ring) {
+	atomic_store_explicit(&ring->head, 0, memory_order_relaxed);
+	atomic_store_explicit(&ring->tail, 0, memory_order_relaxed);
+	ring->cached_head = 0;
+	ring->cached_tail = 0;
+}
+
+int8_t event_ring_push(event_ring_t* ring, const platform_event_t* event) {
+	uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	if(tail - ring->cached_head == EVENT_RING_CAPACITY) {
+		ring->cached_head = atomic_load_explicit(&ring->head, memory_order_acquire);
+		if(tail - ring->cached_head == EVENT_RING_CAPACITY) return 0;
+	}
+	ring->events[tail & (EVENT_RING_CAPACITY - 1)] = *event;
+	atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+	return 1;
+}
+
+int8_t event_ring_pop(event_ring_t* ring, platform_event_t* event) {
+	uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	for(;;) {
+		if(head == ring->cached_tail) {
+			ring->cached_tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+			if(head == ring->cached_tail) return 0;
+		}
+		*event = ring->events[head & (EVENT_RING_CAPACITY - 1)];
+		head++;
+		atomic_store_explicit(&ring->head, head, memory_order_release);
+		if(event->type != PLATFORM_EVENT_NONE) return 1;
+	}
+}
+
+int8_t event_ring_empty(event_ring_t* ring) {
+	return atomic_load_explicit(&ring->head, memory_order_relaxed) == atomic_load_explicit(&ring->tail, memory_order_acquire);
+}
+
+void event_ring_remove_window(event_ring_t* ring, const platform_window_t* window) {
+	uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+	for(uint32_t i = atomic_load_explicit(&ring->head, memory_order_relaxed); i != tail; i++) {
+		platform_event_t* pending = &ring->events[i & (EVENT_RING_CAPACITY - 1)];
+		if(pending->window == window) pending->type = PLATFORM_EVENT_NONE;
+	}
+}
@@ -0,0 +1,29 @@
+#ifndef EVENT_RING_H
+#define EVENT_RING_H
+
+#include "platform/platform.h"
+#include <stdatomic.h>
+
+#define EVENT_RING_CAPACITY 1024 // power of two
+
+// single producer single consumer handoff between the event thread and the
+// thread polling events. head and tail live on their own cache lines and each
+// side keeps a copy of the other's index so most operations touch only its own
+typedef struct {
+	_Alignas(64) atomic_uint_fast32_t head; // next event to poll, written by the consumer
+	uint32_t                         cached_tail;
+	_Alignas(64) atomic_uint_fast32_t tail; // next free slot, written by the producer
+	uint32_t                         cached_head;
+	_Alignas(64) platform_event_t    events[EVENT_RING_CAPACITY];
+} event_ring_t;
+
+void event_ring_init(event_ring_t* ring);
+// producer side, returns 0 when the ring is full
+int8_t event_ring_push(event_ring_t* ring, const platform_event_t* event);
+// consumer side
+int8_t event_ring_pop(event_ring_t* ring, platform_event_t* event);
+int8_t event_ring_empty(event_ring_t* ring);
+// consumer side, the producer never touches slots it has already published
+void event_ring_remove_window(event_ring_t* ring, const platform_window_t* window);
+
+#endif // EVENT_RING_H
@@ -0,0 +1,20 @@
+#include "platform/platform.h"
+
+void platform_frame_pacer_init(platform_frame_pacer_t* pacer, const uint64_t period_ns) {
+	pacer->period_ns = period_ns;
+	pacer->next_deadline_ns = platform_get_timestamp() + period_ns;
+}
+
+uint64_t platform_frame_pacer_wait(platform_frame_pacer_t* pacer) {
+	uint64_t deadline = pacer->next_deadline_ns;
+	platform_sleep_until(deadline);
+	pacer->next_deadline_ns += pacer->period_ns;
+
+	// the frame overran by more than a period, realign to the grid
+	uint64_t now = platform_get_timestamp();
+	if(now >= pacer->next_deadline_ns) {
+		uint64_t missed = (now - pacer->next_deadline_ns) / pacer->period_ns + 1;
+		pacer->next_deadline_ns += missed * pacer->period_ns;
+	}
+	return deadline;
+}
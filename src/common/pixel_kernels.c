@@ -0,0 +1,583 @@
+#include "pixel_kernels.h"
+#include <string.h>
+
+// the simd levels need gcc or clang, other compilers get the scalar kernels
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define PIXEL_KERNELS_X86
+#include <immintrin.h>
+// the levels above the one the file is built for are enabled per function,
+// they are only called after the cpu was checked
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#if (defined(__aarch64__) || defined(__ARM_NEON)) && defined(__GNUC__)
+#define PIXEL_KERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+const char* const pixel_isa_names[PIXEL_ISA_COUNT] = { "scalar", "sse2", "avx2", "neon" };
+
+// scalar reference versions, the others finish their rows with them
+
+static void scalar_rgba_to_bgrx(uint32_t* dst, const uint8_t* src, uint32_t count) {
+	for(uint32_t i = 0; i < count; i++) {
+		dst[i] = (uint32_t)src[i * 4] << 16 | (uint32_t)src[i * 4 + 1] << 8 | src[i * 4 + 2];
+	}
+}
+
+// c * a / 255 rounded to the nearest without a division
+static inline uint32_t mul_div_255(const uint32_t c, const uint32_t a) {
+	uint32_t t = c * a + 128;
+	return (t + (t >> 8)) >> 8;
+}
+
+static void scalar_rgba_premultiply(uint32_t* dst, const uint8_t* src, uint32_t count) {
+	for(uint32_t i = 0; i < count; i++) {
+		const uint8_t* p = src + i * 4;
+		uint32_t a = p[3];
+		dst[i] = a << 24 | mul_div_255(p[0], a) << 16 | mul_div_255(p[1], a) << 8 | mul_div_255(p[2], a);
+	}
+}
+
+static void scalar_bgrx_to_rgb565(uint16_t* dst, const uint32_t* src, uint32_t count) {
+	for(uint32_t i = 0; i < count; i++) {
+		uint32_t p = src[i];
+		dst[i] = (p >> 8 & 0xf800) | (p >> 5 & 0x07e0) | (p >> 3 & 0x001f);
+	}
+}
+
+static void scalar_fill(uint32_t* dst, uint32_t value, uint32_t count) {
+	for(uint32_t i = 0; i < count; i++) dst[i] = value;
+}
+
+static void scalar_copy(uint32_t* dst, const uint32_t* src, uint32_t count) {
+	for(uint32_t i = 0; i < count; i++) dst[i] = src[i];
+}
+
+static void scalar_scale_nearest(uint32_t* dst, uint32_t count, const uint32_t* src, uint32_t x, uint32_t step) {
+	for(uint32_t i = 0; i < count; i++, x += step) dst[i] = src[x >> 16];
+}
+
+// weights are out of 256 so every step fits in 16 bits for the vector versions
+static inline uint32_t bilinear_pixel(const uint32_t p00, const uint32_t p01, const uint32_t p10, const uint32_t p11,
+                                      const uint32_t fx, const uint32_t wy) {
+	uint32_t result = 0;
+	for(uint32_t shift = 0; shift < 32; shift += 8) {
+		uint32_t top = ((p00 >> shift & 0xff) * (256 - fx) + (p01 >> shift & 0xff) * fx + 128) >> 8;
+		uint32_t bottom = ((p10 >> shift & 0xff) * (256 - fx) + (p11 >> shift & 0xff) * fx + 128) >> 8;
+		result |= ((top * (256 - wy) + bottom * wy + 128) >> 8) << shift;
+	}
+	return result;
+}
+
+static void scalar_scale_bilinear(uint32_t* dst, uint32_t count, const uint32_t* src0, const uint32_t* src1,
+                                  uint32_t x, uint32_t step, uint32_t wy) {
+	for(uint32_t i = 0; i < count; i++, x += step) {
+		uint32_t ix = x >> 16;
+		dst[i] = bilinear_pixel(src0[ix], src0[ix + 1], src1[ix], src1[ix + 1], x >> 8 & 0xff, wy);
+	}
+}
+
+#define SCALAR_KERNELS { \
+	scalar_rgba_to_bgrx, \
+	scalar_rgba_premultiply, \
+	scalar_bgrx_to_rgb565, \
+	scalar_fill, \
+	scalar_copy, \
+	scalar_scale_nearest, \
+	scalar_scale_bilinear \
+}
+
+#ifdef PIXEL_KERNELS_X86
+
+TARGET_SSE2 static void sse2_rgba_to_bgrx(uint32_t* dst, const uint8_t* src, uint32_t count) {
+	__m128i green = _mm_set1_epi32(0x0000ff00);
+	__m128i low = _mm_set1_epi32(0xff);
+	uint32_t i = 0;
+	for(; i + 4 <= count; i += 4) {
+		__m128i p = _mm_loadu_si128((const __m128i*)(src + i * 4));
+		__m128i red = _mm_slli_epi32(_mm_and_si128(p, low), 16);
+		__m128i blue = _mm_and_si128(_mm_srli_epi32(p, 16), low);
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_and_si128(p, green), _mm_or_si128(red, blue)));
+	}
+	scalar_rgba_to_bgrx(dst + i, src + i * 4, count - i);
+}
+
+// two rgba pixels widened to 16 bits, multiplies the colors by alpha and swaps red and blue
+TARGET_SSE2 static inline __m128i sse2_premultiply_half(const __m128i p, const __m128i alpha_mask, const __m128i alpha_one) {
+	__m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(p, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	// alpha itself is multiplied by 255 so it comes out as it was
+	a = _mm_or_si128(_mm_andnot_si128(alpha_mask, a), alpha_one);
+	__m128i t = _mm_add_epi16(_mm_mullo_epi16(p, a), _mm_set1_epi16(128));
+	t = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+	return _mm_shufflehi_epi16(_mm_shufflelo_epi16(t, _MM_SHUFFLE(3, 0, 1, 2)), _MM_SHUFFLE(3, 0, 1, 2));
+}
+
+TARGET_SSE2 static void sse2_rgba_premultiply(uint32_t* dst, const uint8_t* src, uint32_t count) {
+	__m128i zero = _mm_setzero_si128();
+	__m128i alpha_mask = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+	__m128i alpha_one = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+	uint32_t i = 0;
+	for(; i + 4 <= count; i += 4) {
+		__m128i p = _mm_loadu_si128((const __m128i*)(src + i * 4));
+		__m128i lo = sse2_premultiply_half(_mm_unpacklo_epi8(p, zero), alpha_mask, alpha_one);
+		__m128i hi = sse2_premultiply_half(_mm_unpackhi_epi8(p, zero), alpha_mask, alpha_one);
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+	}
+	scalar_rgba_premultiply(dst + i, src + i * 4, count - i);
+}
+
+TARGET_SSE2 static inline __m128i sse2_rgb565(const __m128i p) {
+	__m128i r = _mm_and_si128(_mm_srli_epi32(p, 8), _mm_set1_epi32(0xf800));
+	__m128i g = _mm_and_si128(_mm_srli_epi32(p, 5), _mm_set1_epi32(0x07e0));
+	__m128i b = _mm_and_si128(_mm_srli_epi32(p, 3), _mm_set1_epi32(0x001f));
+	// sign extended so the signed saturation of packs keeps the bits
+	return _mm_srai_epi32(_mm_slli_epi32(_mm_or_si128(r, _mm_or_si128(g, b)), 16), 16);
+}
+
+TARGET_SSE2 static void sse2_bgrx_to_rgb565(uint16_t* dst, const uint32_t* src, uint32_t count) {
+	uint32_t i = 0;
+	for(; i + 8 <= count; i += 8) {
+		__m128i lo = sse2_rgb565(_mm_loadu_si128((const __m128i*)(src + i)));
+		__m128i hi = sse2_rgb565(_mm_loadu_si128((const __m128i*)(src + i + 4)));
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(lo, hi));
+	}
+	scalar_bgrx_to_rgb565(dst + i, src + i, count - i);
+}
+
+TARGET_SSE2 static void sse2_fill(uint32_t* dst, uint32_t value, uint32_t count) {
+	__m128i v = _mm_set1_epi32(value);
+	uint32_t i = 0;
+	for(; i + 8 <= count; i += 8) {
+		_mm_storeu_si128((__m128i*)(dst + i), v);
+		_mm_storeu_si128((__m128i*)(dst + i + 4), v);
+	}
+	scalar_fill(dst + i, value, count - i);
+}
+
+TARGET_SSE2 static void sse2_copy(uint32_t* dst, const uint32_t* src, uint32_t count) {
+	uint32_t i = 0;
+	for(; i + 8 <= count; i += 8) {
+		__m128i a = _mm_loadu_si128((const __m128i*)(src + i));
+		__m128i b = _mm_loadu_si128((const __m128i*)(src + i + 4));
+		_mm_storeu_si128((__m128i*)(dst + i), a);
+		_mm_storeu_si128((__m128i*)(dst + i + 4), b);
+	}
+	scalar_copy(dst + i, src + i, count - i);
+}
+
+// horizontally blends the pixel pairs at a and b, the result has a's in the low half
+TARGET_SSE2 static inline __m128i sse2_blend_pairs(const uint32_t* a, const uint32_t* b, const __m128i w0, const __m128i w1) {
+	__m128i zero = _mm_setzero_si128();
+	__m128i pairs = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)a), _mm_loadl_epi64((const __m128i*)b));
+	__m128i pa = _mm_unpacklo_epi8(pairs, zero);
+	__m128i pb = _mm_unpackhi_epi8(pairs, zero);
+	__m128i left = _mm_mullo_epi16(_mm_unpacklo_epi64(pa, pb), w0);
+	__m128i right = _mm_mullo_epi16(_mm_unpackhi_epi64(pa, pb), w1);
+	return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(left, right), _mm_set1_epi16(128)), 8);
+}
+
+TARGET_SSE2 static void sse2_scale_bilinear(uint32_t* dst, uint32_t count, const uint32_t* src0, const uint32_t* src1,
+                                            uint32_t x, uint32_t step, uint32_t wy) {
+	__m128i wy0 = _mm_set1_epi16(256 - wy);
+	__m128i wy1 = _mm_set1_epi16(wy);
+	uint32_t i = 0;
+	for(; i + 2 <= count; i += 2) {
+		uint32_t x1 = x + step;
+		short fx0 = x >> 8 & 0xff, fx1 = x1 >> 8 & 0xff;
+		__m128i w1 = _mm_set_epi16(fx1, fx1, fx1, fx1, fx0, fx0, fx0, fx0);
+		__m128i w0 = _mm_sub_epi16(_mm_set1_epi16(256), w1);
+		__m128i top = sse2_blend_pairs(src0 + (x >> 16), src0 + (x1 >> 16), w0, w1);
+		__m128i bottom = sse2_blend_pairs(src1 + (x >> 16), src1 + (x1 >> 16), w0, w1);
+		__m128i v = _mm_add_epi16(_mm_mullo_epi16(top, wy0), _mm_mullo_epi16(bottom, wy1));
+		v = _mm_srli_epi16(_mm_add_epi16(v, _mm_set1_epi16(128)), 8);
+		_mm_storel_epi64((__m128i*)(dst + i), _mm_packus_epi16(v, v));
+		x = x1 + step;
+	}
+	scalar_scale_bilinear(dst + i, count - i, src0, src1, x, step, wy);
+}
+
+TARGET_AVX2 static void avx2_rgba_to_bgrx(uint32_t* dst, const uint8_t* src, uint32_t count) {
+	__m256i shuffle = _mm256_setr_epi8(2, 1, 0, -128, 6, 5, 4, -128, 10, 9, 8, -128, 14, 13, 12, -128,
+	                                   2, 1, 0, -128, 6, 5, 4, -128, 10, 9, 8, -128, 14, 13, 12, -128);
+	uint32_t i = 0;
+	for(; i + 8 <= count; i += 8) {
+		__m256i p = _mm256_loadu_si256((const __m256i*)(src + i * 4));
+		_mm256_storeu_si256((__m256i*)(dst + i), _mm256_shuffle_epi8(p, shuffle));
+	}
+	scalar_rgba_to_bgrx(dst + i, src + i * 4, count - i);
+}
+
+TARGET_AVX2 static inline __m256i avx2_premultiply_half(const __m256i p) {
+	__m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(p, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	a = _mm256_blend_epi16(a, _mm256_set1_epi16(255), 0x88);
+	__m256i t = _mm256_add_epi16(_mm256_mullo_epi16(p, a), _mm256_set1_epi16(128));
+	t = _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+	return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(t, _MM_SHUFFLE(3, 0, 1, 2)), _MM_SHUFFLE(3, 0, 1, 2));
+}
+
+TARGET_AVX2 static void avx2_rgba_premultiply(uint32_t* dst, const uint8_t* src, uint32_t count) {
+	__m256i zero = _mm256_setzero_si256();
+	uint32_t i = 0;
+	for(; i + 8 <= count; i += 8) {
+		__m256i p = _mm256_loadu_si256((const __m256i*)(src + i * 4));
+		__m256i lo = avx2_premultiply_half(_mm256_unpacklo_epi8(p, zero));
+		__m256i hi = avx2_premultiply_half(_mm256_unpackhi_epi8(p, zero));
+		_mm256_storeu_si256((__m256i*)(dst + i), _mm256_packus_epi16(lo, hi));
+	}
+	scalar_rgba_premultiply(dst + i, src + i * 4, count - i);
+}
+
+TARGET_AVX2 static inline __m256i avx2_rgb565(const __m256i p) {
+	__m256i r = _mm256_and_si256(_mm256_srli_epi32(p, 8), _mm256_set1_epi32(0xf800));
+	__m256i g = _mm256_and_si256(_mm256_srli_epi32(p, 5), _mm256_set1_epi32(0x07e0));
+	__m256i b = _mm256_and_si256(_mm256_srli_epi32(p, 3), _mm256_set1_epi32(0x001f));
+	return _mm256_srai_epi32(_mm256_slli_epi32(_mm256_or_si256(r, _mm256_or_si256(g, b)), 16), 16);
+}
+
+TARGET_AVX2 static void avx2_bgrx_to_rgb565(uint16_t* dst, const uint32_t* src, uint32_t count) {
+	uint32_t i = 0;
+	for(; i + 16 <= count; i += 16) {
+		__m256i lo = avx2_rgb565(_mm256_loadu_si256((const __m256i*)(src + i)));
+		__m256i hi = avx2_rgb565(_mm256_loadu_si256((const __m256i*)(src + i + 8)));
+		// packs works within the 128 bit lanes
+		__m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), _MM_SHUFFLE(3, 1, 2, 0));
+		_mm256_storeu_si256((__m256i*)(dst + i), packed);
+	}
+	scalar_bgrx_to_rgb565(dst + i, src + i, count - i);
+}
+
+TARGET_AVX2 static void avx2_fill(uint32_t* dst, uint32_t value, uint32_t count) {
+	__m256i v = _mm256_set1_epi32(value);
+	uint32_t i = 0;
+	for(; i + 16 <= count; i += 16) {
+		_mm256_storeu_si256((__m256i*)(dst + i), v);
+		_mm256_storeu_si256((__m256i*)(dst + i + 8), v);
+	}
+	scalar_fill(dst + i, value, count - i);
+}
+
+TARGET_AVX2 static void avx2_copy(uint32_t* dst, const uint32_t* src, uint32_t count) {
+	uint32_t i = 0;
+	for(; i + 16 <= count; i += 16) {
+		__m256i a = _mm256_loadu_si256((const __m256i*)(src + i));
+		__m256i b = _mm256_loadu_si256((const __m256i*)(src + i + 8));
+		_mm256_storeu_si256((__m256i*)(dst + i), a);
+		_mm256_storeu_si256((__m256i*)(dst + i + 8), b);
+	}
+	scalar_copy(dst + i, src + i, count - i);
+}
+
+TARGET_AVX2 static void avx2_scale_nearest(uint32_t* dst, uint32_t count, const uint32_t* src, uint32_t x, uint32_t step) {
+	__m256i xs = _mm256_add_epi32(_mm256_set1_epi32(x), _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(step)));
+	__m256i step8 = _mm256_set1_epi32(step * 8);
+	uint32_t i = 0;
+	for(; i + 8 <= count; i += 8) {
+		__m256i p = _mm256_i32gather_epi32((const int*)src, _mm256_srli_epi32(xs, 16), 4);
+		_mm256_storeu_si256((__m256i*)(dst + i), p);
+		xs = _mm256_add_epi32(xs, step8);
+	}
+	scalar_scale_nearest(dst + i, count - i, src, x + i * step, step);
+}
+
+// like sse2_blend_pairs for four pixels, every 64 bit gather loads a pixel and its right neighbour
+TARGET_AVX2 static inline __m256i avx2_blend_pairs(const uint32_t* row, const __m128i ix, const __m256i w0, const __m256i w1) {
+	__m256i zero = _mm256_setzero_si256();
+	__m256i pairs = _mm256_i32gather_epi64((const long long*)row, ix, 4);
+	__m256i pa = _mm256_unpacklo_epi8(pairs, zero);
+	__m256i pb = _mm256_unpackhi_epi8(pairs, zero);
+	__m256i left = _mm256_mullo_epi16(_mm256_unpacklo_epi64(pa, pb), w0);
+	__m256i right = _mm256_mullo_epi16(_mm256_unpackhi_epi64(pa, pb), w1);
+	return _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(left, right), _mm256_set1_epi16(128)), 8);
+}
+
+TARGET_AVX2 static void avx2_scale_bilinear(uint32_t* dst, uint32_t count, const uint32_t* src0, const uint32_t* src1,
+                                            uint32_t x, uint32_t step, uint32_t wy) {
+	__m256i wy0 = _mm256_set1_epi16(256 - wy);
+	__m256i wy1 = _mm256_set1_epi16(wy);
+	__m128i xs = _mm_setr_epi32(x, x + step, x + step * 2, x + step * 3);
+	__m128i step4 = _mm_set1_epi32(step * 4);
+	uint32_t i = 0;
+	for(; i + 4 <= count; i += 4) {
+		__m128i ix = _mm_srli_epi32(xs, 16);
+		// every pixel's weight in the low word of its 64 bits, then spread over all four
+		__m256i w1 = _mm256_cvtepu32_epi64(_mm_and_si128(_mm_srli_epi32(xs, 8), _mm_set1_epi32(0xff)));
+		w1 = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(w1, 0), 0);
+		__m256i w0 = _mm256_sub_epi16(_mm256_set1_epi16(256), w1);
+		__m256i top = avx2_blend_pairs(src0, ix, w0, w1);
+		__m256i bottom = avx2_blend_pairs(src1, ix, w0, w1);
+		__m256i v = _mm256_add_epi16(_mm256_mullo_epi16(top, wy0), _mm256_mullo_epi16(bottom, wy1));
+		v = _mm256_srli_epi16(_mm256_add_epi16(v, _mm256_set1_epi16(128)), 8);
+		v = _mm256_permute4x64_epi64(_mm256_packus_epi16(v, v), _MM_SHUFFLE(3, 1, 2, 0));
+		_mm_storeu_si128((__m128i*)(dst + i), _mm256_castsi256_si128(v));
+		xs = _mm_add_epi32(xs, step4);
+	}
+	scalar_scale_bilinear(dst + i, count - i, src0, src1, x + i * step, step, wy);
+}
+
+// there is no gather before avx2, nearest stays scalar
+static const pixel_kernels_t sse2_kernels = {
+	sse2_rgba_to_bgrx,
+	sse2_rgba_premultiply,
+	sse2_bgrx_to_rgb565,
+	sse2_fill,
+	sse2_copy,
+	scalar_scale_nearest,
+	sse2_scale_bilinear
+};
+
+static const pixel_kernels_t avx2_kernels = {
+	avx2_rgba_to_bgrx,
+	avx2_rgba_premultiply,
+	avx2_bgrx_to_rgb565,
+	avx2_fill,
+	avx2_copy,
+	avx2_scale_nearest,
+	avx2_scale_bilinear
+};
+
+#endif // PIXEL_KERNELS_X86
+
+#ifdef PIXEL_KERNELS_NEON
+
+static void neon_rgba_to_bgrx(uint32_t* dst, const uint8_t* src, uint32_t count) {
+	uint32_t i = 0;
+	for(; i + 16 <= count; i += 16) {
+		uint8x16x4_t p = vld4q_u8(src + i * 4);
+		uint8x16x4_t out = { { p.val[2], p.val[1], p.val[0], vdupq_n_u8(0) } };
+		vst4q_u8((uint8_t*)(dst + i), out);
+	}
+	scalar_rgba_to_bgrx(dst + i, src + i * 4, count - i);
+}
+
+// same rounding as mul_div_255
+static inline uint8x8_t neon_mul_div_255(const uint8x8_t c, const uint8x8_t a) {
+	uint16x8_t t = vmull_u8(c, a);
+	return vraddhn_u16(t, vrshrq_n_u16(t, 8));
+}
+
+static inline uint8x16_t neon_premultiply(const uint8x16_t c, const uint8x16_t a) {
+	return vcombine_u8(neon_mul_div_255(vget_low_u8(c), vget_low_u8(a)), neon_mul_div_255(vget_high_u8(c), vget_high_u8(a)));
+}
+
+static void neon_rgba_premultiply(uint32_t* dst, const uint8_t* src, uint32_t count) {
+	uint32_t i = 0;
+	for(; i + 16 <= count; i += 16) {
+		uint8x16x4_t p = vld4q_u8(src + i * 4);
+		uint8x16x4_t out = { {
+			neon_premultiply(p.val[2], p.val[3]),
+			neon_premultiply(p.val[1], p.val[3]),
+			neon_premultiply(p.val[0], p.val[3]),
+			p.val[3]
+		} };
+		vst4q_u8((uint8_t*)(dst + i), out);
+	}
+	scalar_rgba_premultiply(dst + i, src + i * 4, count - i);
+}
+
+static inline uint16x8_t neon_rgb565(const uint8x8_t r, const uint8x8_t g, const uint8x8_t b) {
+	uint16x8_t v = vshll_n_u8(r, 8);
+	v = vsriq_n_u16(v, vshll_n_u8(g, 8), 5);
+	return vsriq_n_u16(v, vshll_n_u8(b, 8), 11);
+}
+
+static void neon_bgrx_to_rgb565(uint16_t* dst, const uint32_t* src, uint32_t count) {
+	uint32_t i = 0;
+	for(; i + 16 <= count; i += 16) {
+		uint8x16x4_t p = vld4q_u8((const uint8_t*)(src + i));
+		vst1q_u16(dst + i, neon_rgb565(vget_low_u8(p.val[2]), vget_low_u8(p.val[1]), vget_low_u8(p.val[0])));
+		vst1q_u16(dst + i + 8, neon_rgb565(vget_high_u8(p.val[2]), vget_high_u8(p.val[1]), vget_high_u8(p.val[0])));
+	}
+	scalar_bgrx_to_rgb565(dst + i, src + i, count - i);
+}
+
+static void neon_fill(uint32_t* dst, uint32_t value, uint32_t count) {
+	uint32x4_t v = vdupq_n_u32(value);
+	uint32_t i = 0;
+	for(; i + 8 <= count; i += 8) {
+		vst1q_u32(dst + i, v);
+		vst1q_u32(dst + i + 4, v);
+	}
+	scalar_fill(dst + i, value, count - i);
+}
+
+static void neon_copy(uint32_t* dst, const uint32_t* src, uint32_t count) {
+	uint32_t i = 0;
+	for(; i + 8 <= count; i += 8) {
+		uint32x4_t a = vld1q_u32(src + i);
+		uint32x4_t b = vld1q_u32(src + i + 4);
+		vst1q_u32(dst + i, a);
+		vst1q_u32(dst + i + 4, b);
+	}
+	scalar_copy(dst + i, src + i, count - i);
+}
+
+// a pixel and its right neighbour blended horizontally
+static inline uint16x4_t neon_blend_pair(const uint32_t* p, const uint16x8_t w) {
+	uint16x8_t v = vmulq_u16(vmovl_u8(vld1_u8((const uint8_t*)p)), w);
+	return vrshr_n_u16(vadd_u16(vget_low_u16(v), vget_high_u16(v)), 8);
+}
+
+static void neon_scale_bilinear(uint32_t* dst, uint32_t count, const uint32_t* src0, const uint32_t* src1,
+                                uint32_t x, uint32_t step, uint32_t wy) {
+	uint16x4_t wy0 = vdup_n_u16(256 - wy);
+	uint16x4_t wy1 = vdup_n_u16(wy);
+	for(uint32_t i = 0; i < count; i++, x += step) {
+		uint16_t fx = x >> 8 & 0xff;
+		uint16x8_t w = vcombine_u16(vdup_n_u16(256 - fx), vdup_n_u16(fx));
+		uint16x4_t top = neon_blend_pair(src0 + (x >> 16), w);
+		uint16x4_t bottom = neon_blend_pair(src1 + (x >> 16), w);
+		uint16x4_t v = vrshr_n_u16(vmla_u16(vmul_u16(top, wy0), bottom, wy1), 8);
+		vst1_lane_u32(dst + i, vreinterpret_u32_u8(vmovn_u16(vcombine_u16(v, v))), 0);
+	}
+}
+
+// no gather, nearest stays scalar
+static const pixel_kernels_t neon_kernels = {
+	neon_rgba_to_bgrx,
+	neon_rgba_premultiply,
+	neon_bgrx_to_rgb565,
+	neon_fill,
+	neon_copy,
+	scalar_scale_nearest,
+	neon_scale_bilinear
+};
+
+#endif // PIXEL_KERNELS_NEON
+
+static const pixel_kernels_t scalar_kernels = SCALAR_KERNELS;
+pixel_kernels_t pixel_kernels = SCALAR_KERNELS;
+
+int8_t pixel_kernels_get(const uint32_t isa, pixel_kernels_t* kernels) {
+	switch(isa) {
+	case PIXEL_ISA_SCALAR:
+		*kernels = scalar_kernels;
+		return 1;
+#ifdef PIXEL_KERNELS_X86
+	case PIXEL_ISA_SSE2:
+		if(!__builtin_cpu_supports("sse2")) return 0;
+		*kernels = sse2_kernels;
+		return 1;
+	case PIXEL_ISA_AVX2:
+		if(!__builtin_cpu_supports("avx2")) return 0;
+		*kernels = avx2_kernels;
+		return 1;
+#endif
+#ifdef PIXEL_KERNELS_NEON
+	// every aarch64 cpu has it, on 32 bit arm it is only built in when the target has it
+	case PIXEL_ISA_NEON:
+		*kernels = neon_kernels;
+		return 1;
+#endif
+	}
+	return 0;
+}
+
+uint32_t pixel_kernels_init(void) {
+#ifdef PIXEL_KERNELS_X86
+	__builtin_cpu_init();
+#endif
+	uint32_t isa = PIXEL_ISA_COUNT;
+	while(isa-- > 0 && !pixel_kernels_get(isa, &pixel_kernels));
+	platform_log(PLATFORM_LOG_LEVEL_DEBUG, "pixel kernels use %s", pixel_isa_names[isa]);
+	return isa;
+}
+
+void pixel_fill_rect(uint32_t* pixels, const uint32_t stride, const platform_rect_t* rect, const uint32_t value) {
+	uint32_t* row = pixels + (uint64_t)rect->y * stride + rect->x;
+	for(uint32_t y = 0; y < rect->height; y++, row += stride) pixel_kernels.fill(row, value, rect->width);
+}
+
+void pixel_copy_rect(uint32_t* dst, const uint32_t dst_stride, const uint32_t* src, const uint32_t src_stride,
+                     const uint32_t width, const uint32_t height) {
+	for(uint32_t y = 0; y < height; y++) {
+		pixel_kernels.copy(dst + (uint64_t)y * dst_stride, src + (uint64_t)y * src_stride, width);
+	}
+}
+
+// outside the centers of the first and last source pixels those are used as they are
+static inline uint32_t bilinear_edge_pixel(const uint32_t* src0, const uint32_t* src1, const int64_t x,
+                                           const uint32_t width, const uint32_t wy) {
+	uint32_t position = x < 0 ? 0 : x;
+	uint32_t i0 = position >> 16;
+	uint32_t i1 = i0 + 1 < width ? i0 + 1 : i0;
+	return bilinear_pixel(src0[i0], src0[i1], src1[i0], src1[i1], position >> 8 & 0xff, wy);
+}
+
+void pixel_scale(const pixel_kernels_t* kernels, const uint32_t filter,
+                 uint32_t* dst, const uint32_t dst_width, const uint32_t dst_height, const uint32_t dst_stride,
+                 const uint32_t* src, const uint32_t src_width, const uint32_t src_height, const uint32_t src_stride) {
+	if(dst_width == 0 || dst_height == 0 || src_width == 0 || src_height == 0) return;
+	uint32_t step_x = ((uint64_t)src_width << 16) / dst_width;
+	uint32_t step_y = ((uint64_t)src_height << 16) / dst_height;
+	if(filter == PIXEL_FILTER_NEAREST) {
+		uint32_t y = step_y / 2;
+		for(uint32_t row = 0; row < dst_height; row++, y += step_y) {
+			kernels->scale_nearest(dst + (uint64_t)row * dst_stride, dst_width, src + (uint64_t)(y >> 16) * src_stride, step_x / 2, step_x);
+		}
+		return;
+	}
+
+	// positions are of pixel centers, the kernel gets the columns that have both neighbours
+	int64_t x0 = (int64_t)(step_x / 2) - 32768;
+	int64_t last = (int64_t)(src_width - 1) << 16;
+	uint32_t begin = 0, end = dst_width;
+	while(begin < dst_width && x0 + (int64_t)begin * step_x < 0) begin++;
+	while(end > begin && x0 + (int64_t)(end - 1) * step_x >= last) end--;
+	int64_t y = (int64_t)(step_y / 2) - 32768;
+	for(uint32_t row = 0; row < dst_height; row++, y += step_y) {
+		uint32_t position = y < 0 ? 0 : y;
+		uint32_t iy = position >> 16;
+		uint32_t wy = position >> 8 & 0xff;
+		const uint32_t* src0 = src + (uint64_t)iy * src_stride;
+		const uint32_t* src1 = iy + 1 < src_height ? src0 + src_stride : src0;
+		uint32_t* out = dst + (uint64_t)row * dst_stride;
+		for(uint32_t i = 0; i < begin; i++) {
+			out[i] = bilinear_edge_pixel(src0, src1, x0 + (int64_t)i * step_x, src_width, wy);
+		}
+		if(end > begin) kernels->scale_bilinear(out + begin, end - begin, src0, src1, x0 + (int64_t)begin * step_x, step_x, wy);
+		for(uint32_t i = end; i < dst_width; i++) {
+			out[i] = bilinear_edge_pixel(src0, src1, x0 + (int64_t)i * step_x, src_width, wy);
+		}
+	}
+}
+
+// clips a rectangle at x, y to the framebuffer, returns 0 if nothing is left
+static int8_t clip(const platform_framebuffer_t* framebuffer, const int64_t x, const int64_t y,
+                   const uint64_t width, const uint64_t height, platform_rect_t* clipped) {
+	int64_t x0 = x > 0 ? x : 0;
+	int64_t y0 = y > 0 ? y : 0;
+	int64_t x1 = x + (int64_t)width < framebuffer->width ? x + (int64_t)width : framebuffer->width;
+	int64_t y1 = y + (int64_t)height < framebuffer->height ? y + (int64_t)height : framebuffer->height;
+	if(x0 >= x1 || y0 >= y1) return 0;
+	clipped->x = x0;
+	clipped->y = y0;
+	clipped->width = x1 - x0;
+	clipped->height = y1 - y0;
+	return 1;
+}
+
+void platform_framebuffer_fill(platform_framebuffer_t* framebuffer, const platform_rect_t* rect, const uint32_t color) {
+	platform_rect_t clipped;
+	if(!clip(framebuffer, rect->x, rect->y, rect->width, rect->height, &clipped)) return;
+	pixel_fill_rect(framebuffer->pixels, framebuffer->stride, &clipped, color);
+}
+
+void platform_framebuffer_write_rgba(platform_framebuffer_t* framebuffer, const int32_t x, const int32_t y,
+                                     const uint8_t* pixels, const uint32_t width, const uint32_t height,
+                                     const uint32_t stride, const int8_t premultiply) {
+	platform_rect_t clipped;
+	if(!clip(framebuffer, x, y, width, height, &clipped)) return;
+	void (*convert)(uint32_t*, const uint8_t*, uint32_t) = premultiply ? pixel_kernels.rgba_premultiply : pixel_kernels.rgba_to_bgrx;
+	const uint8_t* src = pixels + (uint64_t)(clipped.y - y) * stride + (uint64_t)(clipped.x - x) * 4;
+	uint32_t* dst = framebuffer->pixels + (uint64_t)clipped.y * framebuffer->stride + clipped.x;
+	for(uint32_t row = 0; row < clipped.height; row++, src += stride, dst += framebuffer->stride) {
+		convert(dst, src, clipped.width);
+	}
+}
+
+void platform_framebuffer_scale(platform_framebuffer_t* dst, const platform_framebuffer_t* src, const uint32_t filter) {
+	pixel_scale(&pixel_kernels, filter, dst->pixels, dst->width, dst->height, dst->stride,
+	            src->pixels, src->width, src->height, src->stride);
+}
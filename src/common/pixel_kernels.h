@@ -0,0 +1,56 @@
+#ifndef PIXEL_KERNELS_H
+#define PIXEL_KERNELS_H
+
+#include "platform/platform.h"
+
+// instruction set levels, pixel_kernels_init picks the best the cpu has
+#define PIXEL_ISA_SCALAR 0
+#define PIXEL_ISA_SSE2   1
+#define PIXEL_ISA_AVX2   2
+#define PIXEL_ISA_NEON   3
+#define PIXEL_ISA_COUNT  4
+
+#define PIXEL_FILTER_NEAREST  PLATFORM_FILTER_NEAREST
+#define PIXEL_FILTER_BILINEAR PLATFORM_FILTER_BILINEAR
+
+// every kernel works on a single row of count pixels. framebuffer pixels are
+// 0x00RRGGBB, which is B, G, R, X in memory, rgba pixels are bytes in that order.
+// every level gives the same result as the scalar one, bit for bit
+typedef struct {
+	// rgba to framebuffer pixels, alpha is dropped
+	void (*rgba_to_bgrx)(uint32_t* dst, const uint8_t* src, uint32_t count);
+	// rgba to premultiplied 0xAARRGGBB, rounded to the nearest of c * a / 255
+	void (*rgba_premultiply)(uint32_t* dst, const uint8_t* src, uint32_t count);
+	// framebuffer pixels for 16 bit visuals, the low bits are cut off
+	void (*bgrx_to_rgb565)(uint16_t* dst, const uint32_t* src, uint32_t count);
+	void (*fill)(uint32_t* dst, uint32_t value, uint32_t count);
+	void (*copy)(uint32_t* dst, const uint32_t* src, uint32_t count);
+	// x is the 16.16 fixed point source position of the first pixel and step
+	// the distance to the next, every position has to be inside src
+	void (*scale_nearest)(uint32_t* dst, uint32_t count, const uint32_t* src, uint32_t x, uint32_t step);
+	// blends src0 and src1 with wy / 256 of src1, the pixel right of every
+	// position has to be inside the rows as well
+	void (*scale_bilinear)(uint32_t* dst, uint32_t count, const uint32_t* src0, const uint32_t* src1,
+	                       uint32_t x, uint32_t step, uint32_t wy);
+} pixel_kernels_t;
+
+// scalar until pixel_kernels_init
+extern pixel_kernels_t pixel_kernels;
+extern const char* const pixel_isa_names[PIXEL_ISA_COUNT];
+
+// returns the chosen level
+uint32_t pixel_kernels_init(void);
+// returns 0 if the level is not built in or the cpu does not have it
+int8_t pixel_kernels_get(const uint32_t isa, pixel_kernels_t* kernels);
+
+// the rectangles have to be inside the pixels
+void pixel_fill_rect(uint32_t* pixels, const uint32_t stride, const platform_rect_t* rect, const uint32_t value);
+void pixel_copy_rect(uint32_t* dst, const uint32_t dst_stride, const uint32_t* src, const uint32_t src_stride,
+                     const uint32_t width, const uint32_t height);
+// scales all of src onto all of dst with pixel centers mapped onto each other,
+// sizes up to 65535 pixels
+void pixel_scale(const pixel_kernels_t* kernels, const uint32_t filter,
+                 uint32_t* dst, const uint32_t dst_width, const uint32_t dst_height, const uint32_t dst_stride,
+                 const uint32_t* src, const uint32_t src_width, const uint32_t src_height, const uint32_t src_stride);
+
+#endif // PIXEL_KERNELS_H
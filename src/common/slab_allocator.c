@@ -0,0 +1,305 @@
+#include "slab_allocator.h"
+#include <stdatomic.h>
+#include <string.h>
+#include <threads.h>
+
+#define SLABS_PER_CHUNK    32
+#define CLASS_COUNT        8
+#define MAX_CLASS_SIZE     (1 << (MIN_CLASS_SHIFT + CLASS_COUNT - 1))
+#define MAGAZINE_CAPACITY  64
+
+typedef struct free_object_t {
+	struct free_object_t* next;
+} free_object_t;
+
+typedef struct {
+	atomic_flag    lock;
+	free_object_t* free_list;
+	uint8_t*       bump;     // next never used object in the current slab
+	uint8_t*       bump_end;
+} slab_class_t;
+
+typedef struct thread_cache_t {
+	platform_slab_allocator_t* owner;
+	struct thread_cache_t*     next;
+	int8_t                     in_use; // caches of exited threads are reused
+	uint32_t                   counts[CLASS_COUNT];
+	void*                      objects[CLASS_COUNT][MAGAZINE_CAPACITY];
+} thread_cache_t;
+
+typedef struct slab_chunk_t {
+	struct slab_chunk_t* next;
+	uint8_t*             mapping;
+	uint64_t             mapping_size;
+	// the tracking entries of every slab in the chunk, the pages
+	// are only backed once a tracking allocator writes to them
+	uint32_t*            tracking;
+} slab_chunk_t;
+
+struct platform_slab_allocator_t {
+	slab_class_t    classes[CLASS_COUNT];
+	tss_t           cache_key;
+	atomic_flag     lock; // guards everything below
+	uint8_t*        free_slabs;
+	uint32_t        free_slab_count;
+	slab_chunk_t*   chunks;
+	thread_cache_t* caches;
+};
+
+static inline void spin_lock(atomic_flag* lock) {
+	while(atomic_flag_test_and_set_explicit(lock, memory_order_acquire));
+}
+static inline void spin_unlock(atomic_flag* lock) {
+	atomic_flag_clear_explicit(lock, memory_order_release);
+}
+
+static inline uint32_t class_size(const uint32_t class_index) {
+	return 1u << (class_index + MIN_CLASS_SHIFT);
+}
+
+static inline uint32_t size_to_class(uint64_t size) {
+	if(size <= (1 << MIN_CLASS_SHIFT)) return 0;
+	uint32_t class_index = 0;
+	size = (size - 1) >> MIN_CLASS_SHIFT;
+	while(size != 0) {
+		size >>= 1;
+		class_index++;
+	}
+	return class_index;
+}
+
+// objects are naturally aligned since the data starts on a multiple of the object size
+static inline uint64_t slab_data_offset(const uint32_t class_index) {
+	return class_size(class_index) > SLAB_HEADER_SIZE ? class_size(class_index) : SLAB_HEADER_SIZE;
+}
+
+// maps size bytes aligned to SLAB_SIZE, the slack used for aligning is unmapped again
+static uint8_t* map_aligned(const uint64_t size) {
+	uint8_t* mapping = platform_map_memory(NULL, size + SLAB_SIZE);
+	if(mapping == NULL) return NULL;
+	uint8_t* aligned = (uint8_t*)(((uintptr_t)mapping + SLAB_SIZE - 1) & ~(uintptr_t)(SLAB_SIZE - 1));
+	if(aligned != mapping) platform_unmap_memory(mapping, aligned - mapping);
+	uint64_t tail = (mapping + size + SLAB_SIZE) - (aligned + size);
+	if(tail != 0) platform_unmap_memory(aligned + size, tail);
+	return aligned;
+}
+
+static uint8_t* allocator_take_slab(platform_slab_allocator_t* allocator, uint32_t** tracking) {
+	spin_lock(&allocator->lock);
+	if(allocator->free_slab_count == 0) {
+		uint64_t size = (uint64_t)SLAB_SIZE * SLABS_PER_CHUNK;
+		uint8_t* mapping = map_aligned(size);
+		if(mapping == NULL) {
+			spin_unlock(&allocator->lock);
+			return NULL;
+		}
+		uint32_t* chunk_tracking = platform_map_memory(NULL, sizeof(uint32_t) * TRACKING_ENTRIES * SLABS_PER_CHUNK);
+		if(chunk_tracking == NULL) {
+			platform_unmap_memory(mapping, size);
+			spin_unlock(&allocator->lock);
+			return NULL;
+		}
+		// the first slab of every chunk keeps track of the chunk itself
+		slab_chunk_t* chunk = (slab_chunk_t*)mapping;
+		chunk->next = allocator->chunks;
+		chunk->mapping = mapping;
+		chunk->mapping_size = size;
+		chunk->tracking = chunk_tracking;
+		allocator->chunks = chunk;
+		allocator->free_slabs = mapping + SLAB_SIZE;
+		allocator->free_slab_count = SLABS_PER_CHUNK - 1;
+	}
+	uint8_t* slab = allocator->free_slabs;
+	slab_chunk_t* chunk = allocator->chunks;
+	*tracking = chunk->tracking + (uint64_t)((slab - chunk->mapping) / SLAB_SIZE) * TRACKING_ENTRIES;
+	allocator->free_slabs += SLAB_SIZE;
+	allocator->free_slab_count--;
+	spin_unlock(&allocator->lock);
+	return slab;
+}
+
+// moves up to count objects from the shared class into out, returns how many were moved
+static uint32_t class_refill(platform_slab_allocator_t* allocator, const uint32_t class_index, void** out, const uint32_t count) {
+	slab_class_t* c = &allocator->classes[class_index];
+	uint32_t size = class_size(class_index);
+	uint32_t taken = 0;
+	spin_lock(&c->lock);
+	while(taken < count && c->free_list != NULL) {
+		out[taken++] = c->free_list;
+		c->free_list = c->free_list->next;
+	}
+	while(taken < count) {
+		if(c->bump == c->bump_end) {
+			uint32_t* tracking;
+			uint8_t* slab = allocator_take_slab(allocator, &tracking);
+			if(slab == NULL) break;
+			((slab_header_t*)slab)->class_index = class_index;
+			((slab_header_t*)slab)->tracking = tracking;
+			c->bump = slab + slab_data_offset(class_index);
+			c->bump_end = slab + SLAB_SIZE;
+		}
+		out[taken++] = c->bump;
+		c->bump += size;
+	}
+	spin_unlock(&c->lock);
+	return taken;
+}
+
+static void class_release(platform_slab_allocator_t* allocator, const uint32_t class_index, void** objects, const uint32_t count) {
+	if(count == 0) return;
+	// link the batch first so the lock is only held for the splice
+	for(uint32_t i = 0; i + 1 < count; i++) ((free_object_t*)objects[i])->next = objects[i + 1];
+	slab_class_t* c = &allocator->classes[class_index];
+	spin_lock(&c->lock);
+	((free_object_t*)objects[count - 1])->next = c->free_list;
+	c->free_list = objects[0];
+	spin_unlock(&c->lock);
+}
+
+static void thread_cache_flush(void* data) {
+	thread_cache_t* cache = data;
+	for(uint32_t i = 0; i < CLASS_COUNT; i++) {
+		class_release(cache->owner, i, cache->objects[i], cache->counts[i]);
+		cache->counts[i] = 0;
+	}
+	spin_lock(&cache->owner->lock);
+	cache->in_use = 0;
+	spin_unlock(&cache->owner->lock);
+}
+
+static thread_cache_t* get_thread_cache(platform_slab_allocator_t* allocator) {
+	thread_cache_t* cache = tss_get(allocator->cache_key);
+	if(cache != NULL) return cache;
+
+	spin_lock(&allocator->lock);
+	cache = allocator->caches;
+	while(cache != NULL && cache->in_use) cache = cache->next;
+	if(cache != NULL) cache->in_use = 1;
+	spin_unlock(&allocator->lock);
+
+	if(cache == NULL) {
+		cache = platform_map_memory(NULL, sizeof(thread_cache_t));
+		if(cache == NULL) return NULL;
+		cache->owner = allocator;
+		cache->in_use = 1;
+		spin_lock(&allocator->lock);
+		cache->next = allocator->caches;
+		allocator->caches = cache;
+		spin_unlock(&allocator->lock);
+	}
+	tss_set(allocator->cache_key, cache);
+	return cache;
+}
+
+platform_slab_allocator_t* platform_slab_allocator_create(void) {
+	platform_slab_allocator_t* allocator = platform_map_memory(NULL, sizeof(platform_slab_allocator_t));
+	if(allocator == NULL) return NULL;
+	if(tss_create(&allocator->cache_key, thread_cache_flush) != thrd_success) {
+		platform_unmap_memory(allocator, sizeof(platform_slab_allocator_t));
+		return NULL;
+	}
+	for(uint32_t i = 0; i < CLASS_COUNT; i++) atomic_flag_clear(&allocator->classes[i].lock);
+	atomic_flag_clear(&allocator->lock);
+	return allocator;
+}
+
+void platform_slab_allocator_destroy(platform_slab_allocator_t* allocator) {
+	tss_delete(allocator->cache_key);
+	thread_cache_t* cache = allocator->caches;
+	while(cache != NULL) {
+		thread_cache_t* next = cache->next;
+		platform_unmap_memory(cache, sizeof(thread_cache_t));
+		cache = next;
+	}
+	slab_chunk_t* chunk = allocator->chunks;
+	while(chunk != NULL) {
+		slab_chunk_t* next = chunk->next;
+		platform_unmap_memory(chunk->tracking, sizeof(uint32_t) * TRACKING_ENTRIES * SLABS_PER_CHUNK);
+		platform_unmap_memory(chunk->mapping, chunk->mapping_size);
+		chunk = next;
+	}
+	platform_unmap_memory(allocator, sizeof(platform_slab_allocator_t));
+}
+
+void* platform_slab_alloc(platform_slab_allocator_t* allocator, const uint64_t size, const uint64_t alignment) {
+	uint64_t needed = size > alignment ? size : alignment;
+	if(needed > MAX_CLASS_SIZE) {
+		uint64_t offset = alignment > SLAB_HEADER_SIZE ? alignment : SLAB_HEADER_SIZE;
+		if(offset >= SLAB_SIZE) return NULL;
+		uint8_t* mapping = map_aligned(offset + size);
+		if(mapping == NULL) return NULL;
+		slab_header_t* header = (slab_header_t*)mapping;
+		header->class_index = LARGE_CLASS;
+		header->mapping_size = offset + size;
+		return mapping + offset;
+	}
+
+	uint32_t class_index = size_to_class(needed);
+	thread_cache_t* cache = get_thread_cache(allocator);
+	if(cache == NULL) return NULL;
+	if(cache->counts[class_index] == 0) {
+		cache->counts[class_index] = class_refill(allocator, class_index, cache->objects[class_index], MAGAZINE_CAPACITY / 2);
+		if(cache->counts[class_index] == 0) return NULL;
+	}
+	return cache->objects[class_index][--cache->counts[class_index]];
+}
+
+void platform_slab_free(platform_slab_allocator_t* allocator, void* addr) {
+	if(addr == NULL) return;
+	slab_header_t* header = (slab_header_t*)((uintptr_t)addr & ~(uintptr_t)(SLAB_SIZE - 1));
+	if(header->class_index == LARGE_CLASS) {
+		platform_unmap_memory(header, header->mapping_size);
+		return;
+	}
+
+	uint32_t class_index = header->class_index;
+	thread_cache_t* cache = get_thread_cache(allocator);
+	if(cache == NULL) {
+		class_release(allocator, class_index, &addr, 1);
+		return;
+	}
+	if(cache->counts[class_index] == MAGAZINE_CAPACITY) {
+		// keep the newer half, those are more likely to still be in cache
+		class_release(allocator, class_index, cache->objects[class_index], MAGAZINE_CAPACITY / 2);
+		memmove(cache->objects[class_index], cache->objects[class_index] + MAGAZINE_CAPACITY / 2,
+		        sizeof(void*) * (MAGAZINE_CAPACITY / 2));
+		cache->counts[class_index] = MAGAZINE_CAPACITY / 2;
+	}
+	cache->objects[class_index][cache->counts[class_index]++] = addr;
+}
+
+static void* slab_callback_alloc(void* user_data, uint64_t size, uint64_t alignment) {
+	return platform_slab_alloc(user_data, size, alignment);
+}
+
+static void slab_callback_free(void* user_data, void* addr) {
+	platform_slab_free(user_data, addr);
+}
+
+static void* slab_callback_realloc(void* user_data, void* addr, uint64_t size) {
+	if(addr == NULL) return platform_slab_alloc(user_data, size, 16);
+	slab_header_t* header = (slab_header_t*)((uintptr_t)addr & ~(uintptr_t)(SLAB_SIZE - 1));
+	uint64_t old_size = header->class_index == LARGE_CLASS
+	                  ? header->mapping_size - ((uint8_t*)addr - (uint8_t*)header)
+	                  : class_size(header->class_index);
+	if(size <= old_size && (header->class_index == LARGE_CLASS || size > old_size / 2)) return addr;
+
+	void* new_addr = platform_slab_alloc(user_data, size, 16);
+	if(new_addr == NULL) return NULL;
+	memcpy(new_addr, addr, size < old_size ? size : old_size);
+	platform_slab_free(user_data, addr);
+	return new_addr;
+}
+
+int8_t slab_is_callbacks(const platform_allocation_callbacks_t* callbacks) {
+	return callbacks != NULL && callbacks->alloc == slab_callback_alloc;
+}
+
+platform_allocation_callbacks_t platform_slab_callbacks(platform_slab_allocator_t* allocator) {
+	platform_allocation_callbacks_t callbacks;
+	callbacks.alloc = slab_callback_alloc;
+	callbacks.free = slab_callback_free;
+	callbacks.realloc = slab_callback_realloc;
+	callbacks.user_data = allocator;
+	return callbacks;
+}
@@ -0,0 +1,52 @@
+#ifndef SLAB_ALLOCATOR_H
+#define SLAB_ALLOCATOR_H
+
+#include "platform/platform.h"
+
+// every slab and large allocation starts on a SLAB_SIZE boundary with a header,
+// so the owner of any address is found by rounding it down
+#define SLAB_SIZE          (64 * 1024)
+#define SLAB_HEADER_SIZE   64
+#define MIN_CLASS_SHIFT    4 // 16 bytes
+#define LARGE_CLASS        0xffffffff
+// a tracking entry per object, indexed by the object's offset in the slab divided by its size.
+// dense for every class, so the entries of objects in use together share cache lines
+#define TRACKING_ENTRIES   (SLAB_SIZE >> MIN_CLASS_SHIFT)
+
+typedef struct {
+	uint32_t  class_index;
+	uint32_t  tracking_tag; // only used by large allocations, their size is known
+	uint64_t  mapping_size; // only used by large allocations
+	uint32_t* tracking;     // TRACKING_ENTRIES, only written for tracked objects
+} slab_header_t;
+
+// the tracking allocator keeps the size and tag of blocks from a slab allocator in
+// the side table instead of a header, which would push every power of two size into
+// the next class and the largest ones out of the slabs
+int8_t slab_is_callbacks(const platform_allocation_callbacks_t* callbacks);
+
+static inline slab_header_t* slab_header(const void* addr) {
+	return (slab_header_t*)((uintptr_t)addr & ~(uintptr_t)(SLAB_SIZE - 1));
+}
+// small objects pack the size above the tag, they are at most 2048 bytes. tag has to be below 256
+static inline void slab_set_tracking(void* addr, const uint64_t size, const uint32_t tag) {
+	slab_header_t* header = slab_header(addr);
+	if(header->class_index == LARGE_CLASS) {
+		header->tracking_tag = tag;
+		return;
+	}
+	header->tracking[((uint8_t*)addr - (uint8_t*)header) >> (header->class_index + MIN_CLASS_SHIFT)] = (uint32_t)size << 8 | tag;
+}
+static inline void slab_get_tracking(const void* addr, uint64_t* size, uint32_t* tag) {
+	const slab_header_t* header = slab_header(addr);
+	if(header->class_index == LARGE_CLASS) {
+		*size = header->mapping_size - ((const uint8_t*)addr - (const uint8_t*)header);
+		*tag = header->tracking_tag;
+		return;
+	}
+	uint32_t entry = header->tracking[((const uint8_t*)addr - (const uint8_t*)header) >> (header->class_index + MIN_CLASS_SHIFT)];
+	*size = entry >> 8;
+	*tag = entry & 0xff;
+}
+
+#endif // SLAB_ALLOCATOR_H
@@ -0,0 +1,378 @@
+#include "platform/platform.h"
+#include "slab_allocator.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// allocations from other allocators than the slab one are prefixed by a header,
+// the offset keeps the user pointer aligned
+typedef struct {
+	uint64_t size;
+	uint32_t offset;
+	uint32_t tag_index;
+} tracking_header_t;
+
+#define HEADER_OFFSET(alignment) ((alignment) > sizeof(tracking_header_t) ? (alignment) : sizeof(tracking_header_t))
+
+// counters are split into shards owned by one thread each, so counting is a plain
+// load and store instead of a locked instruction. threads beyond THREAD_SHARDS
+// share the last shard and fall back to atomic adds
+#define THREAD_SHARDS 64
+#define SHARED_SHARD  THREAD_SHARDS
+#define TAG_SLOTS     (PLATFORM_TRACKING_MAX_TAGS + 1) // slot 0 collects untagged allocations and tags that did not fit
+// live bytes are only moved to the shared total once a shard's balance passes this,
+// which bounds how far the recorded peak can be off
+#define PEAK_SLACK    (64 * 1024)
+
+// the allocation count is the sum of the size class counts
+typedef struct {
+	_Alignas(64) atomic_uint_fast64_t pending_bytes; // signed balance not yet added to live_bytes
+	atomic_uint_fast64_t frees;
+	atomic_uint_fast64_t size_class_counts[PLATFORM_TRACKING_SIZE_CLASSES];
+	// per shard values wrap when freed on another thread, the sum is still right
+	atomic_uint_fast64_t tag_bytes[TAG_SLOTS];
+	atomic_uint_fast64_t tag_counts[TAG_SLOTS];
+} tracking_shard_t;
+
+struct platform_tracking_allocator_t {
+	const char*                     name;
+	platform_allocation_callbacks_t inner;
+	int8_t                          has_inner;
+	int8_t                          slab_inner; // sizes and tags go to the slab allocator's side table
+	_Alignas(64) atomic_uint_fast64_t live_bytes;
+	atomic_uint_fast64_t              peak_bytes;
+	_Atomic(const char*)              tags[TAG_SLOTS];
+	tracking_shard_t                  shards[THREAD_SHARDS + 1];
+	struct platform_tracking_allocator_t* next;
+};
+
+static _Thread_local const char* thread_tag = NULL;
+static _Thread_local uint32_t thread_shard = UINT32_MAX;
+
+// shard indices are shared by all trackers and handed back when a thread exits
+static once_flag shard_key_once = ONCE_FLAG_INIT;
+static tss_t shard_key;
+static atomic_flag shards_lock = ATOMIC_FLAG_INIT;
+static uint32_t next_shard = 0;
+static uint32_t free_shards[THREAD_SHARDS];
+static uint32_t free_shard_count = 0;
+
+// every live tracking allocator, walked for the leak report on shutdown
+static platform_tracking_allocator_t* trackers = NULL;
+static atomic_flag trackers_lock = ATOMIC_FLAG_INIT;
+
+static inline void spin_lock(atomic_flag* lock) {
+	while(atomic_flag_test_and_set_explicit(lock, memory_order_acquire));
+}
+static inline void spin_unlock(atomic_flag* lock) {
+	atomic_flag_clear_explicit(lock, memory_order_release);
+}
+
+static void release_shard(void* data) {
+	uint32_t shard = (uint32_t)((uintptr_t)data - 1);
+	// frees from later thread exit destructors must not touch a shard another thread may own by then
+	thread_shard = SHARED_SHARD;
+	spin_lock(&shards_lock);
+	free_shards[free_shard_count++] = shard;
+	spin_unlock(&shards_lock);
+}
+static void create_shard_key(void) {
+	tss_create(&shard_key, release_shard);
+}
+
+static inline uint32_t get_thread_shard(void) {
+	if(thread_shard != UINT32_MAX) return thread_shard;
+	call_once(&shard_key_once, create_shard_key);
+	spin_lock(&shards_lock);
+	if(free_shard_count != 0) thread_shard = free_shards[--free_shard_count];
+	else if(next_shard < THREAD_SHARDS) thread_shard = next_shard++;
+	else thread_shard = SHARED_SHARD;
+	spin_unlock(&shards_lock);
+	if(thread_shard != SHARED_SHARD) tss_set(shard_key, (void*)(uintptr_t)(thread_shard + 1));
+	return thread_shard;
+}
+
+// only for shards owned by the calling thread
+static inline void counter_add(atomic_uint_fast64_t* counter, const uint64_t value) {
+	atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + value, memory_order_relaxed);
+}
+
+static inline void* inner_alloc(platform_tracking_allocator_t* tracker, const uint64_t size, const uint64_t alignment) {
+	if(tracker->has_inner) return tracker->inner.alloc(tracker->inner.user_data, size, alignment);
+	#ifdef _WIN32
+		return _aligned_malloc(size, alignment);
+	#else
+		return aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+	#endif
+}
+static inline void inner_free(platform_tracking_allocator_t* tracker, void* addr) {
+	if(tracker->has_inner) tracker->inner.free(tracker->inner.user_data, addr);
+	else {
+		#ifdef _WIN32
+			_aligned_free(addr);
+		#else
+			free(addr);
+		#endif
+	}
+}
+static inline void* inner_realloc(platform_tracking_allocator_t* tracker, void* addr, const uint64_t size, const uint64_t alignment) {
+	if(tracker->has_inner) return tracker->inner.realloc(tracker->inner.user_data, addr, size);
+	#ifdef _WIN32
+		return _aligned_realloc(addr, size, alignment);
+	#else
+		return realloc(addr, size);
+	#endif
+}
+
+static inline uint32_t size_class(const uint64_t size) {
+	if(size == 0) return 0;
+	#ifdef _MSC_VER
+		unsigned long highest_bit;
+		_BitScanReverse64(&highest_bit, size);
+		uint32_t class_index = highest_bit + 1;
+	#else
+		uint32_t class_index = 64 - __builtin_clzll(size);
+	#endif
+	return class_index < PLATFORM_TRACKING_SIZE_CLASSES - 1 ? class_index : PLATFORM_TRACKING_SIZE_CLASSES - 1;
+}
+
+static uint32_t tag_index(platform_tracking_allocator_t* tracker, const char* tag) {
+	if(tag == NULL) return 0;
+	for(uint32_t i = 1; i < TAG_SLOTS; i++) {
+		const char* current = atomic_load_explicit(&tracker->tags[i], memory_order_acquire);
+		if(current == tag) return i;
+		if(current == NULL) {
+			const char* expected = NULL;
+			if(atomic_compare_exchange_strong(&tracker->tags[i], &expected, tag) || expected == tag) return i;
+		}
+	}
+	return 0;
+}
+
+static void add_live_bytes(platform_tracking_allocator_t* tracker, const uint64_t delta) {
+	uint64_t live = atomic_fetch_add_explicit(&tracker->live_bytes, delta, memory_order_relaxed) + delta;
+	uint64_t peak = atomic_load_explicit(&tracker->peak_bytes, memory_order_relaxed);
+	while((int64_t)live > (int64_t)peak && !atomic_compare_exchange_weak_explicit(&tracker->peak_bytes, &peak, live,
+	                                                                              memory_order_relaxed, memory_order_relaxed));
+}
+
+static inline void update_live_bytes(platform_tracking_allocator_t* tracker, tracking_shard_t* shard, const uint64_t delta) {
+	uint64_t pending = atomic_load_explicit(&shard->pending_bytes, memory_order_relaxed) + delta;
+	if(pending + PEAK_SLACK < 2 * PEAK_SLACK) {
+		atomic_store_explicit(&shard->pending_bytes, pending, memory_order_relaxed);
+		return;
+	}
+	atomic_store_explicit(&shard->pending_bytes, 0, memory_order_relaxed);
+	add_live_bytes(tracker, pending);
+}
+
+// threads without a shard of their own count with atomic adds, kept out of the common path
+static void record_shared(platform_tracking_allocator_t* tracker, const uint64_t size, const uint32_t tag, const int8_t is_alloc) {
+	tracking_shard_t* shard = &tracker->shards[SHARED_SHARD];
+	add_live_bytes(tracker, is_alloc ? size : -size);
+	if(is_alloc) atomic_fetch_add_explicit(&shard->size_class_counts[size_class(size)], 1, memory_order_relaxed);
+	else atomic_fetch_add_explicit(&shard->frees, 1, memory_order_relaxed);
+	if(tag == 0) return;
+	atomic_fetch_add_explicit(&shard->tag_bytes[tag], is_alloc ? size : -size, memory_order_relaxed);
+	atomic_fetch_add_explicit(&shard->tag_counts[tag], is_alloc ? 1 : -1, memory_order_relaxed);
+}
+
+static inline void record_alloc(platform_tracking_allocator_t* tracker, const uint64_t size, const uint32_t tag) {
+	uint32_t shard_index = get_thread_shard();
+	if(shard_index == SHARED_SHARD) {
+		record_shared(tracker, size, tag, 1);
+		return;
+	}
+	tracking_shard_t* shard = &tracker->shards[shard_index];
+	update_live_bytes(tracker, shard, size);
+	counter_add(&shard->size_class_counts[size_class(size)], 1);
+	// untagged usage is never reported, it is whatever the tags do not account for
+	if(tag == 0) return;
+	counter_add(&shard->tag_bytes[tag], size);
+	counter_add(&shard->tag_counts[tag], 1);
+}
+
+static inline void record_free(platform_tracking_allocator_t* tracker, const uint64_t size, const uint32_t tag) {
+	uint32_t shard_index = get_thread_shard();
+	if(shard_index == SHARED_SHARD) {
+		record_shared(tracker, size, tag, 0);
+		return;
+	}
+	tracking_shard_t* shard = &tracker->shards[shard_index];
+	update_live_bytes(tracker, shard, -size);
+	counter_add(&shard->frees, 1);
+	if(tag == 0) return;
+	counter_add(&shard->tag_bytes[tag], -size);
+	counter_add(&shard->tag_counts[tag], -1);
+}
+
+static void* tracking_alloc(void* user_data, uint64_t size, uint64_t alignment) {
+	platform_tracking_allocator_t* tracker = user_data;
+	if(tracker->slab_inner) {
+		void* addr = platform_slab_alloc(tracker->inner.user_data, size, alignment);
+		if(addr == NULL) return NULL;
+		uint32_t tag = tag_index(tracker, thread_tag);
+		slab_set_tracking(addr, size, tag);
+		record_alloc(tracker, size, tag);
+		return addr;
+	}
+	if(alignment < 16) alignment = 16;
+	uint64_t offset = HEADER_OFFSET(alignment);
+	uint8_t* base = inner_alloc(tracker, size + offset, alignment);
+	if(base == NULL) return NULL;
+	tracking_header_t* header = (tracking_header_t*)(base + offset) - 1;
+	header->size = size;
+	header->offset = offset;
+	header->tag_index = tag_index(tracker, thread_tag);
+	record_alloc(tracker, header->size, header->tag_index);
+	return base + offset;
+}
+
+static void tracking_free(void* user_data, void* addr) {
+	if(addr == NULL) return;
+	platform_tracking_allocator_t* tracker = user_data;
+	if(tracker->slab_inner) {
+		uint64_t size;
+		uint32_t tag;
+		slab_get_tracking(addr, &size, &tag);
+		record_free(tracker, size, tag);
+		platform_slab_free(tracker->inner.user_data, addr);
+		return;
+	}
+	tracking_header_t* header = (tracking_header_t*)addr - 1;
+	record_free(tracker, header->size, header->tag_index);
+	inner_free(tracker, (uint8_t*)addr - header->offset);
+}
+
+// NOTE: realloc does not take an alignment, so blocks allocated with
+// more than 16 byte alignment may lose it when moved
+static void* tracking_realloc(void* user_data, void* addr, uint64_t size) {
+	if(addr == NULL) return tracking_alloc(user_data, size, 16);
+	platform_tracking_allocator_t* tracker = user_data;
+	if(tracker->slab_inner) {
+		uint64_t old_size;
+		uint32_t tag;
+		slab_get_tracking(addr, &old_size, &tag);
+		void* new_addr = tracker->inner.realloc(tracker->inner.user_data, addr, size);
+		if(new_addr == NULL) return NULL;
+		slab_set_tracking(new_addr, size, tag);
+		record_free(tracker, old_size, tag);
+		record_alloc(tracker, size, tag);
+		return new_addr;
+	}
+	tracking_header_t* header = (tracking_header_t*)addr - 1;
+	tracking_header_t old_header = *header;
+	uint8_t* base = inner_realloc(tracker, (uint8_t*)addr - old_header.offset, size + old_header.offset, old_header.offset);
+	if(base == NULL) return NULL;
+	record_free(tracker, old_header.size, old_header.tag_index);
+	header = (tracking_header_t*)(base + old_header.offset) - 1;
+	header->size = size;
+	record_alloc(tracker, header->size, header->tag_index);
+	return base + old_header.offset;
+}
+
+platform_tracking_allocator_t* platform_tracking_allocator_create(const char* name, const platform_allocation_callbacks_t* inner) {
+	platform_tracking_allocator_t* tracker = platform_map_memory(NULL, sizeof(platform_tracking_allocator_t));
+	if(tracker == NULL) return NULL;
+	tracker->name = name;
+	tracker->has_inner = inner != NULL;
+	tracker->slab_inner = slab_is_callbacks(inner);
+	if(inner != NULL) tracker->inner = *inner;
+
+	spin_lock(&trackers_lock);
+	tracker->next = trackers;
+	trackers = tracker;
+	spin_unlock(&trackers_lock);
+	return tracker;
+}
+
+void platform_tracking_allocator_destroy(platform_tracking_allocator_t* tracker) {
+	spin_lock(&trackers_lock);
+	platform_tracking_allocator_t** link = &trackers;
+	while(*link != NULL && *link != tracker) link = &(*link)->next;
+	if(*link != NULL) *link = tracker->next;
+	spin_unlock(&trackers_lock);
+	platform_unmap_memory(tracker, sizeof(platform_tracking_allocator_t));
+}
+
+platform_allocation_callbacks_t platform_tracking_callbacks(platform_tracking_allocator_t* tracker) {
+	platform_allocation_callbacks_t callbacks;
+	callbacks.alloc = tracking_alloc;
+	callbacks.free = tracking_free;
+	callbacks.realloc = tracking_realloc;
+	callbacks.user_data = tracker;
+	return callbacks;
+}
+
+const char* platform_tracking_set_tag(const char* tag) {
+	const char* previous = thread_tag;
+	thread_tag = tag;
+	return previous;
+}
+
+void platform_tracking_get_stats(const platform_tracking_allocator_t* tracker, platform_allocation_stats_t* stats) {
+	// the counters are read one at a time, so a snapshot taken
+	// while other threads allocate is only approximately consistent
+	platform_tracking_allocator_t* t = (platform_tracking_allocator_t*)tracker;
+	memset(stats, 0, sizeof(platform_allocation_stats_t));
+	stats->live_bytes = atomic_load_explicit(&t->live_bytes, memory_order_relaxed);
+	stats->peak_bytes = atomic_load_explicit(&t->peak_bytes, memory_order_relaxed);
+
+	uint64_t tag_bytes[TAG_SLOTS] = {0};
+	uint64_t tag_counts[TAG_SLOTS] = {0};
+	for(uint32_t s = 0; s <= THREAD_SHARDS; s++) {
+		tracking_shard_t* shard = &t->shards[s];
+		stats->total_frees += atomic_load_explicit(&shard->frees, memory_order_relaxed);
+		stats->live_bytes += atomic_load_explicit(&shard->pending_bytes, memory_order_relaxed);
+		for(uint32_t i = 0; i < PLATFORM_TRACKING_SIZE_CLASSES; i++) {
+			uint64_t count = atomic_load_explicit(&shard->size_class_counts[i], memory_order_relaxed);
+			stats->size_class_counts[i] += count;
+			stats->total_allocations += count;
+		}
+		for(uint32_t i = 0; i < TAG_SLOTS; i++) {
+			tag_bytes[i] += atomic_load_explicit(&shard->tag_bytes[i], memory_order_relaxed);
+			tag_counts[i] += atomic_load_explicit(&shard->tag_counts[i], memory_order_relaxed);
+		}
+	}
+	stats->live_count = stats->total_allocations - stats->total_frees;
+	if(stats->live_bytes > stats->peak_bytes) stats->peak_bytes = stats->live_bytes;
+
+	for(uint32_t i = 1; i < TAG_SLOTS; i++) {
+		const char* tag = atomic_load_explicit(&t->tags[i], memory_order_acquire);
+		if(tag == NULL) break;
+		platform_tracking_tag_stats_t* tag_stats = &stats->tags[stats->tag_count++];
+		tag_stats->tag = tag;
+		tag_stats->live_bytes = tag_bytes[i];
+		tag_stats->live_count = tag_counts[i];
+	}
+}
+
+void platform_tracking_report_leaks(void) {
+	spin_lock(&trackers_lock);
+	for(platform_tracking_allocator_t* tracker = trackers; tracker != NULL; tracker = tracker->next) {
+		platform_allocation_stats_t stats;
+		platform_tracking_get_stats(tracker, &stats);
+		if(stats.live_count == 0) continue;
+
+		char buffer[256];
+		snprintf(buffer, sizeof(buffer), "Allocator \"%s\" leaked %llu bytes in %llu allocations (peak %llu bytes).\n",
+		         tracker->name != NULL ? tracker->name : "unnamed", (unsigned long long)stats.live_bytes,
+		         (unsigned long long)stats.live_count, (unsigned long long)stats.peak_bytes);
+		platform_terminal_print_error(buffer, PLATFORM_COLOR_YELLOW, 0, 0);
+		for(uint32_t i = 0; i < stats.tag_count; i++) {
+			if(stats.tags[i].live_count == 0) continue;
+			snprintf(buffer, sizeof(buffer), "    %s: %llu bytes in %llu allocations\n", stats.tags[i].tag,
+			         (unsigned long long)stats.tags[i].live_bytes, (unsigned long long)stats.tags[i].live_count);
+			platform_terminal_print_error(buffer, PLATFORM_COLOR_YELLOW, 0, 0);
+		}
+	}
+	spin_unlock(&trackers_lock);
+}
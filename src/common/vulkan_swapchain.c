@@ -0,0 +1,374 @@
+#ifndef PLATFORM_VULKAN
+#define PLATFORM_VULKAN
+#endif
+#include "platform/platform.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_SURFACE_FORMATS 64
+#define MAX_PRESENT_MODES   16
+#define NO_IMAGE            UINT32_MAX
+
+struct platform_swapchain_t {
+	platform_swapchain_create_info_t info;
+	VkSurfaceFormatKHR surface_format;
+	VkPresentModeKHR   present_mode;
+	VkSwapchainKHR     handle; // VK_NULL_HANDLE while the window has no area
+	VkExtent2D         extent;
+	// the window size the swapchain was made for, the size changing means it is out of date
+	uint32_t           window_width, window_height;
+	int8_t             out_of_date;
+
+	uint32_t    image_count;
+	VkImage     images[PLATFORM_SWAPCHAIN_MAX_IMAGES];
+	VkImageView image_views[PLATFORM_SWAPCHAIN_MAX_IMAGES];
+	// per image since a present may still wait on it when the frame comes around again
+	VkSemaphore render_finished[PLATFORM_SWAPCHAIN_MAX_IMAGES];
+	// fence of the frame that last drew to the image
+	VkFence     image_fences[PLATFORM_SWAPCHAIN_MAX_IMAGES];
+
+	uint32_t    frame;
+	VkSemaphore image_available[PLATFORM_SWAPCHAIN_MAX_FRAMES];
+	VkFence     fences[PLATFORM_SWAPCHAIN_MAX_FRAMES];
+	uint32_t    acquired_image; // NO_IMAGE between present and acquire
+
+	uint64_t                    acquired_at;
+	uint64_t                    last_present;
+	platform_swapchain_timing_t frame_timing; // of the frame being drawn
+	platform_swapchain_timing_t timing;
+};
+
+static inline void* swapchain_alloc(const uint64_t size, platform_allocation_callbacks_t* allocator) {
+	if(allocator != NULL) return allocator->alloc(allocator->user_data, size, sizeof(void*));
+	return malloc(size);
+}
+
+static inline void swapchain_free(void* addr, platform_allocation_callbacks_t* allocator) {
+	if(allocator != NULL) allocator->free(allocator->user_data, addr);
+	else free(addr);
+}
+
+static VkPresentModeKHR choose_present_mode(const VkPresentModeKHR* modes, const uint32_t count, const uint32_t latency) {
+	int8_t mailbox = 0, immediate = 0;
+	for(uint32_t i = 0; i < count; i++) {
+		if(modes[i] == VK_PRESENT_MODE_MAILBOX_KHR) mailbox = 1;
+		if(modes[i] == VK_PRESENT_MODE_IMMEDIATE_KHR) immediate = 1;
+	}
+	if(latency >= PLATFORM_LATENCY_LOWEST && immediate) return VK_PRESENT_MODE_IMMEDIATE_KHR;
+	if(latency >= PLATFORM_LATENCY_LOW && mailbox) return VK_PRESENT_MODE_MAILBOX_KHR;
+	return VK_PRESENT_MODE_FIFO_KHR;
+}
+
+static VkSurfaceFormatKHR choose_surface_format(const VkSurfaceFormatKHR* formats, const uint32_t count, const VkFormat wanted) {
+	VkFormat preferred = wanted != VK_FORMAT_UNDEFINED ? wanted : VK_FORMAT_B8G8R8A8_SRGB;
+	// a single undefined format means any format goes
+	if(count == 1 && formats[0].format == VK_FORMAT_UNDEFINED) {
+		VkSurfaceFormatKHR any = { preferred, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR };
+		return any;
+	}
+	for(uint32_t i = 0; i < count; i++) {
+		if(formats[i].format == preferred) return formats[i];
+	}
+	for(uint32_t i = 0; i < count; i++) {
+		if(formats[i].format == VK_FORMAT_B8G8R8A8_SRGB && formats[i].colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) return formats[i];
+	}
+	return formats[0];
+}
+
+static void destroy_images(platform_swapchain_t* swapchain) {
+	VkDevice device = swapchain->info.device;
+	for(uint32_t i = 0; i < swapchain->image_count; i++) {
+		vkDestroyImageView(device, swapchain->image_views[i], NULL);
+		vkDestroySemaphore(device, swapchain->render_finished[i], NULL);
+	}
+	swapchain->image_count = 0;
+}
+
+static int8_t create_images(platform_swapchain_t* swapchain) {
+	VkDevice device = swapchain->info.device;
+	// the driver may create more images than were asked for
+	uint32_t count = 0;
+	VkResult result = vkGetSwapchainImagesKHR(device, swapchain->handle, &count, NULL);
+	if(result != VK_SUCCESS) {
+		platform_log(PLATFORM_LOG_LEVEL_ERROR, "vkGetSwapchainImagesKHR failed: %d", result);
+		return 0;
+	}
+	if(count > PLATFORM_SWAPCHAIN_MAX_IMAGES) {
+		platform_log(PLATFORM_LOG_LEVEL_ERROR, "the swapchain has %u images, at most %u are supported", count, PLATFORM_SWAPCHAIN_MAX_IMAGES);
+		return 0;
+	}
+	result = vkGetSwapchainImagesKHR(device, swapchain->handle, &count, swapchain->images);
+	if(result != VK_SUCCESS) {
+		platform_log(PLATFORM_LOG_LEVEL_ERROR, "vkGetSwapchainImagesKHR failed: %d", result);
+		return 0;
+	}
+	for(uint32_t i = 0; i < count; i++) {
+		VkImageViewCreateInfo view_info = {0};
+		view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		view_info.image = swapchain->images[i];
+		view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		view_info.format = swapchain->surface_format.format;
+		view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		view_info.subresourceRange.levelCount = 1;
+		view_info.subresourceRange.layerCount = 1;
+		VkSemaphoreCreateInfo semaphore_info = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, NULL, 0 };
+		if(vkCreateImageView(device, &view_info, NULL, &swapchain->image_views[i]) != VK_SUCCESS) break;
+		if(vkCreateSemaphore(device, &semaphore_info, NULL, &swapchain->render_finished[i]) != VK_SUCCESS) {
+			vkDestroyImageView(device, swapchain->image_views[i], NULL);
+			break;
+		}
+		swapchain->image_fences[i] = VK_NULL_HANDLE;
+		swapchain->image_count++;
+	}
+	return swapchain->image_count == count;
+}
+
+// nothing may be in flight, the old swapchain is handed to the new one
+static int8_t create_swapchain(platform_swapchain_t* swapchain) {
+	const platform_swapchain_create_info_t* info = &swapchain->info;
+	VkSwapchainKHR old = swapchain->handle;
+	swapchain->handle = VK_NULL_HANDLE;
+	destroy_images(swapchain);
+
+	platform_get_window_size(info->window, &swapchain->window_width, &swapchain->window_height);
+	swapchain->out_of_date = 0;
+	VkSurfaceCapabilitiesKHR capabilities;
+	VkResult result = vkGetPhysicalDeviceSurfaceCapabilitiesKHR(info->physical_device, info->surface, &capabilities);
+	if(result != VK_SUCCESS) {
+		platform_log(PLATFORM_LOG_LEVEL_ERROR, "vkGetPhysicalDeviceSurfaceCapabilitiesKHR failed: %d", result);
+		if(old != VK_NULL_HANDLE) vkDestroySwapchainKHR(info->device, old, NULL);
+		return 0;
+	}
+	// the surface takes the swapchain's size when it has none of its own
+	VkExtent2D extent = capabilities.currentExtent;
+	if(extent.width == UINT32_MAX) {
+		extent.width = swapchain->window_width;
+		extent.height = swapchain->window_height;
+		if(extent.width < capabilities.minImageExtent.width) extent.width = capabilities.minImageExtent.width;
+		if(extent.height < capabilities.minImageExtent.height) extent.height = capabilities.minImageExtent.height;
+		if(extent.width > capabilities.maxImageExtent.width) extent.width = capabilities.maxImageExtent.width;
+		if(extent.height > capabilities.maxImageExtent.height) extent.height = capabilities.maxImageExtent.height;
+	}
+	swapchain->extent = extent;
+	if(extent.width == 0 || extent.height == 0) {
+		if(old != VK_NULL_HANDLE) vkDestroySwapchainKHR(info->device, old, NULL);
+		return 1;
+	}
+
+	// one more than the minimum so the app does not wait for the presentation engine to let go of one
+	uint32_t image_count = capabilities.minImageCount + 1;
+	if(capabilities.maxImageCount != 0 && image_count > capabilities.maxImageCount) image_count = capabilities.maxImageCount;
+	if(image_count > PLATFORM_SWAPCHAIN_MAX_IMAGES) image_count = PLATFORM_SWAPCHAIN_MAX_IMAGES;
+	if(image_count < capabilities.minImageCount || (capabilities.supportedUsageFlags & info->usage) != info->usage) {
+		platform_log(PLATFORM_LOG_LEVEL_ERROR, "the surface does not support the swapchain's image count or usage");
+		if(old != VK_NULL_HANDLE) vkDestroySwapchainKHR(info->device, old, NULL);
+		return 0;
+	}
+	VkCompositeAlphaFlagBitsKHR composite_alpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+	if((capabilities.supportedCompositeAlpha & composite_alpha) == 0) {
+		composite_alpha = capabilities.supportedCompositeAlpha & -capabilities.supportedCompositeAlpha;
+	}
+
+	VkSwapchainCreateInfoKHR create_info = {0};
+	create_info.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+	create_info.surface = info->surface;
+	create_info.minImageCount = image_count;
+	create_info.imageFormat = swapchain->surface_format.format;
+	create_info.imageColorSpace = swapchain->surface_format.colorSpace;
+	create_info.imageExtent = extent;
+	create_info.imageArrayLayers = 1;
+	create_info.imageUsage = info->usage;
+	create_info.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	create_info.preTransform = capabilities.currentTransform;
+	create_info.compositeAlpha = composite_alpha;
+	create_info.presentMode = swapchain->present_mode;
+	create_info.clipped = VK_TRUE;
+	create_info.oldSwapchain = old;
+	result = vkCreateSwapchainKHR(info->device, &create_info, NULL, &swapchain->handle);
+	if(old != VK_NULL_HANDLE) vkDestroySwapchainKHR(info->device, old, NULL);
+	if(result != VK_SUCCESS) {
+		platform_log(PLATFORM_LOG_LEVEL_ERROR, "vkCreateSwapchainKHR failed: %d", result);
+		swapchain->handle = VK_NULL_HANDLE;
+		return 0;
+	}
+	if(!create_images(swapchain)) {
+		platform_log(PLATFORM_LOG_LEVEL_ERROR, "could not set up the swapchain images");
+		destroy_images(swapchain);
+		vkDestroySwapchainKHR(info->device, swapchain->handle, NULL);
+		swapchain->handle = VK_NULL_HANDLE;
+		return 0;
+	}
+	return 1;
+}
+
+// resizes are rare enough to simply wait for everything in flight
+static int8_t recreate_swapchain(platform_swapchain_t* swapchain) {
+	vkDeviceWaitIdle(swapchain->info.device);
+	return create_swapchain(swapchain);
+}
+
+static void destroy_sync_objects(platform_swapchain_t* swapchain) {
+	for(uint32_t i = 0; i < PLATFORM_SWAPCHAIN_MAX_FRAMES; i++) {
+		if(swapchain->image_available[i] != VK_NULL_HANDLE) vkDestroySemaphore(swapchain->info.device, swapchain->image_available[i], NULL);
+		if(swapchain->fences[i] != VK_NULL_HANDLE) vkDestroyFence(swapchain->info.device, swapchain->fences[i], NULL);
+	}
+}
+
+platform_swapchain_t* platform_swapchain_create(const platform_swapchain_create_info_t* create_info, platform_allocation_callbacks_t* allocator) {
+	platform_swapchain_t* swapchain = swapchain_alloc(sizeof(platform_swapchain_t), allocator);
+	if(swapchain == NULL) return NULL;
+	memset(swapchain, 0, sizeof(platform_swapchain_t));
+	swapchain->info = *create_info;
+	if(swapchain->info.usage == 0) swapchain->info.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+	if(swapchain->info.frames_in_flight == 0) swapchain->info.frames_in_flight = 2;
+	if(swapchain->info.frames_in_flight > PLATFORM_SWAPCHAIN_MAX_FRAMES) swapchain->info.frames_in_flight = PLATFORM_SWAPCHAIN_MAX_FRAMES;
+	swapchain->acquired_image = NO_IMAGE;
+
+	// neither changes with the surface's size, so they are only picked once
+	VkSurfaceFormatKHR formats[MAX_SURFACE_FORMATS];
+	uint32_t format_count = MAX_SURFACE_FORMATS;
+	VkResult result = vkGetPhysicalDeviceSurfaceFormatsKHR(create_info->physical_device, create_info->surface, &format_count, formats);
+	VkPresentModeKHR modes[MAX_PRESENT_MODES];
+	uint32_t mode_count = MAX_PRESENT_MODES;
+	if(result == VK_SUCCESS || result == VK_INCOMPLETE) {
+		result = vkGetPhysicalDeviceSurfacePresentModesKHR(create_info->physical_device, create_info->surface, &mode_count, modes);
+	}
+	if((result != VK_SUCCESS && result != VK_INCOMPLETE) || format_count == 0) {
+		platform_log(PLATFORM_LOG_LEVEL_ERROR, "could not query the surface: %d", result);
+		swapchain_free(swapchain, allocator);
+		return NULL;
+	}
+	swapchain->surface_format = choose_surface_format(formats, format_count, create_info->format);
+	swapchain->present_mode = choose_present_mode(modes, mode_count, create_info->latency);
+
+	VkSemaphoreCreateInfo semaphore_info = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, NULL, 0 };
+	// signaled so the first wait on every frame returns at once
+	VkFenceCreateInfo fence_info = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO, NULL, VK_FENCE_CREATE_SIGNALED_BIT };
+	for(uint32_t i = 0; i < swapchain->info.frames_in_flight; i++) {
+		if(vkCreateSemaphore(create_info->device, &semaphore_info, NULL, &swapchain->image_available[i]) != VK_SUCCESS ||
+		   vkCreateFence(create_info->device, &fence_info, NULL, &swapchain->fences[i]) != VK_SUCCESS) {
+			destroy_sync_objects(swapchain);
+			swapchain_free(swapchain, allocator);
+			return NULL;
+		}
+	}
+	if(!create_swapchain(swapchain)) {
+		destroy_sync_objects(swapchain);
+		swapchain_free(swapchain, allocator);
+		return NULL;
+	}
+	return swapchain;
+}
+
+void platform_swapchain_destroy(platform_swapchain_t* swapchain, platform_allocation_callbacks_t* allocator) {
+	vkDeviceWaitIdle(swapchain->info.device);
+	destroy_images(swapchain);
+	if(swapchain->handle != VK_NULL_HANDLE) vkDestroySwapchainKHR(swapchain->info.device, swapchain->handle, NULL);
+	destroy_sync_objects(swapchain);
+	swapchain_free(swapchain, allocator);
+}
+
+int8_t platform_swapchain_acquire(platform_swapchain_t* swapchain, platform_swapchain_frame_t* frame) {
+	VkDevice device = swapchain->info.device;
+	// the acquired frame has to be presented first
+	if(swapchain->acquired_image != NO_IMAGE) return 0;
+	uint64_t start = platform_get_timestamp();
+	VkFence fence = swapchain->fences[swapchain->frame];
+	vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+	swapchain->frame_timing.fence_wait_ns = platform_get_timestamp() - start;
+
+	uint32_t width, height;
+	platform_get_window_size(swapchain->info.window, &width, &height);
+	if(swapchain->out_of_date || width != swapchain->window_width || height != swapchain->window_height) {
+		if(!recreate_swapchain(swapchain)) return 0;
+	}
+	uint32_t image = NO_IMAGE;
+	VkResult result = VK_ERROR_OUT_OF_DATE_KHR;
+	uint64_t acquire_start = platform_get_timestamp();
+	// the window may have changed again since the events were handled, then it is worth a second try
+	for(uint32_t attempt = 0; attempt < 2 && result == VK_ERROR_OUT_OF_DATE_KHR; attempt++) {
+		if(attempt != 0 && !recreate_swapchain(swapchain)) return 0;
+		if(swapchain->handle == VK_NULL_HANDLE) return 0;
+		acquire_start = platform_get_timestamp();
+		result = vkAcquireNextImageKHR(device, swapchain->handle, UINT64_MAX, swapchain->image_available[swapchain->frame], VK_NULL_HANDLE, &image);
+	}
+	uint64_t acquired_at = platform_get_timestamp();
+	if(result == VK_SUBOPTIMAL_KHR) {
+		// still presentable, recreated before the next frame
+		swapchain->out_of_date = 1;
+	}
+	else if(result != VK_SUCCESS) {
+		if(result == VK_ERROR_OUT_OF_DATE_KHR) swapchain->out_of_date = 1;
+		else platform_log(PLATFORM_LOG_LEVEL_ERROR, "vkAcquireNextImageKHR failed: %d", result);
+		return 0;
+	}
+	swapchain->frame_timing.acquire_ns = acquired_at - acquire_start;
+
+	// with more frames in flight than images an earlier frame may still draw to it
+	VkFence image_fence = swapchain->image_fences[image];
+	if(image_fence != VK_NULL_HANDLE && image_fence != fence) {
+		vkWaitForFences(device, 1, &image_fence, VK_TRUE, UINT64_MAX);
+		swapchain->frame_timing.fence_wait_ns += platform_get_timestamp() - acquired_at;
+	}
+	swapchain->image_fences[image] = fence;
+	// only now that a submit is sure to follow, otherwise the next wait would never return
+	vkResetFences(device, 1, &fence);
+
+	swapchain->acquired_image = image;
+	swapchain->acquired_at = platform_get_timestamp();
+	frame->frame_index = swapchain->frame;
+	frame->image_index = image;
+	frame->image = swapchain->images[image];
+	frame->image_view = swapchain->image_views[image];
+	frame->extent = swapchain->extent;
+	frame->format = swapchain->surface_format.format;
+	frame->image_available = swapchain->image_available[swapchain->frame];
+	frame->render_finished = swapchain->render_finished[image];
+	frame->fence = fence;
+	return 1;
+}
+
+int8_t platform_swapchain_present(platform_swapchain_t* swapchain) {
+	uint32_t image = swapchain->acquired_image;
+	if(image == NO_IMAGE) return 0;
+	uint64_t start = platform_get_timestamp();
+	VkPresentInfoKHR present_info = {0};
+	present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+	present_info.waitSemaphoreCount = 1;
+	present_info.pWaitSemaphores = &swapchain->render_finished[image];
+	present_info.swapchainCount = 1;
+	present_info.pSwapchains = &swapchain->handle;
+	present_info.pImageIndices = &image;
+	VkResult result = vkQueuePresentKHR(swapchain->info.present_queue, &present_info);
+	uint64_t end = platform_get_timestamp();
+
+	swapchain->frame_timing.cpu_ns = start - swapchain->acquired_at;
+	swapchain->frame_timing.present_ns = end - start;
+	swapchain->frame_timing.frame_ns = swapchain->last_present != 0 ? end - swapchain->last_present : 0;
+	swapchain->last_present = end;
+	swapchain->timing = swapchain->frame_timing;
+	swapchain->acquired_image = NO_IMAGE;
+	swapchain->frame = (swapchain->frame + 1) % swapchain->info.frames_in_flight;
+
+	if(result == VK_SUBOPTIMAL_KHR || result == VK_ERROR_OUT_OF_DATE_KHR) {
+		swapchain->out_of_date = 1;
+		return 0;
+	}
+	if(result != VK_SUCCESS) {
+		platform_log(PLATFORM_LOG_LEVEL_ERROR, "vkQueuePresentKHR failed: %d", result);
+		return 0;
+	}
+	return 1;
+}
+
+void platform_swapchain_invalidate(platform_swapchain_t* swapchain) {
+	swapchain->out_of_date = 1;
+}
+
+VkPresentModeKHR platform_swapchain_present_mode(const platform_swapchain_t* swapchain) {
+	return swapchain->present_mode;
+}
+
+void platform_swapchain_get_timing(const platform_swapchain_t* swapchain, platform_swapchain_timing_t* timing) {
+	*timing = swapchain->timing;
+}
@@ -0,0 +1,292 @@
+#define _GNU_SOURCE
+#include "headless_window.h"
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+typedef struct {
+	int32_t   x, y;
+	uint32_t  width, height;
+	int8_t    mapped;
+	int8_t    focused;
+	int8_t    should_close;
+	uint32_t  active_flags;
+	char*     name;
+	uint32_t* pixels;
+} headless_window_t;
+
+static inline headless_window_t* headless_window(const platform_window_t* window) {
+	return (headless_window_t*)window;
+}
+
+void headless_init_context(headless_context_t* context) {
+	event_ring_init(&context->injected);
+	context->focused_window = NULL;
+}
+
+// the old contents are gone after a resize, like a real window's until it is exposed
+static int8_t resize_pixels(headless_window_t* window, const uint32_t width, const uint32_t height) {
+	uint64_t size = ((uint64_t)width * height * sizeof(uint32_t) + 63) & ~(uint64_t)63;
+	uint32_t* pixels = size != 0 ? platform_allocator_alloc(size, 64, NULL) : NULL;
+	if(size != 0 && pixels == NULL) return 0;
+	if(pixels != NULL) memset(pixels, 0, size);
+	if(window->pixels != NULL) platform_allocator_free(window->pixels, NULL);
+	window->pixels = pixels;
+	window->width = width;
+	window->height = height;
+	return 1;
+}
+
+static inline void push_expose(platform_window_t* window, const uint64_t timestamp) {
+	platform_event_t event = {0};
+	event.type = PLATFORM_EVENT_EXPOSE;
+	event.window = window;
+	event.timestamp = timestamp;
+	event.expose.width = headless_window(window)->width;
+	event.expose.height = headless_window(window)->height;
+	event_queue_push(&linux_platform_context.events, &event);
+}
+
+// does what the window system would have done before sending the event and queues it,
+// events that change nothing are dropped like a window system would not send them
+static void apply_event(headless_context_t* context, const platform_event_t* event) {
+	event_queue_t* queue = &linux_platform_context.events;
+	headless_window_t* window = headless_window(event->window);
+	switch(event->type) {
+	case PLATFORM_EVENT_CLOSE:
+		window->should_close = 1;
+		break;
+	case PLATFORM_EVENT_RESIZE:
+		if(event->resize.width == window->width && event->resize.height == window->height) return;
+		if(!resize_pixels(window, event->resize.width, event->resize.height)) return;
+		event_queue_push(queue, event);
+		push_expose(event->window, event->timestamp);
+		return;
+	case PLATFORM_EVENT_MOVE:
+		if(event->move.x == window->x && event->move.y == window->y) return;
+		window->x = event->move.x;
+		window->y = event->move.y;
+		break;
+	case PLATFORM_EVENT_MAP:
+		if(window->mapped) return;
+		window->mapped = 1;
+		event_queue_push(queue, event);
+		push_expose(event->window, event->timestamp);
+		return;
+	case PLATFORM_EVENT_UNMAP:
+		if(!window->mapped) return;
+		window->mapped = 0;
+		break;
+	case PLATFORM_EVENT_FOCUS_IN:
+		if(window->focused) return;
+		// only one window has the focus
+		if(context->focused_window != NULL) {
+			platform_event_t focus_out = *event;
+			focus_out.type = PLATFORM_EVENT_FOCUS_OUT;
+			focus_out.window = context->focused_window;
+			apply_event(context, &focus_out);
+		}
+		window->focused = 1;
+		context->focused_window = event->window;
+		break;
+	case PLATFORM_EVENT_FOCUS_OUT:
+		if(!window->focused) return;
+		window->focused = 0;
+		if(context->focused_window == event->window) context->focused_window = NULL;
+		break;
+	}
+	event_queue_push(queue, event);
+}
+
+// requests made by the app take effect at once, the events go out with the next poll
+static inline void apply_request(platform_window_t* window, platform_event_t* event) {
+	event->window = window;
+	event->timestamp = platform_get_timestamp();
+	apply_event(&linux_platform_context.headless, event);
+}
+
+platform_window_t* headless_create_window(const platform_window_create_info_t create_info, platform_allocation_callbacks_t* allocator) {
+	headless_window_t* window = platform_allocator_alloc(sizeof(headless_window_t), sizeof(void*), allocator);
+	if(window == NULL) return NULL;
+	window->x = create_info.x;
+	window->y = create_info.y;
+	window->mapped = 0;
+	window->focused = 0;
+	window->should_close = 0;
+	window->active_flags = create_info.flags;
+	window->name = NULL;
+	window->pixels = NULL;
+	if(!resize_pixels(window, create_info.width, create_info.height)) {
+		platform_allocator_free(window, allocator);
+		return NULL;
+	}
+	headless_set_window_name((platform_window_t*)window, create_info.name);
+	if((create_info.flags & PLATFORM_WF_UNMAPPED) == 0) headless_map_window((platform_window_t*)window);
+	return (platform_window_t*)window;
+}
+void headless_destroy_window(platform_window_t* platform_window, platform_allocation_callbacks_t* allocator) {
+	headless_context_t* context = &linux_platform_context.headless;
+	headless_window_t* window = headless_window(platform_window);
+	event_queue_remove_window(&linux_platform_context.events, platform_window);
+	event_ring_remove_window(&context->injected, platform_window);
+	if(context->focused_window == platform_window) context->focused_window = NULL;
+	if(window->name != NULL) platform_allocator_free(window->name, NULL);
+	if(window->pixels != NULL) platform_allocator_free(window->pixels, NULL);
+	platform_allocator_free(window, allocator);
+}
+void headless_get_window_position(const platform_window_t* window, int32_t* x, int32_t* y) {
+	if(x) *x = headless_window(window)->x;
+	if(y) *y = headless_window(window)->y;
+}
+void headless_get_window_size(const platform_window_t* window, uint32_t* width, uint32_t* height) {
+	if(width) *width = headless_window(window)->width;
+	if(height) *height = headless_window(window)->height;
+}
+// the cached state is all there is
+void headless_refresh_window_state(platform_window_t* window) {
+}
+void headless_set_window_position(platform_window_t* window, const int32_t x, const int32_t y) {
+	platform_event_t event = {0};
+	event.type = PLATFORM_EVENT_MOVE;
+	event.move.x = x;
+	event.move.y = y;
+	apply_request(window, &event);
+}
+void headless_set_window_size(platform_window_t* window, const uint32_t width, const uint32_t height) {
+	platform_event_t event = {0};
+	event.type = PLATFORM_EVENT_RESIZE;
+	event.resize.width = width;
+	event.resize.height = height;
+	apply_request(window, &event);
+}
+void headless_get_window_name(const platform_window_t* window, char* name, uint32_t max_len) {
+	if(max_len == 0) return;
+	const char* current = headless_window(window)->name;
+	uint32_t len = 0;
+	if(current != NULL) {
+		while(current[len] != '\0' && len < max_len - 1) len++;
+		memcpy(name, current, len);
+	}
+	name[len] = '\0';
+}
+void headless_set_window_name(platform_window_t* platform_window, const char* name) {
+	headless_window_t* window = headless_window(platform_window);
+	if(window->name != NULL) platform_allocator_free(window->name, NULL);
+	window->name = NULL;
+	if(name == NULL) return;
+	uint32_t len = 0;
+	while(name[len] != '\0') len++;
+	window->name = platform_allocator_alloc(len + 1, 1, NULL);
+	if(window->name != NULL) memcpy(window->name, name, len + 1);
+}
+
+void headless_map_window(platform_window_t* window) {
+	platform_event_t event = {0};
+	event.type = PLATFORM_EVENT_MAP;
+	apply_request(window, &event);
+}
+void headless_unmap_window(platform_window_t* window) {
+	platform_event_t event = {0};
+	event.type = PLATFORM_EVENT_UNMAP;
+	apply_request(window, &event);
+}
+
+int8_t headless_window_is_mapped(const platform_window_t* window) {
+	return headless_window(window)->mapped;
+}
+int8_t headless_window_has_focus(const platform_window_t* window) {
+	return headless_window(window)->focused;
+}
+int8_t headless_window_should_close(const platform_window_t* window) {
+	return headless_window(window)->should_close;
+}
+
+int8_t headless_window_get_framebuffer(platform_window_t* platform_window, platform_framebuffer_t* framebuffer) {
+	headless_window_t* window = headless_window(platform_window);
+	if(window->pixels == NULL) return 0;
+	framebuffer->pixels = window->pixels;
+	framebuffer->width = window->width;
+	framebuffer->height = window->height;
+	framebuffer->stride = window->width;
+	return 1;
+}
+void headless_window_present(platform_window_t* window, const platform_rect_t* damage, const uint32_t damage_count) {
+}
+
+// nothing is displayed anywhere
+uint32_t headless_get_monitors(platform_monitor_t* monitors, const uint32_t max_count) {
+	return 0;
+}
+
+char** headless_vulkan_required_extensions(uint32_t* extension_count) {
+	*extension_count = 2;
+	static char* extensions[] = {
+		"VK_KHR_surface",
+		"VK_EXT_headless_surface"
+	};
+	return extensions;
+}
+
+VkSurfaceKHR headless_vulkan_create_surface(platform_window_t* window, VkInstance instance) {
+	VkSurfaceKHR surface;
+	VkHeadlessSurfaceCreateInfoEXT create_info = {
+		VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT,
+		NULL,
+		0
+	};
+	VkResult surface_result = vkCreateHeadlessSurfaceEXT(instance, &create_info, NULL, &surface);
+	if(surface_result != VK_SUCCESS) return NULL;
+	return surface;
+}
+
+// the setters change the window state right away
+void headless_flush(void) {
+}
+void headless_handle_events(void) {
+	headless_context_t* context = &linux_platform_context.headless;
+	// bounded so a fast injecting thread can not keep the app in here
+	platform_event_t event;
+	for(uint32_t i = 0; i < EVENT_RING_CAPACITY && event_ring_pop(&context->injected, &event); i++) {
+		apply_event(context, &event);
+	}
+}
+int8_t headless_wait_events(const uint64_t timeout_ns) {
+	headless_context_t* context = &linux_platform_context.headless;
+	int8_t result = 1;
+	atomic_store(&linux_platform_context.app_waiting, 1);
+	// pairs with headless_inject_event checking app_waiting after it pushed
+	atomic_thread_fence(memory_order_seq_cst);
+	if(event_ring_empty(&context->injected)) {
+		struct pollfd fd = { .fd = linux_platform_context.wake_fd, .events = POLLIN };
+		struct timespec timeout;
+		timeout.tv_sec = timeout_ns / 1000000000;
+		timeout.tv_nsec = timeout_ns % 1000000000;
+		result = ppoll(&fd, 1, timeout_ns == PLATFORM_WAIT_INFINITE ? NULL : &timeout, NULL) > 0;
+	}
+	atomic_store(&linux_platform_context.app_waiting, 0);
+	uint64_t count;
+	while(read(linux_platform_context.wake_fd, &count, sizeof(count)) > 0);
+	headless_handle_events();
+	return result;
+}
+
+int8_t headless_inject_event(const platform_event_t* event) {
+	if(event->window == NULL || event->type == PLATFORM_EVENT_NONE) return 0;
+	platform_event_t injected = *event;
+	if(injected.timestamp == 0) injected.timestamp = platform_get_timestamp();
+	if(!event_ring_push(&linux_platform_context.headless.injected, &injected)) return 0;
+	atomic_thread_fence(memory_order_seq_cst);
+	if(atomic_load_explicit(&linux_platform_context.app_waiting, memory_order_relaxed)) {
+		uint64_t one = 1;
+		write(linux_platform_context.wake_fd, &one, sizeof(one));
+	}
+	return 1;
+}
+
+uint32_t* headless_window_pixels(platform_window_t* platform_window, uint32_t* width, uint32_t* height) {
+	headless_window_t* window = headless_window(platform_window);
+	if(width) *width = window->width;
+	if(height) *height = window->height;
+	return window->pixels;
+}
@@ -0,0 +1,65 @@
+#ifndef HEADLESS_WINDOW_H
+#define HEADLESS_WINDOW_H
+
+#include "linux_internal.h"
+
+#define HEADLESS_WINDOW_FUNCTIONS (linux_window_functions_t) { \
+	.create_window = headless_create_window, \
+	.destroy_window = headless_destroy_window, \
+	.get_window_position = headless_get_window_position, \
+	.get_window_size = headless_get_window_size, \
+	.refresh_window_state = headless_refresh_window_state, \
+	.set_window_position = headless_set_window_position, \
+	.set_window_size = headless_set_window_size, \
+	.get_window_name = headless_get_window_name, \
+	.set_window_name = headless_set_window_name, \
+	.map_window = headless_map_window, \
+	.unmap_window = headless_unmap_window, \
+	.window_is_mapped = headless_window_is_mapped, \
+	.window_has_focus = headless_window_has_focus, \
+	.window_should_close = headless_window_should_close, \
+	.get_framebuffer = headless_window_get_framebuffer, \
+	.present = headless_window_present, \
+	.get_monitors = headless_get_monitors, \
+	.vulkan_required_extensions = headless_vulkan_required_extensions, \
+	.vulkan_create_surface = headless_vulkan_create_surface, \
+	.flush = headless_flush, \
+	.handle_events = headless_handle_events, \
+	.wait_events = headless_wait_events, \
+	.start_event_thread = NULL, \
+	.stop_event_thread = NULL, \
+	.publish_backlog = NULL \
+}
+
+void headless_init_context(headless_context_t* context);
+
+platform_window_t* headless_create_window(const platform_window_create_info_t create_info, platform_allocation_callbacks_t* allocator);
+void headless_destroy_window(platform_window_t* window, platform_allocation_callbacks_t* allocator);
+void headless_get_window_position(const platform_window_t* window, int32_t* x, int32_t* y);
+void headless_get_window_size(const platform_window_t* window, uint32_t* width, uint32_t* height);
+void headless_refresh_window_state(platform_window_t* window);
+void headless_set_window_position(platform_window_t* window, const int32_t x, const int32_t y);
+void headless_set_window_size(platform_window_t* window, const uint32_t width, const uint32_t height);
+void headless_get_window_name(const platform_window_t* window, char* name, uint32_t max_len);
+void headless_set_window_name(platform_window_t* window, const char* name);
+void headless_map_window(platform_window_t* window);
+void headless_unmap_window(platform_window_t* window);
+int8_t headless_window_is_mapped(const platform_window_t* window);
+int8_t headless_window_has_focus(const platform_window_t* window);
+int8_t headless_window_should_close(const platform_window_t* window);
+// the framebuffer is the window's pixels, presenting it does nothing
+int8_t headless_window_get_framebuffer(platform_window_t* window, platform_framebuffer_t* framebuffer);
+void headless_window_present(platform_window_t* window, const platform_rect_t* damage, const uint32_t damage_count);
+uint32_t headless_get_monitors(platform_monitor_t* monitors, const uint32_t max_count);
+// VK_EXT_headless_surface, images are presented nowhere
+char** headless_vulkan_required_extensions(uint32_t* extension_count);
+VkSurfaceKHR headless_vulkan_create_surface(platform_window_t* window, VkInstance instance);
+
+void headless_flush(void);
+void headless_handle_events(void);
+int8_t headless_wait_events(const uint64_t timeout_ns);
+
+int8_t headless_inject_event(const platform_event_t* event);
+uint32_t* headless_window_pixels(platform_window_t* window, uint32_t* width, uint32_t* height);
+
+#endif // HEADLESS_WINDOW_H
@@ -2,24 +2,43 @@
 #define LINUX_INTERNAL_H
 
 #include "platform/platform.h"
+#include "common/event_queue.h"
+#include "common/event_ring.h"
+#include "x11_common.h"
 #include <X11/Xlib.h>
+#include <xcb/xcb.h>
 #include <vulkan/vulkan.h>
+#include <threads.h>
 
 typedef struct {
 	platform_window_t* (*create_window)(const platform_window_create_info_t create_info, platform_allocation_callbacks_t* allocator);
 	void (*destroy_window)(platform_window_t* window, platform_allocation_callbacks_t* allocator);
 	void (*get_window_position)(const platform_window_t* window, int32_t* x, int32_t* y);
 	void (*get_window_size)(const platform_window_t* window, uint32_t* width, uint32_t* height);
+	void (*refresh_window_state)(platform_window_t* window);
 	void (*set_window_position)(platform_window_t* window, const int32_t x, const int32_t y);
 	void (*set_window_size)(platform_window_t* window, const uint32_t width, const uint32_t height);
 	void (*get_window_name)(const platform_window_t* window, char* name, uint32_t max_len);
 	void (*set_window_name)(platform_window_t* window, const char* name);
 	void (*map_window)(platform_window_t* window);
 	void (*unmap_window)(platform_window_t* window);
+	int8_t (*window_is_mapped)(const platform_window_t* window);
+	int8_t (*window_has_focus)(const platform_window_t* window);
 	int8_t (*window_should_close)(const platform_window_t* window);
+	int8_t (*get_framebuffer)(platform_window_t* window, platform_framebuffer_t* framebuffer);
+	void (*present)(platform_window_t* window, const platform_rect_t* damage, const uint32_t damage_count);
+	uint32_t (*get_monitors)(platform_monitor_t* monitors, const uint32_t max_count);
 	char** (*vulkan_required_extensions)(uint32_t* extension_count);
 	VkSurfaceKHR (*vulkan_create_surface)(platform_window_t* window, VkInstance instance);
+	// sends the window changes recorded by the setters
+	void (*flush)(void);
 	void (*handle_events)(void);
+	int8_t (*wait_events)(const uint64_t timeout_ns);
+	// the thread pushes into linux_context_t.ring and writes wake_fd when the app waits
+	int8_t (*start_event_thread)(void);
+	void (*stop_event_thread)(void);
+	// calls linux_publish_events from the app thread, holding the lock the event thread publishes with
+	void (*publish_backlog)(void);
 } linux_window_functions_t;
 
 typedef struct {
@@ -42,19 +61,137 @@ typedef struct {
 	Atom net_wm_allowed_actions;
 	Atom net_wm_action_resize;
 
-	uint64_t supported_atom_count;
-	Atom* supported_atoms;
+	// 0 when the server has no XInput2, raw motion is disabled then
+	int                xi_opcode;
+	// bit per keycode, tells auto repeat apart from new presses
+	uint8_t            keys_down[32];
+	// raw motion has no window of its own
+	platform_window_t* focused_window;
+	x11_server_time_t  server_time;
+
+	x11_window_map_t   windows;
+
+	// MIT-SHM for framebuffers, cleared once attaching a segment failed
+	// since the server is then not on this machine
+	int8_t shm_available;
+	int    shm_completion_event;
+
+	// RandR, the monitors are queried once and again after the server reports
+	// a change, randr_event_base is -1 when the server has no RandR 1.2
+	int                randr_event_base;
+	int8_t             randr_current; // 1.3, queries without probing the outputs
+	int8_t             monitors_dirty;
+	uint32_t           monitor_count;
+	platform_monitor_t monitors[PLATFORM_MAX_MONITORS];
+
+	// windows with changes waiting for the next handle_events or flush
+	platform_window_t* pending_windows;
+	// reparented windows to look up in root coordinates after the batch of
+	// events, only touched by whoever handles events
+	x11_position_queries_t position_queries;
+
+	// PLATFORM_SF_EVENT_THREAD, the display is opened after XInitThreads and the
+	// thread holds XLockDisplay while it handles events, app side code that reads
+	// state the thread writes takes the same lock
+	thrd_t     event_thread;
+	atomic_int event_thread_stopping;
+	Window     event_thread_window; // receives the message that stops the thread
+	// signalled when the thread takes a window's ShmCompletion, guards present_pending
+	mtx_t      present_lock;
+	cnd_t      present_done;
+
+	x11_atom_set_t supported_atoms;
 } xlib_context_t;
 
+typedef struct {
+	xcb_connection_t* connection;
+	xcb_screen_t*     screen;
+
+	xcb_atom_t wm_protocols;
+	xcb_atom_t wm_delete_window;
+
+	xcb_atom_t motif_wm_hints;
+	xcb_atom_t net_wm_name;
+	xcb_atom_t net_wm_icon_name;
+	xcb_atom_t utf8_string;
+	xcb_atom_t net_supported;
+	xcb_atom_t net_wm_window_type;
+	xcb_atom_t net_wm_window_type_splash;
+	xcb_atom_t net_wm_window_type_dialog;
+	xcb_atom_t net_wm_window_type_menu;
+
+	xcb_atom_t net_wm_allowed_actions;
+	xcb_atom_t net_wm_action_resize;
+
+	// the keyboard mapping, keysyms_per_keycode entries for every keycode from min_keycode on
+	xcb_keysym_t*      keysyms;
+	uint32_t           keysym_count;
+	uint8_t            min_keycode;
+	uint8_t            keysyms_per_keycode;
+	// bit per keycode, tells auto repeat apart from new presses
+	uint8_t            keys_down[32];
+	platform_window_t* focused_window;
+	x11_server_time_t  server_time;
+	// an event read ahead while looking for the press of an auto repeat
+	xcb_generic_event_t* lookahead;
+
+	x11_window_map_t   windows;
+	x11_atom_set_t     supported_atoms;
+
+	// framebuffers are sent with put_image in pieces that fit a request,
+	// cut out of the framebuffer into scratch unless they span whole rows
+	int8_t         framebuffer_supported;
+	xcb_gcontext_t gc; // created by the first present
+	uint32_t*      scratch;
+
+	// windows with changes waiting for the next handle_events or flush
+	platform_window_t* pending_windows;
+	// reparented windows to look up in root coordinates after the batch of
+	// events, only touched by whoever handles events
+	x11_position_queries_t position_queries;
+
+	// xcb is thread safe by itself, lock guards the window map and the cached
+	// window state between the event thread and the app
+	mtx_t        lock;
+	thrd_t       event_thread;
+	atomic_int   event_thread_stopping;
+	xcb_window_t event_thread_window;
+} xcb_backend_context_t;
+
+typedef struct {
+	// filled by platform_headless_inject_event, handle_events applies
+	// the events to the window state before queueing them
+	event_ring_t       injected;
+	platform_window_t* focused_window;
+} headless_context_t;
+
 typedef struct linux_context_t {
 	union {
-		xlib_context_t xlib;
+		xlib_context_t        xlib;
+		xcb_backend_context_t xcb;
+		headless_context_t    headless;
 	};
+	uint32_t backend; // PLATFORM_BACKEND_*
 	linux_window_functions_t window_functions;
+	// eventfd written by platform_wake to interrupt wait_events
+	int wake_fd;
+	event_queue_t events;
+	// with PLATFORM_SF_EVENT_THREAD events are handed to the app through the ring,
+	// events is then only used by the event thread
+	int8_t       event_thread;
+	// set while the app blocks on wake_fd for events from another thread
+	atomic_int   app_waiting;
+	event_ring_t ring;
+	// set when events did not fit into the ring. the app moves them over once it
+	// emptied the ring instead of leaving them until the next X event arrives
+	atomic_int   backlog;
 } linux_context_t;
 extern linux_context_t linux_platform_context;
 
 void* platform_allocator_alloc(uint64_t size, uint64_t alignment, platform_allocation_callbacks_t* allocator);
 void platform_allocator_free(void* addr, platform_allocation_callbacks_t* alloctor);
+// called by the event thread after handling a batch, moves the queued events into the ring.
+// the caller holds the event thread's lock, which keeps the ring at a single producer
+void linux_publish_events(void);
 
 #endif // LINUX_INTERNAL_H
\ No newline at end of file
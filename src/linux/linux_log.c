@@ -0,0 +1,365 @@
+#include "linux_terminal.h"
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+// a deferred record is the format pointer and the level followed by the arguments
+// packed one after another. integers are widened to 64 bits, strings are copied
+// with a length in front and a terminator behind them
+#define LOG_RECORD_SIZE   1024
+#define LOG_MAX_SPEC_SIZE 24
+
+#define PREFIX(str) { str, sizeof(str) - 1 }
+static const struct {
+	const char* text;
+	uint32_t    length;
+} level_prefixes[] = {
+	PREFIX("\033[90m[TRACE]\033[0m "),
+	PREFIX("\033[36m[DEBUG]\033[0m "),
+	PREFIX("\033[32m[INFO]\033[0m "),
+	PREFIX("\033[33m[WARN]\033[0m "),
+	PREFIX("\033[31m[ERROR]\033[0m "),
+};
+#undef PREFIX
+
+#define LEVEL_COUNT (sizeof(level_prefixes) / sizeof(level_prefixes[0]))
+
+static inline uint8_t clamp_level(const uint8_t level) {
+	return level < LEVEL_COUNT ? level : LEVEL_COUNT - 1;
+}
+
+static inline int level_fd(const uint8_t level) {
+	return level >= PLATFORM_LOG_LEVEL_WARN ? STDERR_FILENO : STDOUT_FILENO;
+}
+
+// the message gets the rest of the buffer, if it does not fit there it is
+// formatted again into an empty buffer and cut off at its size
+static void append_formatted(terminal_buffer_t* buffer, const char* fmt, va_list args) {
+	uint32_t space = TERMINAL_BUFFER_SIZE - buffer->length;
+	va_list copy;
+	va_copy(copy, args);
+	int len = vsnprintf(buffer->data + buffer->length, space, fmt, copy);
+	va_end(copy);
+	if(len < 0) return;
+	if((uint32_t)len < space) {
+		buffer->length += len;
+		return;
+	}
+	terminal_buffer_flush(buffer);
+	len = vsnprintf(buffer->data, TERMINAL_BUFFER_SIZE, fmt, args);
+	if(len < 0) return;
+	buffer->length = (uint32_t)len < TERMINAL_BUFFER_SIZE ? (uint32_t)len : TERMINAL_BUFFER_SIZE - 1;
+}
+
+static void log_write(uint8_t level, const char* fmt, va_list args) {
+	level = clamp_level(level);
+	int8_t status_hidden = terminal_status_active() && terminal_status_hide();
+	terminal_buffer_t buffer;
+	terminal_buffer_init(&buffer, level_fd(level));
+	buffer.async = terminal_async_enabled();
+	terminal_buffer_append(&buffer, level_prefixes[level].text, level_prefixes[level].length);
+	append_formatted(&buffer, fmt, args);
+	terminal_buffer_append(&buffer, "\n", 1);
+	if(!buffer.async) fflush(level >= PLATFORM_LOG_LEVEL_WARN ? stderr : stdout);
+	terminal_buffer_flush(&buffer);
+	if(status_hidden) terminal_status_show(1);
+}
+
+void platform_log_write(const uint8_t level, const char* fmt, ...) {
+	va_list args;
+	va_start(args, fmt);
+	log_write(level, fmt, args);
+	va_end(args);
+}
+
+#define SIZE_DEFAULT     0
+#define SIZE_CHAR        1
+#define SIZE_SHORT       2
+#define SIZE_LONG        3
+#define SIZE_LONG_LONG   4
+#define SIZE_SIZE        5
+#define SIZE_INTMAX      6
+#define SIZE_PTRDIFF     7
+#define SIZE_LONG_DOUBLE 8
+
+typedef struct {
+	uint32_t length;          // characters from the '%' up to and including the conversion
+	uint32_t modifier_offset; // where the length modifier starts
+	uint8_t  star_count;      // width and precision passed as arguments
+	int8_t   precision_star;
+	int32_t  precision;       // -1 when not given
+	uint8_t  size;
+	char     conversion;
+} format_spec_t;
+
+// str points at the '%', returns 0 for conversions that can not be deferred
+static int8_t parse_spec(const char* str, format_spec_t* spec) {
+	uint32_t i = 1;
+	spec->star_count = 0;
+	spec->precision_star = 0;
+	spec->precision = -1;
+	while(str[i] != '\0' && strchr("-+ #0'", str[i]) != NULL) i++;
+	if(str[i] == '*') {
+		spec->star_count++;
+		i++;
+	}
+	while(str[i] >= '0' && str[i] <= '9') i++;
+	if(str[i] == '.') {
+		i++;
+		if(str[i] == '*') {
+			spec->star_count++;
+			spec->precision_star = 1;
+			i++;
+		} else {
+			spec->precision = 0;
+			while(str[i] >= '0' && str[i] <= '9') spec->precision = spec->precision * 10 + (str[i++] - '0');
+		}
+	}
+
+	spec->modifier_offset = i;
+	spec->size = SIZE_DEFAULT;
+	switch(str[i]) {
+		case 'h': spec->size = str[i + 1] == 'h' ? SIZE_CHAR : SIZE_SHORT; break;
+		case 'l': spec->size = str[i + 1] == 'l' ? SIZE_LONG_LONG : SIZE_LONG; break;
+		case 'z': spec->size = SIZE_SIZE; break;
+		case 'j': spec->size = SIZE_INTMAX; break;
+		case 't': spec->size = SIZE_PTRDIFF; break;
+		case 'L': spec->size = SIZE_LONG_DOUBLE; break;
+	}
+	if(spec->size == SIZE_CHAR || spec->size == SIZE_LONG_LONG) i += 2;
+	else if(spec->size != SIZE_DEFAULT) i++;
+
+	spec->conversion = str[i];
+	spec->length = i + 1;
+	if(spec->length > LOG_MAX_SPEC_SIZE) return 0;
+	switch(spec->conversion) {
+		case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+			return spec->size != SIZE_LONG_DOUBLE;
+		case 'c': case 's': case 'p':
+			return spec->size == SIZE_DEFAULT;
+		case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+			return spec->size == SIZE_DEFAULT || spec->size == SIZE_LONG || spec->size == SIZE_LONG_DOUBLE;
+	}
+	// %n and anything unknown
+	return 0;
+}
+
+static int64_t read_signed(const uint8_t size, va_list* args) {
+	switch(size) {
+		case SIZE_CHAR:      return (signed char)va_arg(*args, int);
+		case SIZE_SHORT:     return (short)va_arg(*args, int);
+		case SIZE_LONG:      return va_arg(*args, long);
+		case SIZE_LONG_LONG: return va_arg(*args, long long);
+		case SIZE_SIZE:      return (int64_t)va_arg(*args, size_t);
+		case SIZE_INTMAX:    return va_arg(*args, intmax_t);
+		case SIZE_PTRDIFF:   return va_arg(*args, ptrdiff_t);
+	}
+	return va_arg(*args, int);
+}
+
+static uint64_t read_unsigned(const uint8_t size, va_list* args) {
+	switch(size) {
+		case SIZE_CHAR:      return (unsigned char)va_arg(*args, unsigned int);
+		case SIZE_SHORT:     return (unsigned short)va_arg(*args, unsigned int);
+		case SIZE_LONG:      return va_arg(*args, unsigned long);
+		case SIZE_LONG_LONG: return va_arg(*args, unsigned long long);
+		case SIZE_SIZE:      return va_arg(*args, size_t);
+		case SIZE_INTMAX:    return va_arg(*args, uintmax_t);
+		case SIZE_PTRDIFF:   return (uint64_t)va_arg(*args, ptrdiff_t);
+	}
+	return va_arg(*args, unsigned int);
+}
+
+static inline int8_t put(uint8_t* record, uint32_t* len, const void* value, const uint32_t size) {
+	if(*len + size > LOG_RECORD_SIZE) return 0;
+	memcpy(record + *len, value, size);
+	*len += size;
+	return 1;
+}
+
+// returns the size of the record, or 0 if the message has to be formatted right away
+static uint32_t record_arguments(uint8_t* record, const uint8_t level, const char* fmt, va_list* args) {
+	uint32_t len = 0;
+	put(record, &len, &fmt, sizeof(fmt));
+	put(record, &len, &level, 1);
+
+	for(const char* c = fmt; *c != '\0'; c++) {
+		if(*c != '%') continue;
+		if(c[1] == '%') {
+			c++;
+			continue;
+		}
+		format_spec_t spec;
+		if(!parse_spec(c, &spec)) return 0;
+		c += spec.length - 1;
+
+		int32_t precision = spec.precision;
+		for(uint32_t i = 0; i < spec.star_count; i++) {
+			int32_t star = va_arg(*args, int);
+			if(spec.precision_star && i == spec.star_count - 1) precision = star;
+			if(!put(record, &len, &star, sizeof(star))) return 0;
+		}
+
+		int8_t fits = 1;
+		switch(spec.conversion) {
+			case 'd': case 'i': {
+				int64_t value = read_signed(spec.size, args);
+				fits = put(record, &len, &value, sizeof(value));
+			} break;
+			case 'u': case 'o': case 'x': case 'X': {
+				uint64_t value = read_unsigned(spec.size, args);
+				fits = put(record, &len, &value, sizeof(value));
+			} break;
+			case 'c': {
+				int32_t value = va_arg(*args, int);
+				fits = put(record, &len, &value, sizeof(value));
+			} break;
+			case 'p': {
+				void* value = va_arg(*args, void*);
+				fits = put(record, &len, &value, sizeof(value));
+			} break;
+			case 's': {
+				const char* str = va_arg(*args, const char*);
+				if(str == NULL) str = "(null)";
+				// long strings are cut to what is left of the record
+				if(len + sizeof(uint32_t) + 1 > LOG_RECORD_SIZE) return 0;
+				uint32_t max = LOG_RECORD_SIZE - len - sizeof(uint32_t) - 1;
+				if(precision >= 0 && (uint32_t)precision < max) max = precision;
+				uint32_t str_len = strnlen(str, max);
+				put(record, &len, &str_len, sizeof(str_len));
+				put(record, &len, str, str_len);
+				record[len++] = '\0';
+			} break;
+			default: {
+				if(spec.size == SIZE_LONG_DOUBLE) {
+					long double value = va_arg(*args, long double);
+					fits = put(record, &len, &value, sizeof(value));
+				} else {
+					double value = va_arg(*args, double);
+					fits = put(record, &len, &value, sizeof(value));
+				}
+			} break;
+		}
+		if(!fits) return 0;
+	}
+	return len;
+}
+
+void platform_log_deferred_write(const uint8_t level, const char* fmt, ...) {
+	va_list args;
+	// the status region has to be hidden around every message, that is done by the printing thread
+	if(terminal_async_enabled() && !terminal_status_active()) {
+		uint8_t record[LOG_RECORD_SIZE];
+		va_start(args, fmt);
+		uint32_t len = record_arguments(record, level, fmt, &args);
+		va_end(args);
+		if(len != 0 && terminal_async_write_log(level_fd(clamp_level(level)), record, len)) return;
+	}
+	va_start(args, fmt);
+	log_write(level, fmt, args);
+	va_end(args);
+}
+
+#define FORMAT_VALUE(value) \
+	(spec.star_count == 0 ? snprintf(out + written, capacity - written, spec_str, value) : \
+	 spec.star_count == 1 ? snprintf(out + written, capacity - written, spec_str, stars[0], value) : \
+	 snprintf(out + written, capacity - written, spec_str, stars[0], stars[1], value))
+
+#define READ(value) \
+	do { if(read + sizeof(value) > len) return written; memcpy(&(value), data + read, sizeof(value)); read += sizeof(value); } while(0)
+
+uint32_t terminal_log_expand(const void* record, const uint32_t len, char* out, uint32_t capacity) {
+	const uint8_t* data = record;
+	const char* fmt;
+	uint8_t level;
+	uint32_t read = 0;
+	uint32_t written = 0;
+	if(len < sizeof(fmt) + 1 || capacity == 0) return 0;
+	READ(fmt);
+	READ(level);
+	level = clamp_level(level);
+	// the last byte is kept for the newline
+	capacity--;
+
+	uint32_t prefix_len = level_prefixes[level].length < capacity ? level_prefixes[level].length : capacity;
+	memcpy(out, level_prefixes[level].text, prefix_len);
+	written += prefix_len;
+
+	const char* c = fmt;
+	while(*c != '\0' && written < capacity) {
+		if(*c != '%' || c[1] == '%') {
+			out[written++] = *c;
+			c += *c == '%' ? 2 : 1;
+			continue;
+		}
+
+		format_spec_t spec;
+		if(!parse_spec(c, &spec)) break;
+		char spec_str[LOG_MAX_SPEC_SIZE + 2];
+		memcpy(spec_str, c, spec.modifier_offset);
+		uint32_t spec_len = spec.modifier_offset;
+		c += spec.length;
+
+		int32_t stars[2];
+		for(uint32_t i = 0; i < spec.star_count; i++) READ(stars[i]);
+
+		int result = 0;
+		switch(spec.conversion) {
+			case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': {
+				// every integer was widened when it was recorded
+				spec_str[spec_len++] = 'l';
+				spec_str[spec_len++] = 'l';
+				spec_str[spec_len++] = spec.conversion;
+				spec_str[spec_len] = '\0';
+				long long value;
+				READ(value);
+				result = FORMAT_VALUE(value);
+			} break;
+			case 'c': {
+				spec_str[spec_len++] = spec.conversion;
+				spec_str[spec_len] = '\0';
+				int32_t value;
+				READ(value);
+				result = FORMAT_VALUE(value);
+			} break;
+			case 'p': {
+				spec_str[spec_len++] = spec.conversion;
+				spec_str[spec_len] = '\0';
+				void* value;
+				READ(value);
+				result = FORMAT_VALUE(value);
+			} break;
+			case 's': {
+				spec_str[spec_len++] = spec.conversion;
+				spec_str[spec_len] = '\0';
+				uint32_t str_len;
+				READ(str_len);
+				if(read + str_len + 1 > len) return written;
+				const char* value = (const char*)data + read;
+				read += str_len + 1;
+				result = FORMAT_VALUE(value);
+			} break;
+			default: {
+				if(spec.size == SIZE_LONG_DOUBLE) {
+					spec_str[spec_len++] = 'L';
+					spec_str[spec_len++] = spec.conversion;
+					spec_str[spec_len] = '\0';
+					long double value;
+					READ(value);
+					result = FORMAT_VALUE(value);
+				} else {
+					spec_str[spec_len++] = spec.conversion;
+					spec_str[spec_len] = '\0';
+					double value;
+					READ(value);
+					result = FORMAT_VALUE(value);
+				}
+			} break;
+		}
+		if(result > 0) written = written + result < capacity ? written + result : capacity;
+	}
+	out[written++] = '\n';
+	return written;
+}
@@ -1,18 +1,30 @@
+#define _GNU_SOURCE
 #ifndef LINUX_PLATFORM_H
 #define LINUX_PLATFORM_H
 
 #include "linux_internal.h"
 #include "xlib_window.h"
+#include "xcb_window.h"
+#include "headless_window.h"
+#include "common/pixel_kernels.h"
 #include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
-#define _GNU_SOURCE
 #include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
 
 #include <vulkan/vulkan.h>
 
-linux_context_t linux_platform_context;
+// wake_fd is -1 whenever the platform is not initialized, platform_wake may still be called then
+linux_context_t linux_platform_context = { .wake_fd = -1 };
 
 void* platform_allocator_alloc(uint64_t size, uint64_t alignment, platform_allocation_callbacks_t* allocator) {
 	if(allocator != NULL) {
@@ -32,13 +44,74 @@ void platform_allocator_free(void* addr, platform_allocation_callbacks_t* alloct
 	}
 }
 
+static int8_t init_backend(const uint32_t backend, const int8_t event_thread) {
+	switch(backend) {
+	case PLATFORM_BACKEND_XCB:
+		if(!xcb_backend_init_context(&linux_platform_context.xcb)) return 0;
+		linux_platform_context.window_functions = XCB_BACKEND_FUNCTIONS;
+		break;
+	case PLATFORM_BACKEND_HEADLESS:
+		headless_init_context(&linux_platform_context.headless);
+		linux_platform_context.window_functions = HEADLESS_WINDOW_FUNCTIONS;
+		break;
+	default:
+		if(!xlib_init_context(&linux_platform_context.xlib, event_thread)) return 0;
+		linux_platform_context.window_functions = XLIB_WINDOW_FUNCTIONS;
+		break;
+	}
+	linux_platform_context.backend = backend;
+	return 1;
+}
+static void cleanup_backend(void) {
+	switch(linux_platform_context.backend) {
+	case PLATFORM_BACKEND_XCB:
+		xcb_backend_cleanup_context(&linux_platform_context.xcb);
+		break;
+	case PLATFORM_BACKEND_HEADLESS:
+		break;
+	default:
+		xlib_cleanup_context(&linux_platform_context.xlib);
+		break;
+	}
+}
+
 int8_t platform_init(const platform_settings_t* settings) {
-	if(xlib_init_context(&linux_platform_context.xlib) == 0) return 0;
-	linux_platform_context.window_functions = XLIB_WINDOW_FUNCTIONS;
+	linux_platform_context.wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if(linux_platform_context.wake_fd == -1) return 0;
+	int8_t event_thread = settings != NULL && (settings->flags & PLATFORM_SF_EVENT_THREAD);
+	uint32_t backend = settings != NULL && settings->backend != PLATFORM_BACKEND_DEFAULT ? settings->backend : PLATFORM_BACKEND_XLIB;
+	// there is nothing to read events from
+	if(backend == PLATFORM_BACKEND_HEADLESS) event_thread = 0;
+	pixel_kernels_init();
+	if(!init_backend(backend, event_thread)) {
+		close(linux_platform_context.wake_fd);
+		linux_platform_context.wake_fd = -1;
+		return 0;
+	}
+	event_queue_init(&linux_platform_context.events);
+	event_ring_init(&linux_platform_context.ring);
+	atomic_store(&linux_platform_context.app_waiting, 0);
+	atomic_store(&linux_platform_context.backlog, 0);
+	linux_platform_context.event_thread = event_thread;
+	if(event_thread && !linux_platform_context.window_functions.start_event_thread()) {
+		linux_platform_context.event_thread = 0;
+		cleanup_backend();
+		close(linux_platform_context.wake_fd);
+		linux_platform_context.wake_fd = -1;
+		return 0;
+	}
 	return 1;
 }
 void platform_shutdown(void) {
-	xlib_cleanup_context(&linux_platform_context.xlib);
+	platform_tracking_report_leaks();
+	platform_terminal_async_stop();
+	if(linux_platform_context.event_thread) {
+		linux_platform_context.window_functions.stop_event_thread();
+		linux_platform_context.event_thread = 0;
+	}
+	cleanup_backend();
+	close(linux_platform_context.wake_fd);
+	linux_platform_context.wake_fd = -1;
 }
 
 
@@ -54,13 +127,16 @@ void platform_get_window_position(const platform_window_t* window, int32_t* x, i
 void platform_get_window_size(const platform_window_t* window, uint32_t* width, uint32_t* height) {
 	linux_platform_context.window_functions.get_window_size(window, width, height);
 }
+void platform_refresh_window_state(platform_window_t* window) {
+	linux_platform_context.window_functions.refresh_window_state(window);
+}
 void platform_set_window_position(platform_window_t* window, const int32_t x, const int32_t y) {
 	linux_platform_context.window_functions.set_window_position(window, x, y);
 }
 void platform_set_window_size(platform_window_t* window, const uint32_t width, const uint32_t height) {
 	linux_platform_context.window_functions.set_window_size(window, width, height);
 }
-void get_window_name(const platform_window_t* window, char* name, uint32_t max_len) {
+void platform_get_window_name(const platform_window_t* window, char* name, uint32_t max_len) {
 	return linux_platform_context.window_functions.get_window_name(window, name, max_len);
 }
 void platform_set_window_name(platform_window_t* window, const char* name) {
@@ -74,10 +150,54 @@ void platform_unmap_window(platform_window_t* window) {
 	linux_platform_context.window_functions.unmap_window(window);
 }
 
+int8_t platform_window_is_mapped(const platform_window_t* window) {
+	return linux_platform_context.window_functions.window_is_mapped(window);
+}
+int8_t platform_window_has_focus(const platform_window_t* window) {
+	return linux_platform_context.window_functions.window_has_focus(window);
+}
+
 int8_t platform_window_should_close(const platform_window_t* window) {
 	return linux_platform_context.window_functions.window_should_close(window);
 }
 
+int8_t platform_window_get_framebuffer(platform_window_t* window, platform_framebuffer_t* framebuffer) {
+	return linux_platform_context.window_functions.get_framebuffer(window, framebuffer);
+}
+void platform_window_present(platform_window_t* window, const platform_rect_t* damage, const uint32_t damage_count) {
+	linux_platform_context.window_functions.present(window, damage, damage_count);
+}
+
+uint32_t platform_get_monitors(platform_monitor_t* monitors, const uint32_t max_count) {
+	return linux_platform_context.window_functions.get_monitors(monitors, max_count);
+}
+int8_t platform_window_get_monitor(const platform_window_t* window, platform_monitor_t* monitor) {
+	platform_monitor_t monitors[PLATFORM_MAX_MONITORS];
+	uint32_t count = platform_get_monitors(monitors, PLATFORM_MAX_MONITORS);
+	if(count == 0) return 0;
+	int32_t x, y;
+	uint32_t width, height;
+	linux_platform_context.window_functions.get_window_position(window, &x, &y);
+	linux_platform_context.window_functions.get_window_size(window, &width, &height);
+	// the primary monitor is first and wins when the window is on none of them
+	uint32_t best = 0;
+	uint64_t best_area = 0;
+	for(uint32_t i = 0; i < count; i++) {
+		int64_t x0 = x > monitors[i].x ? x : monitors[i].x;
+		int64_t y0 = y > monitors[i].y ? y : monitors[i].y;
+		int64_t x1 = (int64_t)x + width < (int64_t)monitors[i].x + monitors[i].width ? (int64_t)x + width : (int64_t)monitors[i].x + monitors[i].width;
+		int64_t y1 = (int64_t)y + height < (int64_t)monitors[i].y + monitors[i].height ? (int64_t)y + height : (int64_t)monitors[i].y + monitors[i].height;
+		if(x0 >= x1 || y0 >= y1) continue;
+		uint64_t area = (uint64_t)(x1 - x0) * (uint64_t)(y1 - y0);
+		if(area > best_area) {
+			best = i;
+			best_area = area;
+		}
+	}
+	*monitor = monitors[best];
+	return 1;
+}
+
 char** platform_vulkan_required_extensions(uint32_t* extension_count) {
 	return linux_platform_context.window_functions.vulkan_required_extensions(extension_count);
 }
@@ -86,72 +206,161 @@ VkSurfaceKHR platform_vulkan_create_surface(platform_window_t* window, VkInstanc
 	return linux_platform_context.window_functions.vulkan_create_surface(window, instance);
 }
 
+void platform_flush(void) {
+	linux_platform_context.window_functions.flush();
+}
 void platform_handle_events(void) {
 	linux_platform_context.window_functions.handle_events();
 }
 
-// NOTE: add 10 to get background color
-static const uint32_t color_table[] = {
-	0,
-	30, 31, 32, 33, 34, 35, 36, 37,
-	90, 91, 92, 93, 94, 95, 96, 97
-};
-
-
-static inline void _terminal_print(const char* msg, const uint8_t forground, const uint8_t background, const uint8_t flags, FILE* stream) {
-	uint32_t fg = color_table[forground];
-	uint32_t bg = color_table[background] + 10;
-
-	char properties[16] = {0};
-	char* prop_str = properties;
-
-	prop_str += sprintf(prop_str, "\033[");
-	if(fg != 0) {
-		prop_str += sprintf(prop_str, "%d", fg);
+void linux_publish_events(void) {
+	const platform_event_t* event;
+	int8_t published = 0;
+	// whatever does not fit stays in the queue, where it can still be coalesced
+	while((event = event_queue_peek(&linux_platform_context.events)) != NULL) {
+		if(!event_ring_push(&linux_platform_context.ring, event)) break;
+		platform_event_t discarded;
+		event_queue_pop(&linux_platform_context.events, &discarded);
+		published = 1;
 	}
-	if(bg != 0) {
-		if(fg != 0) prop_str += sprintf(prop_str, ";");
-		prop_str += sprintf(prop_str, "%d", bg);
+	int8_t backlog = event != NULL;
+	atomic_store_explicit(&linux_platform_context.backlog, backlog, memory_order_relaxed);
+	if(!published && !backlog) return;
+	// pairs with wait_event_thread setting app_waiting before it checks the ring
+	atomic_thread_fence(memory_order_seq_cst);
+	if(atomic_load_explicit(&linux_platform_context.app_waiting, memory_order_relaxed)) {
+		uint64_t one = 1;
+		write(linux_platform_context.wake_fd, &one, sizeof(one));
 	}
+}
 
-
-	if((flags & PLATFORM_TEXT_BOLD) == PLATFORM_TEXT_BOLD) {
-		if(fg != 0 || bg != 0) prop_str += sprintf(prop_str, ";");
-		prop_str += sprintf(prop_str, "1");
-	}
-	if((flags & PLATFORM_TEXT_UNDERLINE) == PLATFORM_TEXT_UNDERLINE) {
-		if(fg != 0 || bg != 0) prop_str += sprintf(prop_str, ";");
-		prop_str += sprintf(prop_str, "4");
+static int8_t wait_event_thread(const uint64_t timeout_ns) {
+	// sends the requests made since the last call, the replies to them may be what is waited for
+	linux_platform_context.window_functions.handle_events();
+	atomic_store(&linux_platform_context.app_waiting, 1);
+	int8_t result = 1;
+	if(event_ring_empty(&linux_platform_context.ring) && atomic_load(&linux_platform_context.backlog)) {
+		linux_platform_context.window_functions.publish_backlog();
 	}
-
-	prop_str += sprintf(prop_str, "m");
-	fputs(properties, stream);
-	uint32_t index = 0;
-	// before you ask, yes, I know this is slow
-	while(msg[index] != '\0') {
-		if(msg[index] == '\n') {
-			// replacing newlines with "\033[0m\n" prevents
-			// the background from extending past the text
-			fputs("\033[0m\n", stream);
-			fputs(properties, stream);
-			index++;
-		}
-		else putc(msg[index++], stream);
+	if(event_ring_empty(&linux_platform_context.ring)) {
+		struct pollfd fd = { .fd = linux_platform_context.wake_fd, .events = POLLIN };
+		struct timespec timeout;
+		timeout.tv_sec = timeout_ns / 1000000000;
+		timeout.tv_nsec = timeout_ns % 1000000000;
+		result = ppoll(&fd, 1, timeout_ns == PLATFORM_WAIT_INFINITE ? NULL : &timeout, NULL) > 0;
 	}
-	fputs("\033[0m", stream);
-	fflush(stream);
+	atomic_store(&linux_platform_context.app_waiting, 0);
+	uint64_t count;
+	while(read(linux_platform_context.wake_fd, &count, sizeof(count)) > 0);
+	return result;
 }
 
-void platform_terminal_print(const char* msg, const uint8_t forground, const uint8_t background, const uint8_t flags) {
-	_terminal_print(msg, forground, background, flags, stdout);
+int8_t platform_wait_events(const uint64_t timeout_ns) {
+	if(linux_platform_context.event_thread) return wait_event_thread(timeout_ns);
+	return linux_platform_context.window_functions.wait_events(timeout_ns);
+}
+int8_t platform_poll_event(platform_event_t* event) {
+	if(!linux_platform_context.event_thread) return event_queue_pop(&linux_platform_context.events, event);
+	if(event_ring_pop(&linux_platform_context.ring, event)) return 1;
+	if(!atomic_load_explicit(&linux_platform_context.backlog, memory_order_relaxed)) return 0;
+	linux_platform_context.window_functions.publish_backlog();
+	return event_ring_pop(&linux_platform_context.ring, event);
+}
+uint64_t platform_event_dropped_count(void) {
+	return atomic_load_explicit(&linux_platform_context.events.dropped, memory_order_relaxed);
 }
-void platform_terminal_print_error(const char* msg, const uint8_t forground, const uint8_t background, const uint8_t flags) {
-	_terminal_print(msg, forground, background, flags, stderr);
+int8_t platform_headless_inject_event(const platform_event_t* event) {
+	if(linux_platform_context.backend != PLATFORM_BACKEND_HEADLESS) return 0;
+	return headless_inject_event(event);
+}
+uint32_t* platform_headless_window_pixels(platform_window_t* window, uint32_t* width, uint32_t* height) {
+	if(linux_platform_context.backend != PLATFORM_BACKEND_HEADLESS) return NULL;
+	return headless_window_pixels(window, width, height);
 }
 
+void platform_wake(void) {
+	if(linux_platform_context.wake_fd == -1) return;
+	uint64_t one = 1;
+	write(linux_platform_context.wake_fd, &one, sizeof(one));
+}
 
 uint64_t platform_get_timestamp(void) {
-	return 0;
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint64_t)t.tv_sec * 1000000000 + t.tv_nsec;
+}
+uint64_t platform_get_timestamp_frequency(void) {
+	return 1000000000;
+}
+
+// ticks are converted with ns = base_ns + ((ticks - base_ticks) * mult) >> 32
+static struct {
+	int8_t   enabled;
+	uint64_t base_ticks;
+	uint64_t base_ns;
+	uint64_t mult;
+	uint64_t frequency;
+} fast_timestamp;
+
+static inline uint64_t read_ticks(void) {
+	#if defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+	#elif defined(__aarch64__)
+		uint64_t ticks;
+		__asm__ volatile("isb; mrs %0, cntvct_el0" : "=r"(ticks));
+		return ticks;
+	#else
+		return 0;
+	#endif
+}
+
+static inline int8_t ticks_invariant(void) {
+	#if defined(__x86_64__) || defined(__i386__)
+		uint32_t eax, ebx, ecx, edx;
+		if(__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) == 0 || eax < 0x80000007) return 0;
+		__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+		return (edx & (1 << 8)) != 0;
+	#elif defined(__aarch64__)
+		// the generic timer is constant rate by definition
+		return 1;
+	#else
+		return 0;
+	#endif
+}
+
+int8_t platform_calibrate_fast_timestamp(const uint32_t miliseconds) {
+	fast_timestamp.enabled = 0;
+	if(!ticks_invariant()) return 0;
+
+	#if defined(__aarch64__)
+		uint64_t frequency;
+		__asm__ volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+		(void)miliseconds;
+	#else
+		uint64_t start_ns = platform_get_timestamp();
+		uint64_t start_ticks = read_ticks();
+		platform_sleep_miliseconds(miliseconds);
+		uint64_t end_ns = platform_get_timestamp();
+		uint64_t end_ticks = read_ticks();
+		if(end_ns <= start_ns || end_ticks <= start_ticks) return 0;
+		uint64_t frequency = (uint64_t)((unsigned __int128)(end_ticks - start_ticks) * 1000000000 / (end_ns - start_ns));
+	#endif
+	if(frequency == 0) return 0;
+
+	fast_timestamp.frequency = frequency;
+	fast_timestamp.mult = (uint64_t)(((unsigned __int128)1000000000 << 32) / frequency);
+	fast_timestamp.base_ns = platform_get_timestamp();
+	fast_timestamp.base_ticks = read_ticks();
+	fast_timestamp.enabled = 1;
+	return 1;
+}
+uint64_t platform_get_fast_timestamp(void) {
+	if(!fast_timestamp.enabled) return platform_get_timestamp();
+	uint64_t delta = read_ticks() - fast_timestamp.base_ticks;
+	return fast_timestamp.base_ns + (uint64_t)(((unsigned __int128)delta * fast_timestamp.mult) >> 32);
+}
+uint64_t platform_get_fast_timestamp_tick_frequency(void) {
+	return fast_timestamp.enabled ? fast_timestamp.frequency : 0;
 }
 void platform_sleep_miliseconds(const uint32_t miliseconds) {
 	#if _BSD_SOURCE || (_XOPEN_SOURCE >= 500 || \
@@ -168,15 +377,173 @@ void platform_sleep_miliseconds(const uint32_t miliseconds) {
 	#endif
 }
 
+// how late clock_nanosleep tends to wake up, sleep_until sleeps this much
+// short of the deadline and spins for the rest
+static uint64_t sleep_overshoot_ns = 200000;
+
+static inline void cpu_relax(void) {
+	#if defined(__x86_64__) || defined(__i386__)
+		_mm_pause();
+	#elif defined(__aarch64__)
+		__asm__ volatile("yield");
+	#endif
+}
+
+void platform_sleep_until(const uint64_t deadline_ns) {
+	uint64_t overshoot = __atomic_load_n(&sleep_overshoot_ns, __ATOMIC_RELAXED);
+	uint64_t margin = overshoot * 2;
+	if(margin < 50000) margin = 50000;
+	if(margin > 2000000) margin = 2000000;
+
+	uint64_t now = platform_get_timestamp();
+	if(deadline_ns > now + margin) {
+		uint64_t wake_ns = deadline_ns - margin;
+		struct timespec wake_time;
+		wake_time.tv_sec = wake_ns / 1000000000;
+		wake_time.tv_nsec = wake_ns % 1000000000;
+		while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake_time, NULL) != 0);
+
+		now = platform_get_timestamp();
+		int64_t error = (int64_t)(now - wake_ns) - (int64_t)overshoot;
+		__atomic_store_n(&sleep_overshoot_ns, (uint64_t)((int64_t)overshoot + error / 8), __ATOMIC_RELAXED);
+	}
+	while(now < deadline_ns) {
+		cpu_relax();
+		now = platform_get_timestamp();
+	}
+}
+
 void* platform_map_memory(void* addr_hint, uint64_t size) {
 	void* mem = mmap(addr_hint, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, 0, 0);
 	if(mem == MAP_FAILED) return NULL;
 	return mem;
 }
 
+// reads the first number after prefix in a file, 0 if not found
+static uint64_t read_number_from_file(const char* path, const char* prefix) {
+	FILE* f = fopen(path, "r");
+	if(f == NULL) return 0;
+	char line[256];
+	uint64_t value = 0;
+	uint32_t prefix_len = 0;
+	while(prefix[prefix_len] != '\0') prefix_len++;
+	while(fgets(line, sizeof(line), f) != NULL) {
+		uint32_t i = 0;
+		while(i < prefix_len && line[i] == prefix[i]) i++;
+		if(i != prefix_len) continue;
+		value = strtoull(line + prefix_len, NULL, 10);
+		break;
+	}
+	fclose(f);
+	return value;
+}
+
+static void* map_huge_pages(void* addr_hint, uint64_t size, int prefault, uint64_t* page_size) {
+	uint64_t huge_size = read_number_from_file("/proc/meminfo", "Hugepagesize:") * 1024;
+	if(huge_size == 0) return NULL;
+	uint64_t huge_mapping_size = (size + huge_size - 1) & ~(huge_size - 1);
+	void* mem = mmap(addr_hint, huge_mapping_size, PROT_READ | PROT_WRITE,
+	                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (prefault ? MAP_POPULATE : 0), -1, 0);
+	if(mem == MAP_FAILED) return NULL;
+	*page_size = huge_size;
+	return mem;
+}
+
+// maps with enough slack to align the block to the huge page size,
+// transparent huge pages are only used for aligned ranges
+static void* map_transparent_huge_pages(void* addr_hint, uint64_t size, uint64_t* page_size) {
+	uint64_t huge_size = read_number_from_file("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", "");
+	if(huge_size == 0) return NULL;
+	FILE* f = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+	if(f == NULL) return NULL;
+	char mode[64] = {0};
+	fgets(mode, sizeof(mode), f);
+	fclose(f);
+	if(strstr(mode, "[never]") != NULL) return NULL;
+
+	size = (size + huge_size - 1) & ~(huge_size - 1);
+	uint8_t* mem = mmap(addr_hint, size + huge_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if(mem == MAP_FAILED) return NULL;
+	uint8_t* aligned = (uint8_t*)(((uintptr_t)mem + huge_size - 1) & ~(huge_size - 1));
+	if(aligned != mem) munmap(mem, aligned - mem);
+	uint64_t tail = (mem + size + huge_size) - (aligned + size);
+	if(tail != 0) munmap(aligned + size, tail);
+
+	// the mapping is rounded to the huge page size either way, which is what callers unmap
+	// by. without the advice the kernel can still back it with huge pages in "always" mode
+	madvise(aligned, size, MADV_HUGEPAGE);
+	*page_size = huge_size;
+	return aligned;
+}
+
+void* platform_map_memory_ex(void* addr_hint, uint64_t size, const uint32_t flags, uint64_t* granted_page_size) {
+	uint64_t page_size = platform_get_page_size();
+	int prefault = (flags & PLATFORM_MF_PREFAULT) != 0;
+	void* mem = NULL;
+
+	if(flags & PLATFORM_MF_HUGE_PAGES) {
+		mem = map_huge_pages(addr_hint, size, prefault, &page_size);
+		if(mem == NULL) {
+			mem = map_transparent_huge_pages(addr_hint, size, &page_size);
+			size = (size + page_size - 1) & ~(page_size - 1);
+			// populating has to happen after madvise for the huge pages to be used
+			if(mem != NULL && prefault) {
+				#ifdef MADV_POPULATE_WRITE
+				if(madvise(mem, size, MADV_POPULATE_WRITE) == -1)
+				#endif
+				{
+					for(uint64_t offset = 0; offset < size; offset += platform_get_page_size()) {
+						((volatile uint8_t*)mem)[offset] = 0;
+					}
+				}
+			}
+		}
+	}
+	if(mem == NULL) {
+		mem = mmap(addr_hint, size, PROT_READ | PROT_WRITE,
+		           MAP_PRIVATE | MAP_ANONYMOUS | (prefault ? MAP_POPULATE : 0), -1, 0);
+		if(mem == MAP_FAILED) return NULL;
+	}
+
+	if(flags & PLATFORM_MF_SEQUENTIAL) madvise(mem, size, MADV_SEQUENTIAL);
+	if(flags & PLATFORM_MF_RANDOM) madvise(mem, size, MADV_RANDOM);
+	if(flags & PLATFORM_MF_WILLNEED) madvise(mem, size, MADV_WILLNEED);
+
+	if(granted_page_size) *granted_page_size = page_size;
+	return mem;
+}
+
 int8_t platform_unmap_memory(void* addr, uint64_t size) {
 	if(munmap(addr, size) == -1) return 0;
 	return 1;
 }
 
+void* platform_reserve_memory(void* addr_hint, uint64_t size) {
+	void* mem = mmap(addr_hint, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if(mem == MAP_FAILED) return NULL;
+	return mem;
+}
+int8_t platform_commit_memory(void* addr, uint64_t size) {
+	if(mprotect(addr, size, PROT_READ | PROT_WRITE) == -1) return 0;
+	return 1;
+}
+int8_t platform_decommit_memory(void* addr, uint64_t size) {
+	// the pages are given back to the kernel and read as zero if committed again
+	if(madvise(addr, size, MADV_DONTNEED) == -1) return 0;
+	if(mprotect(addr, size, PROT_NONE) == -1) return 0;
+	return 1;
+}
+int8_t platform_release_memory(void* addr, uint64_t size) {
+	return platform_unmap_memory(addr, size);
+}
+
+uint64_t platform_get_page_size(void) {
+	static uint64_t page_size = 0;
+	if(page_size == 0) page_size = sysconf(_SC_PAGESIZE);
+	return page_size;
+}
+uint64_t platform_get_allocation_granularity(void) {
+	return platform_get_page_size();
+}
+
 #endif // LINUX_PLATFORM_H
\ No newline at end of file
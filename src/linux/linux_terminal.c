@@ -0,0 +1,154 @@
+#include "linux_terminal.h"
+#include <stdio.h>
+#include <string.h>
+#include <threads.h>
+#include <unistd.h>
+
+// NOTE: add 10 to get background color
+static const uint32_t color_table[] = {
+	0,
+	30, 31, 32, 33, 34, 35, 36, 37,
+	90, 91, 92, 93, 94, 95, 96, 97
+};
+
+#define COLOR_COUNT (sizeof(color_table) / sizeof(color_table[0]))
+#define FLAG_COUNT  8 // every combination of bold, underline and negitive
+
+// escape sequence for every forground, background and flag combination,
+// built the first time something is printed, which can be on several threads at once
+static char escape_table[COLOR_COUNT][COLOR_COUNT][FLAG_COUNT][24];
+static uint8_t escape_lengths[COLOR_COUNT][COLOR_COUNT][FLAG_COUNT];
+static once_flag escape_table_once = ONCE_FLAG_INIT;
+
+static void build_escape_table(void) {
+	for(uint32_t fg = 0; fg < COLOR_COUNT; fg++) {
+		for(uint32_t bg = 0; bg < COLOR_COUNT; bg++) {
+			for(uint32_t flags = 0; flags < FLAG_COUNT; flags++) {
+				uint32_t codes[5];
+				uint32_t code_count = 0;
+				if(fg != 0) codes[code_count++] = color_table[fg];
+				if(bg != 0) codes[code_count++] = color_table[bg] + 10;
+				if(flags & PLATFORM_TEXT_BOLD) codes[code_count++] = 1;
+				if(flags & PLATFORM_TEXT_UNDERLINE) codes[code_count++] = 4;
+				if(flags & PLATFORM_TEXT_NEGITIVE) codes[code_count++] = 7;
+
+				// default attributes need no escape, the previous print always ends with a reset
+				char* str = escape_table[fg][bg][flags];
+				uint32_t len = 0;
+				if(code_count != 0) {
+					len += sprintf(str, "\033[");
+					for(uint32_t i = 0; i < code_count; i++) {
+						len += sprintf(str + len, i == 0 ? "%u" : ";%u", codes[i]);
+					}
+					len += sprintf(str + len, "m");
+				}
+				escape_lengths[fg][bg][flags] = len;
+			}
+		}
+	}
+}
+
+void terminal_buffer_init(terminal_buffer_t* buffer, const int fd) {
+	call_once(&escape_table_once, build_escape_table);
+	buffer->fd = fd;
+	buffer->async = 0;
+	buffer->length = 0;
+}
+
+void terminal_buffer_flush(terminal_buffer_t* buffer) {
+	if(buffer->async && terminal_async_write(buffer->fd, buffer->data, buffer->length)) {
+		buffer->length = 0;
+		return;
+	}
+	uint32_t written = 0;
+	while(written < buffer->length) {
+		ssize_t result = write(buffer->fd, buffer->data + written, buffer->length - written);
+		if(result <= 0) break;
+		written += result;
+	}
+	buffer->length = 0;
+}
+
+void terminal_buffer_append(terminal_buffer_t* buffer, const char* str, uint32_t len) {
+	while(len > 0) {
+		if(buffer->length == TERMINAL_BUFFER_SIZE) terminal_buffer_flush(buffer);
+		uint32_t space = TERMINAL_BUFFER_SIZE - buffer->length;
+		uint32_t count = len < space ? len : space;
+		memcpy(buffer->data + buffer->length, str, count);
+		buffer->length += count;
+		str += count;
+		len -= count;
+	}
+}
+
+void terminal_buffer_append_styled(terminal_buffer_t* buffer, const char* msg, const uint8_t forground, const uint8_t background, const uint8_t flags) {
+	uint32_t fg = forground < COLOR_COUNT ? forground : 0;
+	uint32_t bg = background < COLOR_COUNT ? background : 0;
+	const char* escape = escape_table[fg][bg][flags & (FLAG_COUNT - 1)];
+	uint32_t escape_len = escape_lengths[fg][bg][flags & (FLAG_COUNT - 1)];
+
+	if(escape_len == 0) {
+		terminal_buffer_append(buffer, msg, strlen(msg));
+		return;
+	}
+
+	// every line gets its own escape and reset, this prevents
+	// the background from extending past the text
+	const char* start = msg;
+	while(*start != '\0') {
+		const char* end = strchr(start, '\n');
+		uint32_t len = end != NULL ? (uint32_t)(end - start) : (uint32_t)strlen(start);
+		if(len != 0) {
+			terminal_buffer_append(buffer, escape, escape_len);
+			terminal_buffer_append(buffer, start, len);
+			terminal_buffer_append(buffer, "\033[0m", 4);
+		}
+		if(end == NULL) break;
+		terminal_buffer_append(buffer, "\n", 1);
+		start = end + 1;
+	}
+}
+
+static inline int8_t ends_with_newline(const char* msg) {
+	uint32_t len = strlen(msg);
+	return len != 0 && msg[len - 1] == '\n';
+}
+
+static inline void terminal_print(const char* msg, const uint8_t forground, const uint8_t background, const uint8_t flags, FILE* stream) {
+	int8_t status_hidden = terminal_status_active() && terminal_status_hide();
+	terminal_buffer_t buffer;
+	terminal_buffer_init(&buffer, fileno(stream));
+	buffer.async = terminal_async_enabled();
+	terminal_buffer_append_styled(&buffer, msg, forground, background, flags);
+	// anything the application wrote through stdio has to come out first
+	if(!buffer.async) fflush(stream);
+	terminal_buffer_flush(&buffer);
+	if(status_hidden) terminal_status_show(ends_with_newline(msg));
+}
+
+static inline void terminal_print_spans(const platform_terminal_span_t* spans, const uint32_t span_count, FILE* stream) {
+	int8_t status_hidden = terminal_status_active() && terminal_status_hide();
+	terminal_buffer_t buffer;
+	terminal_buffer_init(&buffer, fileno(stream));
+	buffer.async = terminal_async_enabled();
+	for(uint32_t i = 0; i < span_count; i++) {
+		terminal_buffer_append_styled(&buffer, spans[i].text, spans[i].forground, spans[i].background, spans[i].flags);
+	}
+	if(!buffer.async) fflush(stream);
+	terminal_buffer_flush(&buffer);
+	if(status_hidden) terminal_status_show(span_count != 0 ? ends_with_newline(spans[span_count - 1].text) : 1);
+}
+
+void platform_terminal_print(const char* msg, const uint8_t forground, const uint8_t background, const uint8_t flags) {
+	terminal_print(msg, forground, background, flags, stdout);
+}
+void platform_terminal_print_error(const char* msg, const uint8_t forground, const uint8_t background, const uint8_t flags) {
+	terminal_print(msg, forground, background, flags, stderr);
+}
+
+void platform_terminal_print_spans(const platform_terminal_span_t* spans, const uint32_t span_count) {
+	terminal_print_spans(spans, span_count, stdout);
+}
+void platform_terminal_print_spans_error(const platform_terminal_span_t* spans, const uint32_t span_count) {
+	terminal_print_spans(spans, span_count, stderr);
+}
@@ -0,0 +1,36 @@
+#ifndef LINUX_TERMINAL_H
+#define LINUX_TERMINAL_H
+
+#include "platform/platform.h"
+
+#define TERMINAL_BUFFER_SIZE 4096
+
+// collects styled output so a message reaches the terminal in a single write,
+// anything larger than the buffer is written in TERMINAL_BUFFER_SIZE pieces
+typedef struct {
+	int      fd;
+	int8_t   async; // flushes go to the async writer when it is running
+	uint32_t length;
+	char     data[TERMINAL_BUFFER_SIZE];
+} terminal_buffer_t;
+
+void terminal_buffer_init(terminal_buffer_t* buffer, const int fd);
+void terminal_buffer_flush(terminal_buffer_t* buffer);
+void terminal_buffer_append(terminal_buffer_t* buffer, const char* str, uint32_t len);
+void terminal_buffer_append_styled(terminal_buffer_t* buffer, const char* msg, const uint8_t forground, const uint8_t background, const uint8_t flags);
+
+// hands the bytes to the async writer thread, returns 0 if async output is not running
+int8_t terminal_async_write(const int fd, const char* data, uint32_t len);
+int8_t terminal_async_enabled(void);
+// queues a deferred log record that the writer expands with terminal_log_expand
+int8_t terminal_async_write_log(const int fd, const void* record, const uint32_t len);
+// formats a deferred log record into out, returns the number of bytes written
+uint32_t terminal_log_expand(const void* record, const uint32_t len, char* out, const uint32_t capacity);
+
+int8_t terminal_status_active(void);
+// clears the status region so a message can be printed where it was. if this returns 1
+// the region stays locked until terminal_status_show draws it again below the message
+int8_t terminal_status_hide(void);
+void terminal_status_show(const int8_t ended_with_newline);
+
+#endif // LINUX_TERMINAL_H
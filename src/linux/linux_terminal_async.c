@@ -0,0 +1,293 @@
+#include "linux_terminal.h"
+#include <stdatomic.h>
+#include <string.h>
+#include <threads.h>
+#include <unistd.h>
+
+// records are variable sized and written into a ring by any number of threads.
+// a record is published by storing its stream position into seq last, the writer
+// clears everything it consumed and positions only grow, so nothing else can match.
+// a record that would wrap around the end of the ring is preceded by a padding
+// record filling the rest of it
+#define RECORD_ALIGNMENT 16
+#define COALESCE_SIZE    (64 * 1024)
+
+#define RECORD_TEXT    0
+#define RECORD_PADDING 1
+#define RECORD_LOG     2 // a deferred log message, formatted by the writer
+
+typedef struct {
+	atomic_uint_fast64_t seq;
+	uint32_t             length; // payload bytes following the header
+	int16_t              fd;
+	uint16_t             kind;
+} record_header_t;
+
+static inline uint64_t record_size(const uint64_t length) {
+	return (sizeof(record_header_t) + length + RECORD_ALIGNMENT - 1) & ~(uint64_t)(RECORD_ALIGNMENT - 1);
+}
+
+static struct {
+	atomic_int           running;
+	atomic_int           active_writers; // prints currently using the ring
+	uint8_t              overflow_policy;
+	uint8_t*             ring;
+	uint64_t             capacity;
+	atomic_uint_fast64_t write_pos;
+	atomic_uint_fast64_t read_pos;
+	atomic_uint_fast64_t dropped;
+	uint64_t             dropped_reported;
+
+	thrd_t               writer;
+	mtx_t                lock;
+	cnd_t                data_ready;
+	cnd_t                data_written;
+	atomic_int           writer_sleeping;
+	atomic_int           stopping;
+} async;
+
+static void write_all(const int fd, const char* data, uint32_t len) {
+	while(len > 0) {
+		ssize_t result = write(fd, data, len);
+		if(result <= 0) return;
+		data += result;
+		len -= result;
+	}
+}
+
+static inline void wake_writer(void) {
+	// pairs with the writer setting writer_sleeping before it checks the ring one last time
+	atomic_thread_fence(memory_order_seq_cst);
+	if(atomic_load_explicit(&async.writer_sleeping, memory_order_relaxed)) {
+		mtx_lock(&async.lock);
+		cnd_signal(&async.data_ready);
+		mtx_unlock(&async.lock);
+	}
+}
+
+// returns the position of the reserved space, or UINT64_MAX if the record was dropped
+static uint64_t reserve(const uint64_t size) {
+	uint64_t head = atomic_load_explicit(&async.write_pos, memory_order_relaxed);
+	for(;;) {
+		uint64_t offset = head & (async.capacity - 1);
+		uint64_t padding = offset + size > async.capacity ? async.capacity - offset : 0;
+		uint64_t tail = atomic_load_explicit(&async.read_pos, memory_order_acquire);
+		if(head + padding + size - tail > async.capacity) {
+			if(async.overflow_policy != PLATFORM_TERMINAL_OVERFLOW_BLOCK) {
+				atomic_fetch_add_explicit(&async.dropped, 1, memory_order_relaxed);
+				return UINT64_MAX;
+			}
+			wake_writer();
+			thrd_yield();
+			head = atomic_load_explicit(&async.write_pos, memory_order_relaxed);
+			continue;
+		}
+		if(atomic_compare_exchange_weak_explicit(&async.write_pos, &head, head + padding + size,
+		                                         memory_order_relaxed, memory_order_relaxed)) {
+			if(padding != 0) {
+				record_header_t* pad = (record_header_t*)(async.ring + offset);
+				pad->length = padding - sizeof(record_header_t);
+				pad->kind = RECORD_PADDING;
+				atomic_store_explicit(&pad->seq, head, memory_order_release);
+			}
+			return head + padding;
+		}
+	}
+}
+
+static void async_write(const int fd, const uint16_t kind, const void* data, const uint32_t len) {
+	uint64_t pos = reserve(record_size(len));
+	if(pos == UINT64_MAX) return;
+
+	record_header_t* header = (record_header_t*)(async.ring + (pos & (async.capacity - 1)));
+	header->length = len;
+	header->fd = fd;
+	header->kind = kind;
+	memcpy(header + 1, data, len);
+	atomic_store_explicit(&header->seq, pos, memory_order_release);
+	wake_writer();
+}
+
+int8_t terminal_async_write(const int fd, const char* data, uint32_t len) {
+	atomic_fetch_add(&async.active_writers, 1);
+	if(!atomic_load(&async.running)) {
+		atomic_fetch_sub(&async.active_writers, 1);
+		return 0;
+	}
+	// records that could never fit are cut into pieces
+	uint32_t max_payload = async.capacity / 2 - sizeof(record_header_t);
+	while(len > max_payload) {
+		async_write(fd, RECORD_TEXT, data, max_payload);
+		data += max_payload;
+		len -= max_payload;
+	}
+	async_write(fd, RECORD_TEXT, data, len);
+	atomic_fetch_sub(&async.active_writers, 1);
+	return 1;
+}
+
+int8_t terminal_async_write_log(const int fd, const void* record, const uint32_t len) {
+	atomic_fetch_add(&async.active_writers, 1);
+	if(!atomic_load(&async.running) || len > async.capacity / 2 - sizeof(record_header_t)) {
+		atomic_fetch_sub(&async.active_writers, 1);
+		return 0;
+	}
+	async_write(fd, RECORD_LOG, record, len);
+	atomic_fetch_sub(&async.active_writers, 1);
+	return 1;
+}
+
+int8_t terminal_async_enabled(void) {
+	return atomic_load(&async.running);
+}
+
+static void report_dropped(void) {
+	if(async.overflow_policy != PLATFORM_TERMINAL_OVERFLOW_COUNT) return;
+	uint64_t dropped = atomic_load_explicit(&async.dropped, memory_order_relaxed);
+	if(dropped == async.dropped_reported) return;
+
+	terminal_buffer_t buffer;
+	terminal_buffer_init(&buffer, STDERR_FILENO);
+	char msg[64];
+	uint32_t len = 0;
+	uint64_t count = dropped - async.dropped_reported;
+	char digits[24];
+	uint32_t digit_count = 0;
+	do {
+		digits[digit_count++] = '0' + count % 10;
+		count /= 10;
+	} while(count != 0);
+	msg[len++] = '[';
+	while(digit_count > 0) msg[len++] = digits[--digit_count];
+	memcpy(msg + len, " messages dropped]\n", 20);
+	terminal_buffer_append_styled(&buffer, msg, PLATFORM_COLOR_YELLOW, 0, 0);
+	terminal_buffer_flush(&buffer);
+	async.dropped_reported = dropped;
+}
+
+// writes out every published record, consecutive records for the same stream are merged
+static int8_t drain(void) {
+	static char coalesce[COALESCE_SIZE];
+	uint32_t coalesce_len = 0;
+	int coalesce_fd = -1;
+	int8_t drained = 0;
+
+	uint64_t tail = atomic_load_explicit(&async.read_pos, memory_order_relaxed);
+	for(;;) {
+		record_header_t* header = (record_header_t*)(async.ring + (tail & (async.capacity - 1)));
+		if(atomic_load_explicit(&header->seq, memory_order_acquire) != tail) break;
+		uint32_t len = header->length;
+		if(header->kind != RECORD_PADDING) {
+			uint32_t output_len = header->kind == RECORD_LOG ? TERMINAL_BUFFER_SIZE : len;
+			if((header->fd != coalesce_fd || coalesce_len + output_len > COALESCE_SIZE) && coalesce_len != 0) {
+				write_all(coalesce_fd, coalesce, coalesce_len);
+				coalesce_len = 0;
+			}
+			coalesce_fd = header->fd;
+			if(header->kind == RECORD_LOG) {
+				coalesce_len += terminal_log_expand(header + 1, len, coalesce + coalesce_len, output_len);
+			} else {
+				memcpy(coalesce + coalesce_len, header + 1, len);
+				coalesce_len += len;
+			}
+		}
+		// cleared so stale payload bytes can never be mistaken for a published header
+		memset(header, 0, record_size(len));
+		tail += record_size(len);
+		// the space can be reused as soon as it has been copied out
+		atomic_store_explicit(&async.read_pos, tail, memory_order_release);
+		drained = 1;
+	}
+	if(coalesce_len != 0) write_all(coalesce_fd, coalesce, coalesce_len);
+	report_dropped();
+	return drained;
+}
+
+static int writer_main(void* data) {
+	for(;;) {
+		int8_t drained = drain();
+		mtx_lock(&async.lock);
+		cnd_broadcast(&async.data_written);
+		if(!drained) {
+			if(atomic_load(&async.stopping)) {
+				mtx_unlock(&async.lock);
+				break;
+			}
+			atomic_store(&async.writer_sleeping, 1);
+			// anything published between the drain and here would be missed otherwise,
+			// after it wake_writer signals under the lock, so no timeout is needed
+			uint64_t tail = atomic_load(&async.read_pos);
+			record_header_t* header = (record_header_t*)(async.ring + (tail & (async.capacity - 1)));
+			if(atomic_load(&header->seq) != tail) cnd_wait(&async.data_ready, &async.lock);
+			atomic_store(&async.writer_sleeping, 0);
+		}
+		mtx_unlock(&async.lock);
+	}
+	return 0;
+}
+
+int8_t platform_terminal_async_start(uint64_t buffer_size, const uint8_t overflow_policy) {
+	if(terminal_async_enabled()) return 0;
+	uint64_t capacity = 4096;
+	while(capacity < buffer_size) capacity <<= 1;
+
+	async.ring = platform_map_memory(NULL, capacity);
+	if(async.ring == NULL) return 0;
+	async.capacity = capacity;
+	async.overflow_policy = overflow_policy;
+	atomic_store(&async.write_pos, 0);
+	atomic_store(&async.read_pos, 0);
+	atomic_store(&async.dropped, 0);
+	async.dropped_reported = 0;
+	atomic_store(&async.stopping, 0);
+	atomic_store(&async.writer_sleeping, 0);
+	// position 0 must not look published in the fresh ring
+	atomic_store(&((record_header_t*)async.ring)->seq, UINT64_MAX);
+
+	mtx_init(&async.lock, mtx_plain);
+	cnd_init(&async.data_ready);
+	cnd_init(&async.data_written);
+	if(thrd_create(&async.writer, writer_main, NULL) != thrd_success) {
+		platform_unmap_memory(async.ring, capacity);
+		return 0;
+	}
+	atomic_store(&async.running, 1);
+	return 1;
+}
+
+void platform_terminal_async_stop(void) {
+	if(!terminal_async_enabled()) return;
+	atomic_store(&async.running, 0);
+	// prints that saw the async mode before it was turned off have to finish first
+	while(atomic_load(&async.active_writers) != 0) thrd_yield();
+	mtx_lock(&async.lock);
+	atomic_store(&async.stopping, 1);
+	cnd_signal(&async.data_ready);
+	mtx_unlock(&async.lock);
+	thrd_join(async.writer, NULL);
+	drain();
+
+	cnd_destroy(&async.data_ready);
+	cnd_destroy(&async.data_written);
+	mtx_destroy(&async.lock);
+	platform_unmap_memory(async.ring, async.capacity);
+	async.ring = NULL;
+}
+
+void platform_terminal_flush(void) {
+	if(!terminal_async_enabled()) return;
+	uint64_t target = atomic_load(&async.write_pos);
+	mtx_lock(&async.lock);
+	while(atomic_load(&async.read_pos) < target) {
+		cnd_signal(&async.data_ready);
+		struct timespec timeout;
+		timespec_get(&timeout, TIME_UTC);
+		timeout.tv_sec += 1;
+		cnd_timedwait(&async.data_written, &async.lock, &timeout);
+	}
+	mtx_unlock(&async.lock);
+}
+
+uint64_t platform_terminal_dropped_count(void) {
+	return atomic_load_explicit(&async.dropped, memory_order_relaxed);
+}
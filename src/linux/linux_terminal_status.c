@@ -0,0 +1,250 @@
+#include "linux_terminal.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <threads.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+// the region is drawn below everything else printed, the cursor is kept at the
+// start of its first line between updates. what is on screen is remembered in
+// a shadow copy so an update only sends the cells that actually changed
+#define STATUS_MAX_LINES 16
+#define STATUS_MAX_WIDTH 512
+// unchanged cells between two changed runs shorter than this are rewritten
+// instead of moving the cursor over them
+#define STATUS_RUN_MERGE_GAP 8
+
+typedef struct {
+	char     text[STATUS_MAX_WIDTH];
+	uint32_t length;
+	uint8_t  forground;
+	uint8_t  background;
+	uint8_t  flags;
+} status_line_t;
+
+static struct {
+	atomic_int    active;
+	once_flag     lock_once;
+	mtx_t         lock; // created once and kept, prints may race with the region ending
+	uint32_t      line_count;
+	uint32_t      width;
+	uint64_t      refresh_period_ns;
+	uint64_t      last_render_ns;
+	int8_t        dirty;
+	status_line_t lines[STATUS_MAX_LINES];
+	status_line_t shadow[STATUS_MAX_LINES];
+} status = { .lock_once = ONCE_FLAG_INIT };
+
+static void create_lock(void) {
+	mtx_init(&status.lock, mtx_plain);
+}
+
+static inline void append_number(terminal_buffer_t* buffer, uint32_t value) {
+	char digits[12];
+	uint32_t count = 0;
+	do {
+		digits[count++] = '0' + value % 10;
+		value /= 10;
+	} while(value != 0);
+	while(count > 0) terminal_buffer_append(buffer, &digits[--count], 1);
+}
+
+// moves the cursor from the line it is on within the region to the given cell
+static void move_to(terminal_buffer_t* buffer, uint32_t* cursor_line, const uint32_t line, const uint32_t column) {
+	if(line != *cursor_line) {
+		terminal_buffer_append(buffer, "\033[", 2);
+		uint32_t distance = line > *cursor_line ? line - *cursor_line : *cursor_line - line;
+		if(distance != 1) append_number(buffer, distance);
+		terminal_buffer_append(buffer, line > *cursor_line ? "B" : "A", 1);
+		*cursor_line = line;
+	}
+	if(column == 0) {
+		terminal_buffer_append(buffer, "\r", 1);
+		return;
+	}
+	terminal_buffer_append(buffer, "\033[", 2);
+	append_number(buffer, column + 1);
+	terminal_buffer_append(buffer, "G", 1);
+}
+
+static inline void write_cells(terminal_buffer_t* buffer, const status_line_t* line, const uint32_t start, const uint32_t end) {
+	char text[STATUS_MAX_WIDTH + 1];
+	memcpy(text, line->text + start, end - start);
+	text[end - start] = '\0';
+	terminal_buffer_append_styled(buffer, text, line->forground, line->background, line->flags);
+}
+
+static uint32_t terminal_width(void) {
+	struct winsize size;
+	if(ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == -1 || size.ws_col == 0) return 80;
+	return size.ws_col < STATUS_MAX_WIDTH ? size.ws_col : STATUS_MAX_WIDTH;
+}
+
+static void render_line(terminal_buffer_t* buffer, uint32_t* cursor_line, const uint32_t index) {
+	status_line_t* line = &status.lines[index];
+	status_line_t* shadow = &status.shadow[index];
+	uint32_t length = line->length < status.width ? line->length : status.width;
+	int8_t style_changed = line->forground != shadow->forground || line->background != shadow->background ||
+	                       line->flags != shadow->flags;
+
+	uint32_t column = 0;
+	uint32_t compare_length = length < shadow->length ? length : shadow->length;
+	while(column < length) {
+		if(!style_changed) {
+			while(column < compare_length && line->text[column] == shadow->text[column]) column++;
+			if(column == length) break;
+		}
+		// extend the run until enough unchanged cells are found
+		uint32_t end = column + 1;
+		uint32_t unchanged = 0;
+		while(end < length && (style_changed || end >= compare_length || unchanged < STATUS_RUN_MERGE_GAP)) {
+			if(!style_changed && end < compare_length && line->text[end] == shadow->text[end]) unchanged++;
+			else unchanged = 0;
+			end++;
+		}
+		end -= unchanged;
+
+		move_to(buffer, cursor_line, index, column);
+		write_cells(buffer, line, column, end);
+		column = end;
+	}
+	if(length < shadow->length) {
+		move_to(buffer, cursor_line, index, length);
+		terminal_buffer_append(buffer, "\033[K", 3);
+	}
+
+	memcpy(shadow->text, line->text, length);
+	shadow->length = length;
+	shadow->forground = line->forground;
+	shadow->background = line->background;
+	shadow->flags = line->flags;
+}
+
+static void render(terminal_buffer_t* buffer) {
+	uint32_t width = terminal_width();
+	if(width != status.width) {
+		// the terminal may have rewrapped everything, start from a clean region
+		status.width = width;
+		terminal_buffer_append(buffer, "\r\033[J", 4);
+		memset(status.shadow, 0, sizeof(status.shadow));
+	}
+	uint32_t cursor_line = 0;
+	for(uint32_t i = 0; i < status.line_count; i++) render_line(buffer, &cursor_line, i);
+	move_to(buffer, &cursor_line, 0, 0);
+	status.dirty = 0;
+	status.last_render_ns = platform_get_timestamp();
+}
+
+// scrolls the screen if needed so the region's lines exist below the cursor
+static void reserve_lines(terminal_buffer_t* buffer) {
+	for(uint32_t i = 1; i < status.line_count; i++) terminal_buffer_append(buffer, "\n", 1);
+	uint32_t cursor_line = status.line_count - 1;
+	move_to(buffer, &cursor_line, 0, 0);
+	memset(status.shadow, 0, sizeof(status.shadow));
+}
+
+static inline void init_output(terminal_buffer_t* buffer) {
+	terminal_buffer_init(buffer, STDOUT_FILENO);
+	buffer->async = terminal_async_enabled();
+}
+
+int8_t terminal_status_active(void) {
+	return atomic_load_explicit(&status.active, memory_order_acquire);
+}
+
+int8_t terminal_status_hide(void) {
+	mtx_lock(&status.lock);
+	if(!terminal_status_active()) {
+		mtx_unlock(&status.lock);
+		return 0;
+	}
+	terminal_buffer_t buffer;
+	init_output(&buffer);
+	terminal_buffer_append(&buffer, "\r\033[J", 4);
+	terminal_buffer_flush(&buffer);
+	return 1;
+}
+
+void terminal_status_show(const int8_t ended_with_newline) {
+	terminal_buffer_t buffer;
+	init_output(&buffer);
+	// the region always starts on a line of its own
+	if(!ended_with_newline) terminal_buffer_append(&buffer, "\n", 1);
+	reserve_lines(&buffer);
+	render(&buffer);
+	terminal_buffer_flush(&buffer);
+	mtx_unlock(&status.lock);
+}
+
+int8_t platform_terminal_status_begin(const uint32_t line_count, const uint32_t refresh_rate) {
+	if(line_count == 0 || line_count > STATUS_MAX_LINES) return 0;
+	call_once(&status.lock_once, create_lock);
+	mtx_lock(&status.lock);
+	if(terminal_status_active()) {
+		mtx_unlock(&status.lock);
+		return 0;
+	}
+	memset(status.lines, 0, sizeof(status.lines));
+	status.line_count = line_count;
+	status.width = terminal_width();
+	status.refresh_period_ns = refresh_rate != 0 ? 1000000000ull / refresh_rate : 0;
+	status.last_render_ns = 0;
+
+	terminal_buffer_t buffer;
+	init_output(&buffer);
+	fflush(stdout);
+	terminal_buffer_append(&buffer, "\r\033[J", 4);
+	reserve_lines(&buffer);
+	terminal_buffer_flush(&buffer);
+	atomic_store_explicit(&status.active, 1, memory_order_release);
+	mtx_unlock(&status.lock);
+	return 1;
+}
+
+void platform_terminal_status_end(void) {
+	if(!terminal_status_active()) return;
+	mtx_lock(&status.lock);
+	if(!terminal_status_active()) {
+		mtx_unlock(&status.lock);
+		return;
+	}
+	terminal_buffer_t buffer;
+	init_output(&buffer);
+	render(&buffer);
+	// leave the last state on screen and continue below it
+	for(uint32_t i = 0; i < status.line_count; i++) terminal_buffer_append(&buffer, "\n", 1);
+	terminal_buffer_flush(&buffer);
+	atomic_store_explicit(&status.active, 0, memory_order_release);
+	mtx_unlock(&status.lock);
+}
+
+void platform_terminal_status_set_line(const uint32_t line, const char* text, const uint8_t forground, const uint8_t background, const uint8_t flags) {
+	if(!terminal_status_active() || line >= status.line_count) return;
+	mtx_lock(&status.lock);
+	status_line_t* l = &status.lines[line];
+	uint32_t length = 0;
+	// newlines would break the layout of the region
+	while(text[length] != '\0' && text[length] != '\n' && length < STATUS_MAX_WIDTH) {
+		l->text[length] = text[length];
+		length++;
+	}
+	l->length = length;
+	l->forground = forground;
+	l->background = background;
+	l->flags = flags;
+	status.dirty = 1;
+	mtx_unlock(&status.lock);
+}
+
+void platform_terminal_status_update(void) {
+	if(!terminal_status_active()) return;
+	mtx_lock(&status.lock);
+	if(status.dirty && platform_get_timestamp() - status.last_render_ns >= status.refresh_period_ns) {
+		terminal_buffer_t buffer;
+		init_output(&buffer);
+		render(&buffer);
+		terminal_buffer_flush(&buffer);
+	}
+	mtx_unlock(&status.lock);
+}
@@ -0,0 +1,321 @@
+#include "x11_common.h"
+#include "linux_internal.h"
+#include <X11/keysym.h>
+#include <string.h>
+
+#define WINDOW_MAP_INITIAL_CAPACITY 16
+// how fast the server time offset may grow back after its minimum, about 120 ppm,
+// more than the drift between two clocks on the same machine should ever be
+#define SERVER_TIME_DRIFT_SHIFT 13
+
+int8_t x11_window_map_init(x11_window_map_t* map) {
+	map->entries = platform_allocator_alloc(WINDOW_MAP_INITIAL_CAPACITY * sizeof(x11_window_entry_t), sizeof(void*), NULL);
+	if(map->entries == NULL) return 0;
+	memset(map->entries, 0, WINDOW_MAP_INITIAL_CAPACITY * sizeof(x11_window_entry_t));
+	map->mask = WINDOW_MAP_INITIAL_CAPACITY - 1;
+	map->count = 0;
+	map->last_handle = 0;
+	map->last_window = NULL;
+	return 1;
+}
+
+void x11_window_map_free(x11_window_map_t* map) {
+	platform_allocator_free(map->entries, NULL);
+	map->entries = NULL;
+}
+
+int8_t x11_window_map_insert(x11_window_map_t* map, const uint32_t handle, platform_window_t* window) {
+	// kept at most half full
+	if((map->count + 1) * 2 > map->mask + 1) {
+		uint32_t capacity = (map->mask + 1) * 2;
+		x11_window_entry_t* entries = platform_allocator_alloc(capacity * sizeof(x11_window_entry_t), sizeof(void*), NULL);
+		if(entries == NULL) return 0;
+		memset(entries, 0, capacity * sizeof(x11_window_entry_t));
+		for(uint32_t i = 0; i <= map->mask; i++) {
+			if(map->entries[i].handle == 0) continue;
+			uint32_t slot = x11_window_slot(capacity - 1, map->entries[i].handle);
+			while(entries[slot].handle != 0) slot = (slot + 1) & (capacity - 1);
+			entries[slot] = map->entries[i];
+		}
+		platform_allocator_free(map->entries, NULL);
+		map->entries = entries;
+		map->mask = capacity - 1;
+	}
+	uint32_t slot = x11_window_slot(map->mask, handle);
+	while(map->entries[slot].handle != 0) slot = (slot + 1) & map->mask;
+	map->entries[slot].handle = handle;
+	map->entries[slot].window = window;
+	map->count++;
+	return 1;
+}
+
+void x11_window_map_remove(x11_window_map_t* map, const uint32_t handle) {
+	if(handle == map->last_handle) {
+		map->last_handle = 0;
+		map->last_window = NULL;
+	}
+	uint32_t slot = x11_window_slot(map->mask, handle);
+	while(map->entries[slot].handle != handle) {
+		if(map->entries[slot].handle == 0) return;
+		slot = (slot + 1) & map->mask;
+	}
+	// shifts later entries of the probe sequence back instead of leaving a tombstone
+	uint32_t hole = slot;
+	for(;;) {
+		slot = (slot + 1) & map->mask;
+		if(map->entries[slot].handle == 0) break;
+		uint32_t home = x11_window_slot(map->mask, map->entries[slot].handle);
+		// entries whose home lies cyclically in (hole, slot] have to stay where they are
+		if(((slot - home) & map->mask) < ((slot - hole) & map->mask)) continue;
+		map->entries[hole] = map->entries[slot];
+		hole = slot;
+	}
+	map->entries[hole].handle = 0;
+	map->entries[hole].window = NULL;
+	map->count--;
+}
+
+static inline uint32_t atom_slot(const x11_atom_set_t* set, const uint32_t atom) {
+	return (atom * 2654435761u) & set->mask;
+}
+
+int8_t x11_atom_set_init(x11_atom_set_t* set, const uint64_t total) {
+	uint32_t capacity = 16;
+	while(capacity < total * 2) capacity <<= 1;
+	set->atoms = platform_allocator_alloc(capacity * sizeof(uint32_t), sizeof(uint32_t), NULL);
+	set->count = 0;
+	set->mask = 0;
+	if(set->atoms == NULL) return 0;
+	memset(set->atoms, 0, capacity * sizeof(uint32_t));
+	set->mask = capacity - 1;
+	return 1;
+}
+
+void x11_atom_set_free(x11_atom_set_t* set) {
+	platform_allocator_free(set->atoms, NULL);
+	set->atoms = NULL;
+	set->count = 0;
+	set->mask = 0;
+}
+
+int8_t x11_atom_set_insert(x11_atom_set_t* set, const uint32_t atom) {
+	if(set->atoms == NULL || set->count * 2 >= set->mask + 1) return 0;
+	uint32_t slot = atom_slot(set, atom);
+	while(set->atoms[slot] != 0) {
+		if(set->atoms[slot] == atom) return 1;
+		slot = (slot + 1) & set->mask;
+	}
+	set->atoms[slot] = atom;
+	set->count++;
+	return 1;
+}
+
+uint32_t x11_atom_set_find(const x11_atom_set_t* set, const uint32_t atom) {
+	if(set->atoms == NULL || atom == 0) return 0;
+	uint32_t slot = atom_slot(set, atom);
+	while(set->atoms[slot] != 0) {
+		if(set->atoms[slot] == atom) return atom;
+		slot = (slot + 1) & set->mask;
+	}
+	return 0;
+}
+
+// the difference between the clocks is estimated from events as they arrive, the smallest one
+// seen had the least delivery delay. on a local Xorg both clocks are CLOCK_MONOTONIC
+uint64_t x11_server_time_to_timestamp(x11_server_time_t* clock, const uint32_t time) {
+	uint64_t now = platform_get_timestamp();
+	// the server time wraps after about 49 days
+	uint64_t server_ms = (clock->last_ms & ~(uint64_t)0xffffffff) | time;
+	if(clock->synced) {
+		if(server_ms + 0x80000000ull < clock->last_ms) server_ms += 0x100000000ull;
+		else if(server_ms > clock->last_ms + 0x80000000ull && server_ms >= 0x100000000ull) server_ms -= 0x100000000ull;
+	}
+
+	int64_t sample = (int64_t)now - (int64_t)(server_ms * 1000000);
+	if(!clock->synced || sample < clock->offset) {
+		clock->offset = sample;
+	}
+	else {
+		clock->offset += (int64_t)(now - clock->sync_ns) >> SERVER_TIME_DRIFT_SHIFT;
+		if(clock->offset > sample) clock->offset = sample;
+	}
+	clock->synced = 1;
+	clock->sync_ns = now;
+	if(server_ms > clock->last_ms) clock->last_ms = server_ms;
+
+	uint64_t timestamp = (uint64_t)((int64_t)(server_ms * 1000000) + clock->offset);
+	return timestamp < now ? timestamp : now;
+}
+
+void x11_pending_init(x11_pending_t* pending) {
+	memset(pending, 0, sizeof(*pending));
+	pending->name_len = UINT32_MAX;
+}
+void x11_pending_free(x11_pending_t* pending) {
+	if(pending->name != NULL) platform_allocator_free(pending->name, NULL);
+	pending->name = NULL;
+	pending->name_capacity = 0;
+}
+
+void x11_pending_set_position(x11_pending_t* pending, const int32_t x, const int32_t y, const int32_t current_x, const int32_t current_y) {
+	int8_t in_flight = (pending->in_flight & X11_PENDING_POSITION) != 0;
+	int32_t base_x = in_flight ? pending->sent_x : current_x;
+	int32_t base_y = in_flight ? pending->sent_y : current_y;
+	pending->x = x;
+	pending->y = y;
+	if(x == base_x && y == base_y) pending->flags &= ~X11_PENDING_POSITION;
+	else pending->flags |= X11_PENDING_POSITION;
+}
+void x11_pending_set_size(x11_pending_t* pending, const uint32_t width, const uint32_t height, const uint32_t current_width, const uint32_t current_height) {
+	int8_t in_flight = (pending->in_flight & X11_PENDING_SIZE) != 0;
+	uint32_t base_width = in_flight ? pending->sent_width : current_width;
+	uint32_t base_height = in_flight ? pending->sent_height : current_height;
+	pending->width = width;
+	pending->height = height;
+	if(width == base_width && height == base_height) pending->flags &= ~X11_PENDING_SIZE;
+	else pending->flags |= X11_PENDING_SIZE;
+}
+void x11_pending_sent(x11_pending_t* pending, const uint32_t serial) {
+	uint32_t sent = pending->flags & (X11_PENDING_POSITION | X11_PENDING_SIZE);
+	if(sent == 0) return;
+	if(sent & X11_PENDING_POSITION) {
+		pending->sent_x = pending->x;
+		pending->sent_y = pending->y;
+	}
+	if(sent & X11_PENDING_SIZE) {
+		pending->sent_width = pending->width;
+		pending->sent_height = pending->height;
+	}
+	pending->in_flight |= sent;
+	pending->sent_serial = serial;
+}
+// events caused by a request carry its serial or a later one, also the synthetic
+// ones a window manager sends after handling a redirected request
+void x11_pending_configured(x11_pending_t* pending, const uint32_t serial) {
+	if(pending->in_flight != 0 && (int32_t)(serial - pending->sent_serial) >= 0) pending->in_flight = 0;
+}
+// titles with a frame counter change every frame, everything else hardly ever
+void x11_pending_set_name(x11_pending_t* pending, const char* name) {
+	uint32_t len = name != NULL ? strlen(name) : UINT32_MAX;
+	if(len == pending->name_len && (name == NULL || memcmp(name, pending->name, len) == 0)) return;
+	if(name != NULL && len + 1 > pending->name_capacity) {
+		// with some room so a growing counter does not reallocate every time
+		uint32_t capacity = (len + 1 + 31) & ~31u;
+		char* buffer = platform_allocator_alloc(capacity, 1, NULL);
+		if(buffer == NULL) return;
+		if(pending->name != NULL) platform_allocator_free(pending->name, NULL);
+		pending->name = buffer;
+		pending->name_capacity = capacity;
+	}
+	if(name != NULL) memcpy(pending->name, name, len + 1);
+	pending->name_len = len;
+	pending->flags |= X11_PENDING_NAME;
+}
+void x11_pending_get_name(const x11_pending_t* pending, char* name, const uint32_t max_len) {
+	if(max_len == 0) return;
+	uint32_t len = 0;
+	if(pending->name_len != UINT32_MAX) {
+		len = pending->name_len < max_len - 1 ? pending->name_len : max_len - 1;
+		memcpy(name, pending->name, len);
+	}
+	name[len] = '\0';
+}
+
+void x11_position_queries_free(x11_position_queries_t* queries) {
+	if(queries->queries != NULL) platform_allocator_free(queries->queries, NULL);
+	queries->queries = NULL;
+	queries->count = 0;
+	queries->capacity = 0;
+}
+// usually a single window, a search beats anything smarter
+x11_position_query_t* x11_position_queries_add(x11_position_queries_t* queries, const uint32_t handle) {
+	for(uint32_t i = 0; i < queries->count; i++) {
+		if(queries->queries[i].handle == handle) return NULL;
+	}
+	if(queries->count == queries->capacity) {
+		uint32_t capacity = queries->capacity != 0 ? queries->capacity * 2 : 8;
+		x11_position_query_t* grown = platform_allocator_alloc(capacity * sizeof(x11_position_query_t), sizeof(void*), NULL);
+		if(grown == NULL) return NULL;
+		if(queries->queries != NULL) {
+			memcpy(grown, queries->queries, queries->count * sizeof(x11_position_query_t));
+			platform_allocator_free(queries->queries, NULL);
+		}
+		queries->queries = grown;
+		queries->capacity = capacity;
+	}
+	x11_position_query_t* query = &queries->queries[queries->count++];
+	memset(query, 0, sizeof(*query));
+	query->handle = handle;
+	return query;
+}
+
+uint32_t x11_translate_keysym(const uint32_t keysym) {
+	if(keysym >= 'A' && keysym <= 'Z') return keysym - 'A' + 'a';
+	if(keysym >= 0x20 && keysym <= 0x7e) return keysym;
+	if(keysym >= XK_F1 && keysym <= XK_F12) return PLATFORM_KEY_F1 + (keysym - XK_F1);
+	switch(keysym) {
+		case XK_Escape:           return 27;
+		case XK_Return:
+		case XK_KP_Enter:         return '\r';
+		case XK_Tab:
+		case XK_ISO_Left_Tab:     return '\t';
+		case XK_BackSpace:        return 8;
+		case XK_Insert:           return PLATFORM_KEY_INSERT;
+		case XK_Delete:           return PLATFORM_KEY_DELETE;
+		case XK_Right:            return PLATFORM_KEY_RIGHT;
+		case XK_Left:             return PLATFORM_KEY_LEFT;
+		case XK_Down:             return PLATFORM_KEY_DOWN;
+		case XK_Up:               return PLATFORM_KEY_UP;
+		case XK_Prior:            return PLATFORM_KEY_PAGE_UP;
+		case XK_Next:             return PLATFORM_KEY_PAGE_DOWN;
+		case XK_Home:             return PLATFORM_KEY_HOME;
+		case XK_End:              return PLATFORM_KEY_END;
+		case XK_Caps_Lock:        return PLATFORM_KEY_CAPS_LOCK;
+		case XK_Shift_L:          return PLATFORM_KEY_LEFT_SHIFT;
+		case XK_Shift_R:          return PLATFORM_KEY_RIGHT_SHIFT;
+		case XK_Control_L:        return PLATFORM_KEY_LEFT_CONTROL;
+		case XK_Control_R:        return PLATFORM_KEY_RIGHT_CONTROL;
+		case XK_Alt_L:            return PLATFORM_KEY_LEFT_ALT;
+		case XK_Alt_R:
+		case XK_ISO_Level3_Shift: return PLATFORM_KEY_RIGHT_ALT;
+		case XK_Super_L:          return PLATFORM_KEY_LEFT_SUPER;
+		case XK_Super_R:          return PLATFORM_KEY_RIGHT_SUPER;
+	}
+	return PLATFORM_KEY_UNKNOWN;
+}
+
+uint32_t x11_translate_modifiers(const uint32_t state) {
+	// ShiftMask, ControlMask, Mod1Mask and Mod4Mask
+	uint32_t modifiers = 0;
+	if(state & (1 << 0)) modifiers |= PLATFORM_MOD_SHIFT;
+	if(state & (1 << 2)) modifiers |= PLATFORM_MOD_CONTROL;
+	if(state & (1 << 3)) modifiers |= PLATFORM_MOD_ALT;
+	if(state & (1 << 6)) modifiers |= PLATFORM_MOD_SUPER;
+	return modifiers;
+}
+
+void x11_translate_button(const uint8_t button, const int8_t press, const int32_t x, const int32_t y, const uint32_t state, platform_event_t* event) {
+	// the wheel is buttons 4 to 7, each step is a press and a release
+	if(button >= 4 && button <= 7) {
+		if(!press) return;
+		event->type = PLATFORM_EVENT_WHEEL;
+		event->wheel.x = button == 6 ? -1.0f : button == 7 ? 1.0f : 0.0f;
+		event->wheel.y = button == 4 ? 1.0f : button == 5 ? -1.0f : 0.0f;
+		return;
+	}
+
+	uint32_t platform_button;
+	switch(button) {
+		case 1: platform_button = PLATFORM_MOUSE_BUTTON_LEFT; break;
+		case 2: platform_button = PLATFORM_MOUSE_BUTTON_MIDDLE; break;
+		case 3: platform_button = PLATFORM_MOUSE_BUTTON_RIGHT; break;
+		case 8: platform_button = PLATFORM_MOUSE_BUTTON_BACK; break;
+		case 9: platform_button = PLATFORM_MOUSE_BUTTON_FORWARD; break;
+		default: return;
+	}
+	event->type = press ? PLATFORM_EVENT_MOUSE_DOWN : PLATFORM_EVENT_MOUSE_UP;
+	event->mouse_button.x = x;
+	event->mouse_button.y = y;
+	event->mouse_button.button = platform_button;
+	event->mouse_button.modifiers = x11_translate_modifiers(state);
+}
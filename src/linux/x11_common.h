@@ -0,0 +1,144 @@
+#ifndef X11_COMMON_H
+#define X11_COMMON_H
+
+#include "platform/platform.h"
+#include <stddef.h>
+
+// pieces shared by the xlib and xcb backends. X ids and atoms are 29 bit
+// values on the wire so they are kept as uint32_t here, 0 is None for both
+
+// window id to platform window, open addressed with linear probing, empty
+// slots have a handle of 0. the last lookup is remembered since events
+// usually come in runs for the same window
+typedef struct {
+	uint32_t           handle;
+	platform_window_t* window;
+} x11_window_entry_t;
+
+typedef struct {
+	x11_window_entry_t* entries;
+	uint32_t            mask;
+	uint32_t            count;
+	uint32_t            last_handle;
+	platform_window_t*  last_window;
+} x11_window_map_t;
+
+static inline uint32_t x11_window_slot(const uint32_t mask, const uint32_t handle) {
+	// ids come from the client's resource range with other resources in between,
+	// taking the top bits of the product spreads them evenly whatever the stride
+	return (handle * 2654435761u) >> (32 - __builtin_popcount(mask));
+}
+
+static inline platform_window_t* x11_window_map_find(x11_window_map_t* map, const uint32_t handle) {
+	if(handle == map->last_handle) return map->last_window;
+	uint32_t slot = x11_window_slot(map->mask, handle);
+	while(map->entries[slot].handle != 0) {
+		if(map->entries[slot].handle == handle) {
+			map->last_handle = handle;
+			map->last_window = map->entries[slot].window;
+			return map->last_window;
+		}
+		slot = (slot + 1) & map->mask;
+	}
+	return NULL;
+}
+
+int8_t x11_window_map_init(x11_window_map_t* map);
+void x11_window_map_free(x11_window_map_t* map);
+int8_t x11_window_map_insert(x11_window_map_t* map, const uint32_t handle, platform_window_t* window);
+void x11_window_map_remove(x11_window_map_t* map, const uint32_t handle);
+
+// _NET_SUPPORTED as an open addressed hash set, empty slots are 0
+typedef struct {
+	uint32_t* atoms;
+	uint32_t  mask;
+	uint32_t  count;
+} x11_atom_set_t;
+
+// sized for total atoms, kept at most half full
+int8_t x11_atom_set_init(x11_atom_set_t* set, const uint64_t total);
+void x11_atom_set_free(x11_atom_set_t* set);
+// returns 0 once the set is as full as it was sized for
+int8_t x11_atom_set_insert(x11_atom_set_t* set, const uint32_t atom);
+// the atom itself when it is in the set, 0 otherwise
+uint32_t x11_atom_set_find(const x11_atom_set_t* set, const uint32_t atom);
+
+// maps the server's 32 bit millisecond clock onto platform_get_timestamp
+typedef struct {
+	int64_t  offset; // platform_get_timestamp minus the server time in nanoseconds
+	uint64_t sync_ns;
+	uint64_t last_ms; // unwrapped
+	int8_t   synced;
+} x11_server_time_t;
+
+uint64_t x11_server_time_to_timestamp(x11_server_time_t* clock, const uint32_t time);
+
+// changes the app makes to a window are recorded here and sent together by the
+// next handle_events or flush, setting what the window already has drops the change.
+// until a ConfigureNotify answers a sent position or size, the cached window state
+// is out of date and the sent value is what the window already has
+#define X11_PENDING_POSITION 1
+#define X11_PENDING_SIZE     2
+#define X11_PENDING_NAME     4
+
+typedef struct {
+	uint32_t flags; // X11_PENDING_*
+	int32_t  x, y;
+	uint32_t width, height;
+	uint32_t in_flight; // X11_PENDING_POSITION and X11_PENDING_SIZE
+	int32_t  sent_x, sent_y;
+	uint32_t sent_width, sent_height;
+	uint32_t sent_serial; // of the last request that sent them, events carry the same low 32 bits
+	// the name the window should have, owned by the window. name_len
+	// is UINT32_MAX for no name at all
+	char*    name;
+	uint32_t name_len;
+	uint32_t name_capacity;
+	// in the backend's list of windows to flush
+	int8_t             queued;
+	platform_window_t* next;
+} x11_pending_t;
+
+void x11_pending_init(x11_pending_t* pending);
+void x11_pending_free(x11_pending_t* pending);
+// the current values are the cached window state
+void x11_pending_set_position(x11_pending_t* pending, const int32_t x, const int32_t y, const int32_t current_x, const int32_t current_y);
+void x11_pending_set_size(x11_pending_t* pending, const uint32_t width, const uint32_t height, const uint32_t current_width, const uint32_t current_height);
+void x11_pending_set_name(x11_pending_t* pending, const char* name);
+// after the position and size in flags went out, before flags are cleared
+void x11_pending_sent(x11_pending_t* pending, const uint32_t serial);
+// for every ConfigureNotify of the window, with the event's serial
+void x11_pending_configured(x11_pending_t* pending, const uint32_t serial);
+// NULL terminated name for the window system, NULL when the window has none
+static inline const char* x11_pending_name(const x11_pending_t* pending) {
+	return pending->name_len == UINT32_MAX ? NULL : pending->name;
+}
+void x11_pending_get_name(const x11_pending_t* pending, char* name, const uint32_t max_len);
+
+// real ConfigureNotify events of a window a reparenting window manager put into
+// its frame are relative to the frame. the root position of such a window is
+// queried once per batch of events, after the batch, no matter how many arrived
+typedef struct {
+	uint32_t handle;
+	uint32_t sequence; // of the query, the xcb backend sends it while adding
+	int32_t  x, y;
+	int8_t   answered;
+} x11_position_query_t;
+
+typedef struct {
+	x11_position_query_t* queries;
+	uint32_t              count;
+	uint32_t              capacity;
+} x11_position_queries_t;
+
+void x11_position_queries_free(x11_position_queries_t* queries);
+// returns NULL when the window is in the batch already or there is no memory
+x11_position_query_t* x11_position_queries_add(x11_position_queries_t* queries, const uint32_t handle);
+
+uint32_t x11_translate_keysym(const uint32_t keysym);
+uint32_t x11_translate_modifiers(const uint32_t state);
+// core button numbers, wheel steps become PLATFORM_EVENT_WHEEL. the event is
+// left as PLATFORM_EVENT_NONE for buttons that are ignored
+void x11_translate_button(const uint8_t button, const int8_t press, const int32_t x, const int32_t y, const uint32_t state, platform_event_t* event);
+
+#endif // X11_COMMON_H
@@ -0,0 +1,1042 @@
+#define _GNU_SOURCE
+#define VK_USE_PLATFORM_XCB_KHR
+#include "xcb_window.h"
+#include "common/pixel_kernels.h"
+#include <poll.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <stdint.h>
+
+// ICCCM size hint flags, WM_NORMAL_HINTS is 18 CARD32 starting with the flags
+#define SIZE_HINT_P_POSITION 4
+#define SIZE_HINT_P_MIN_SIZE 16
+#define SIZE_HINT_P_MAX_SIZE 32
+#define SIZE_HINTS_LENGTH    18
+
+// bytes of pixels per put_image request, fits the core protocol's request size
+// limit without big requests and holds a row of the widest window X allows
+#define PUT_IMAGE_CHUNK_SIZE (128 * 1024)
+
+typedef struct xcb_backend_window_t {
+	xcb_window_t handle;
+	uint32_t     active_flags;
+	void*        user_data;
+	// cached state, kept up to date by xcb_backend_handle_events so
+	// the getters never have to wait on the server
+	int32_t      x, y;
+	uint32_t     width, height;
+	int8_t       mapped;
+	int8_t       focused;
+	int8_t       should_close;
+	// inside the frame of a reparenting window manager, real ConfigureNotify
+	// positions are relative to the frame then
+	int8_t       reparented;
+	// set by refresh_window_state, the replies are collected by the next
+	// getter or by an event that happened after the queries
+	int8_t                             refresh_pending;
+	xcb_get_geometry_cookie_t          geometry_cookie;
+	xcb_get_window_attributes_cookie_t attributes_cookie;
+	xcb_get_input_focus_cookie_t       focus_cookie;
+	xcb_translate_coordinates_cookie_t position_cookie; // only asked for when reparented
+	int8_t                             position_requested;
+	// ResizeRequests are collected while handling events and
+	// only the last one for each window is applied afterwards
+	int8_t                        resize_requested;
+	uint32_t                      requested_width, requested_height;
+	struct xcb_backend_window_t*  next_resize_request;
+	// position, size and name set by the app, sent by the next
+	// handle_events or flush, only touched by the app's thread
+	x11_pending_t                 pending;
+	// created by the first get_framebuffer, rows without padding
+	uint32_t*                     framebuffer;
+	uint32_t                      framebuffer_width, framebuffer_height;
+} xcb_backend_window_t;
+
+static inline xcb_backend_window_t* backend_window(const platform_window_t* window) {
+	return (xcb_backend_window_t*)window;
+}
+
+// the same atoms as the xlib backend, every request is sent before the first reply is read
+static const struct {
+	const char* name;
+	size_t      offset;
+} context_atoms[] = {
+	{ "WM_PROTOCOLS",               offsetof(xcb_backend_context_t, wm_protocols) },
+	{ "WM_DELETE_WINDOW",           offsetof(xcb_backend_context_t, wm_delete_window) },
+	{ "_MOTIF_WM_HINTS",            offsetof(xcb_backend_context_t, motif_wm_hints) },
+	{ "_NET_WM_NAME",               offsetof(xcb_backend_context_t, net_wm_name) },
+	{ "_NET_WM_ICON_NAME",          offsetof(xcb_backend_context_t, net_wm_icon_name) },
+	{ "UTF8_STRING",                offsetof(xcb_backend_context_t, utf8_string) },
+	{ "_NET_SUPPORTED",             offsetof(xcb_backend_context_t, net_supported) },
+	{ "_NET_WM_WINDOW_TYPE",        offsetof(xcb_backend_context_t, net_wm_window_type) },
+	{ "_NET_WM_WINDOW_TYPE_SPLASH", offsetof(xcb_backend_context_t, net_wm_window_type_splash) },
+	{ "_NET_WM_WINDOW_TYPE_DIALOG", offsetof(xcb_backend_context_t, net_wm_window_type_dialog) },
+	{ "_NET_WM_WINDOW_TYPE_MENU",   offsetof(xcb_backend_context_t, net_wm_window_type_menu) },
+	{ "_NET_WM_ALLOWED_ACTIONS",    offsetof(xcb_backend_context_t, net_wm_allowed_actions) },
+	{ "_NET_WM_ACTION_RESIZE",      offsetof(xcb_backend_context_t, net_wm_action_resize) },
+};
+#define CONTEXT_ATOM_COUNT (sizeof(context_atoms) / sizeof(context_atoms[0]))
+
+// atoms of _NET_SUPPORTED per get_property request, the whole list fits in one on any real window manager
+#define SUPPORTED_ATOMS_PER_REQUEST 65536
+
+// the state lock is only needed when the event thread writes the cached state
+static inline void lock_state(xcb_backend_context_t* context) {
+	if(linux_platform_context.event_thread) mtx_lock(&context->lock);
+}
+static inline void unlock_state(xcb_backend_context_t* context) {
+	if(linux_platform_context.event_thread) mtx_unlock(&context->lock);
+}
+
+static void load_supported_atoms(xcb_backend_context_t* context) {
+	context->supported_atoms.atoms = NULL;
+	uint32_t offset = 0;
+	uint32_t bytes_after = 0;
+	do {
+		xcb_get_property_cookie_t cookie = xcb_get_property(context->connection, 0, context->screen->root, context->net_supported,
+		                                                    XCB_ATOM_ATOM, offset, SUPPORTED_ATOMS_PER_REQUEST);
+		xcb_get_property_reply_t* reply = xcb_get_property_reply(context->connection, cookie, NULL);
+		if(reply == NULL) break;
+		if(reply->type != XCB_ATOM_ATOM || reply->format != 32) {
+			free(reply);
+			break;
+		}
+		uint32_t count = xcb_get_property_value_length(reply) / 4;
+		bytes_after = reply->bytes_after;
+		if(context->supported_atoms.atoms == NULL && !x11_atom_set_init(&context->supported_atoms, count + bytes_after / 4)) {
+			free(reply);
+			break;
+		}
+		const xcb_atom_t* atoms = xcb_get_property_value(reply);
+		// the window manager could grow the list between requests, anything past the capacity is ignored
+		for(uint32_t i = 0; i < count && x11_atom_set_insert(&context->supported_atoms, atoms[i]); i++);
+		offset += count;
+		free(reply);
+	} while(bytes_after != 0);
+}
+
+static void load_keyboard_mapping(xcb_backend_context_t* context, xcb_get_keyboard_mapping_cookie_t cookie) {
+	xcb_get_keyboard_mapping_reply_t* reply = xcb_get_keyboard_mapping_reply(context->connection, cookie, NULL);
+	if(reply == NULL) return;
+	uint32_t count = xcb_get_keyboard_mapping_keysyms_length(reply);
+	xcb_keysym_t* keysyms = platform_allocator_alloc(count * sizeof(xcb_keysym_t) + 1, sizeof(xcb_keysym_t), NULL);
+	if(keysyms != NULL) {
+		memcpy(keysyms, xcb_get_keyboard_mapping_keysyms(reply), count * sizeof(xcb_keysym_t));
+		if(context->keysyms != NULL) platform_allocator_free(context->keysyms, NULL);
+		context->keysyms = keysyms;
+		context->keysym_count = count;
+		context->keysyms_per_keycode = reply->keysyms_per_keycode;
+	}
+	free(reply);
+}
+
+static inline xcb_get_keyboard_mapping_cookie_t request_keyboard_mapping(xcb_backend_context_t* context) {
+	const xcb_setup_t* setup = xcb_get_setup(context->connection);
+	context->min_keycode = setup->min_keycode;
+	return xcb_get_keyboard_mapping(context->connection, setup->min_keycode, setup->max_keycode - setup->min_keycode + 1);
+}
+
+// only visuals that take 0x00RRGGBB as it is
+static int8_t framebuffer_supported(const xcb_screen_t* screen) {
+	if(screen->root_depth != 24 && screen->root_depth != 32) return 0;
+	for(xcb_depth_iterator_t depths = xcb_screen_allowed_depths_iterator(screen); depths.rem; xcb_depth_next(&depths)) {
+		if(depths.data->depth != screen->root_depth) continue;
+		for(xcb_visualtype_iterator_t visuals = xcb_depth_visuals_iterator(depths.data); visuals.rem; xcb_visualtype_next(&visuals)) {
+			if(visuals.data->visual_id != screen->root_visual) continue;
+			return visuals.data->red_mask == 0xff0000 && visuals.data->green_mask == 0xff00 && visuals.data->blue_mask == 0xff;
+		}
+	}
+	return 0;
+}
+
+int8_t xcb_backend_init_context(xcb_backend_context_t* context) {
+	int screen_number = 0;
+	context->connection = xcb_connect(NULL, &screen_number);
+	if(xcb_connection_has_error(context->connection)) {
+		xcb_disconnect(context->connection);
+		context->connection = NULL;
+		return 0;
+	}
+	xcb_screen_iterator_t screens = xcb_setup_roots_iterator(xcb_get_setup(context->connection));
+	for(int i = 0; i < screen_number && screens.rem > 1; i++) xcb_screen_next(&screens);
+	context->screen = screens.data;
+
+	if(!x11_window_map_init(&context->windows)) {
+		xcb_disconnect(context->connection);
+		context->connection = NULL;
+		return 0;
+	}
+	mtx_init(&context->lock, mtx_plain);
+	context->keysyms = NULL;
+	context->keysym_count = 0;
+	context->keysyms_per_keycode = 0;
+	context->lookahead = NULL;
+	memset(context->keys_down, 0, sizeof(context->keys_down));
+	context->focused_window = NULL;
+	context->server_time.synced = 0;
+
+	// everything independent goes out before waiting on anything
+	xcb_intern_atom_cookie_t cookies[CONTEXT_ATOM_COUNT];
+	for(uint32_t i = 0; i < CONTEXT_ATOM_COUNT; i++) {
+		cookies[i] = xcb_intern_atom(context->connection, 0, strlen(context_atoms[i].name), context_atoms[i].name);
+	}
+	xcb_get_keyboard_mapping_cookie_t keyboard_cookie = request_keyboard_mapping(context);
+	for(uint32_t i = 0; i < CONTEXT_ATOM_COUNT; i++) {
+		xcb_intern_atom_reply_t* reply = xcb_intern_atom_reply(context->connection, cookies[i], NULL);
+		*(xcb_atom_t*)((uint8_t*)context + context_atoms[i].offset) = reply != NULL ? reply->atom : XCB_ATOM_NONE;
+		free(reply);
+	}
+	load_keyboard_mapping(context, keyboard_cookie);
+
+	load_supported_atoms(context);
+	context->framebuffer_supported = framebuffer_supported(context->screen);
+	context->gc = 0;
+	context->scratch = NULL;
+	context->pending_windows = NULL;
+	memset(&context->position_queries, 0, sizeof(context->position_queries));
+	context->net_wm_window_type = x11_atom_set_find(&context->supported_atoms, context->net_wm_window_type);
+	context->net_wm_window_type_splash = x11_atom_set_find(&context->supported_atoms, context->net_wm_window_type_splash);
+	context->net_wm_window_type_dialog = x11_atom_set_find(&context->supported_atoms, context->net_wm_window_type_dialog);
+	context->net_wm_window_type_menu = x11_atom_set_find(&context->supported_atoms, context->net_wm_window_type_menu);
+	context->net_wm_allowed_actions = x11_atom_set_find(&context->supported_atoms, context->net_wm_allowed_actions);
+	return 1;
+}
+void xcb_backend_cleanup_context(xcb_backend_context_t* context) {
+	free(context->lookahead);
+	context->lookahead = NULL;
+	if(context->keysyms != NULL) platform_allocator_free(context->keysyms, NULL);
+	context->keysyms = NULL;
+	if(context->scratch != NULL) platform_allocator_free(context->scratch, NULL);
+	context->scratch = NULL;
+	x11_atom_set_free(&context->supported_atoms);
+	x11_window_map_free(&context->windows);
+	x11_position_queries_free(&context->position_queries);
+	mtx_destroy(&context->lock);
+	xcb_disconnect(context->connection);
+	context->connection = NULL;
+}
+
+static void queue_pending(xcb_backend_context_t* context, xcb_backend_window_t* window) {
+	if(window->pending.flags == 0 || window->pending.queued) return;
+	window->pending.queued = 1;
+	window->pending.next = context->pending_windows;
+	context->pending_windows = (platform_window_t*)window;
+}
+static void unqueue_pending(xcb_backend_context_t* context, xcb_backend_window_t* window) {
+	if(!window->pending.queued) return;
+	platform_window_t** link = &context->pending_windows;
+	while(*link != (platform_window_t*)window) link = &backend_window(*link)->pending.next;
+	*link = window->pending.next;
+	window->pending.queued = 0;
+	window->pending.next = NULL;
+}
+
+// the window manager would otherwise get to decide on the size
+// returns the sequence number of the resize
+static uint32_t send_window_size(xcb_backend_context_t* context, const xcb_window_t handle, const uint32_t width, const uint32_t height) {
+	uint32_t override_redirect = 1;
+	xcb_change_window_attributes(context->connection, handle, XCB_CW_OVERRIDE_REDIRECT, &override_redirect);
+	const uint32_t values[2] = { width, height };
+	xcb_void_cookie_t cookie = xcb_configure_window(context->connection, handle, XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT, values);
+	override_redirect = 0;
+	xcb_change_window_attributes(context->connection, handle, XCB_CW_OVERRIDE_REDIRECT, &override_redirect);
+	return cookie.sequence;
+}
+static void send_window_name(xcb_backend_context_t* context, const xcb_backend_window_t* window) {
+	const char* name = x11_pending_name(&window->pending);
+	if(name == NULL) {
+		xcb_delete_property(context->connection, window->handle, context->net_wm_name);
+		xcb_delete_property(context->connection, window->handle, XCB_ATOM_WM_NAME);
+		return;
+	}
+	uint32_t len = window->pending.name_len;
+	xcb_change_property(context->connection, XCB_PROP_MODE_REPLACE, window->handle, context->net_wm_name,
+	                    context->utf8_string, 8, len, name);
+	xcb_change_property(context->connection, XCB_PROP_MODE_REPLACE, window->handle, XCB_ATOM_WM_NAME,
+	                    XCB_ATOM_STRING, 8, len, name);
+	xcb_change_property(context->connection, XCB_PROP_MODE_REPLACE, window->handle, XCB_ATOM_WM_ICON_NAME,
+	                    XCB_ATOM_STRING, 8, len, name);
+	xcb_change_property(context->connection, XCB_PROP_MODE_REPLACE, window->handle, context->net_wm_icon_name,
+	                    context->utf8_string, 8, len, name);
+}
+// everything the app changed since the last flush, in one go
+static void send_pending(xcb_backend_context_t* context) {
+	while(context->pending_windows != NULL) {
+		xcb_backend_window_t* window = backend_window(context->pending_windows);
+		x11_pending_t* pending = &window->pending;
+		context->pending_windows = pending->next;
+		// the event thread reads what was sent when the ConfigureNotify comes
+		lock_state(context);
+		uint32_t sequence = 0;
+		if(pending->flags & X11_PENDING_POSITION) {
+			const uint32_t values[2] = { (uint32_t)pending->x, (uint32_t)pending->y };
+			sequence = xcb_configure_window(context->connection, window->handle, XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y, values).sequence;
+		}
+		if(pending->flags & X11_PENDING_SIZE) sequence = send_window_size(context, window->handle, pending->width, pending->height);
+		if(pending->flags & X11_PENDING_NAME) send_window_name(context, window);
+		x11_pending_sent(pending, sequence);
+		unlock_state(context);
+		pending->flags = 0;
+		pending->queued = 0;
+		pending->next = NULL;
+	}
+}
+
+static void set_size_hints(xcb_backend_context_t* context, const xcb_backend_window_t* window, const int8_t fixed_size) {
+	uint32_t hints[SIZE_HINTS_LENGTH] = {0};
+	hints[0] = SIZE_HINT_P_POSITION;
+	hints[1] = window->x;
+	hints[2] = window->y;
+	if(fixed_size) {
+		hints[0] |= SIZE_HINT_P_MIN_SIZE | SIZE_HINT_P_MAX_SIZE;
+		hints[5] = hints[7] = window->width;
+		hints[6] = hints[8] = window->height;
+	}
+	xcb_change_property(context->connection, XCB_PROP_MODE_REPLACE, window->handle, XCB_ATOM_WM_NORMAL_HINTS,
+	                    XCB_ATOM_WM_SIZE_HINTS, 32, SIZE_HINTS_LENGTH, hints);
+}
+
+static inline void set_window_type(xcb_backend_context_t* context, const xcb_window_t handle, const xcb_atom_t type) {
+	xcb_change_property(context->connection, XCB_PROP_MODE_REPLACE, handle, context->net_wm_window_type, XCB_ATOM_ATOM, 32, 1, &type);
+}
+
+static inline void remove_border(xcb_backend_context_t* context, const xcb_window_t handle) {
+	// flags, functions, decorations, input mode, status, only the decorations are set
+	const uint32_t hints[5] = { 2, 0, 0, 0, 0 };
+	xcb_change_property(context->connection, XCB_PROP_MODE_REPLACE, handle, context->motif_wm_hints, context->motif_wm_hints, 32, 5, hints);
+}
+
+platform_window_t* xcb_backend_create_window(const platform_window_create_info_t create_info, platform_allocation_callbacks_t* allocator) {
+	xcb_backend_context_t* context = &linux_platform_context.xcb;
+	xcb_window_t parent_handle = create_info.parent != NULL ? backend_window(create_info.parent)->handle : context->screen->root;
+
+	// no request here has a reply, none of them wait on the server
+	xcb_window_t handle = xcb_generate_id(context->connection);
+	const uint32_t values[2] = {
+		context->screen->black_pixel,
+		XCB_EVENT_MASK_STRUCTURE_NOTIFY | XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY |
+		XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT | XCB_EVENT_MASK_RESIZE_REDIRECT |
+		XCB_EVENT_MASK_EXPOSURE | XCB_EVENT_MASK_PROPERTY_CHANGE | XCB_EVENT_MASK_FOCUS_CHANGE |
+		XCB_EVENT_MASK_POINTER_MOTION | XCB_EVENT_MASK_KEY_PRESS | XCB_EVENT_MASK_KEY_RELEASE |
+		XCB_EVENT_MASK_BUTTON_PRESS | XCB_EVENT_MASK_BUTTON_RELEASE
+	};
+	xcb_create_window(context->connection, XCB_COPY_FROM_PARENT, handle, parent_handle, create_info.x, create_info.y,
+	                  create_info.width, create_info.height, 0, XCB_WINDOW_CLASS_INPUT_OUTPUT, context->screen->root_visual,
+	                  XCB_CW_BACK_PIXEL | XCB_CW_EVENT_MASK, values);
+
+	xcb_change_property(context->connection, XCB_PROP_MODE_REPLACE, handle, context->wm_protocols, XCB_ATOM_ATOM, 32,
+	                    1, &context->wm_delete_window);
+
+	if(create_info.flags & PLATFORM_WF_NO_BORDER && create_info.parent == NULL) {
+		// NOTE: same as the xlib backend, no floating window is forced on tiling window managers
+		if(context->motif_wm_hints != XCB_ATOM_NONE) remove_border(context, handle);
+	}
+
+	if(create_info.flags & PLATFORM_WF_DIALOG && context->net_wm_window_type_dialog != XCB_ATOM_NONE) {
+		set_window_type(context, handle, context->net_wm_window_type_dialog);
+	}
+	if(create_info.flags & PLATFORM_WF_DIALOG && create_info.parent != NULL) {
+		xcb_change_property(context->connection, XCB_PROP_MODE_REPLACE, handle, XCB_ATOM_WM_TRANSIENT_FOR, XCB_ATOM_WINDOW, 32,
+		                    1, &parent_handle);
+	}
+
+	if((create_info.flags & PLATFORM_WF_SPLASH) != 0) {
+		if(context->net_wm_window_type_splash != XCB_ATOM_NONE) {
+			set_window_type(context, handle, context->net_wm_window_type_splash);
+		}
+		else if(context->net_wm_window_type_menu != XCB_ATOM_NONE) {
+			set_window_type(context, handle, context->net_wm_window_type_menu);
+		}
+		else if(context->net_wm_window_type_dialog != XCB_ATOM_NONE) {
+			set_window_type(context, handle, context->net_wm_window_type_dialog);
+			if((create_info.flags & PLATFORM_WF_NO_BORDER) == 0) remove_border(context, handle);
+		}
+		else {
+			const uint32_t override_redirect = 1;
+			xcb_change_window_attributes(context->connection, handle, XCB_CW_OVERRIDE_REDIRECT, &override_redirect);
+		}
+	}
+
+	if(create_info.flags & PLATFORM_WF_RESIZABLE && context->net_wm_allowed_actions != XCB_ATOM_NONE) {
+		xcb_change_property(context->connection, XCB_PROP_MODE_APPEND, handle, context->net_wm_allowed_actions, XCB_ATOM_ATOM, 32,
+		                    1, &context->net_wm_action_resize);
+	}
+
+	xcb_backend_window_t* window = platform_allocator_alloc(sizeof(xcb_backend_window_t), sizeof(void*), allocator);
+	window->handle = handle;
+	window->active_flags = create_info.flags;
+	window->user_data = NULL;
+	window->x = create_info.x;
+	window->y = create_info.y;
+	window->width = create_info.width;
+	window->height = create_info.height;
+	window->mapped = 0;
+	window->focused = 0;
+	window->should_close = 0;
+	window->reparented = 0;
+	window->refresh_pending = 0;
+	window->resize_requested = 0;
+	window->next_resize_request = NULL;
+	window->framebuffer = NULL;
+	set_size_hints(context, window, 0);
+	// the name has to be there before the window is mapped
+	x11_pending_init(&window->pending);
+	x11_pending_set_name(&window->pending, create_info.name);
+	send_window_name(context, window);
+	window->pending.flags = 0;
+
+	lock_state(context);
+	int8_t inserted = x11_window_map_insert(&context->windows, handle, (platform_window_t*)window);
+	unlock_state(context);
+	if(!inserted) {
+		xcb_destroy_window(context->connection, handle);
+		x11_pending_free(&window->pending);
+		platform_allocator_free(window, allocator);
+		return NULL;
+	}
+	if((create_info.flags & PLATFORM_WF_UNMAPPED) == 0) xcb_backend_map_window((platform_window_t*)window);
+	return (platform_window_t*)window;
+}
+
+static void discard_refresh(xcb_backend_context_t* context, xcb_backend_window_t* window) {
+	if(!window->refresh_pending) return;
+	window->refresh_pending = 0;
+	xcb_discard_reply(context->connection, window->geometry_cookie.sequence);
+	xcb_discard_reply(context->connection, window->attributes_cookie.sequence);
+	xcb_discard_reply(context->connection, window->focus_cookie.sequence);
+	if(window->position_requested) xcb_discard_reply(context->connection, window->position_cookie.sequence);
+}
+
+void xcb_backend_destroy_window(platform_window_t* platform_window, platform_allocation_callbacks_t* allocator) {
+	xcb_backend_context_t* context = &linux_platform_context.xcb;
+	xcb_backend_window_t* window = backend_window(platform_window);
+	unqueue_pending(context, window);
+	x11_pending_free(&window->pending);
+	lock_state(context);
+	x11_window_map_remove(&context->windows, window->handle);
+	event_queue_remove_window(&linux_platform_context.events, platform_window);
+	if(context->focused_window == platform_window) context->focused_window = NULL;
+	discard_refresh(context, window);
+	unlock_state(context);
+	// nothing new can be published for the window once it left the map
+	if(linux_platform_context.event_thread) event_ring_remove_window(&linux_platform_context.ring, platform_window);
+	xcb_destroy_window(context->connection, window->handle);
+	if(window->framebuffer != NULL) platform_allocator_free(window->framebuffer, NULL);
+	platform_allocator_free(window, allocator);
+	xcb_flush(context->connection);
+}
+
+// waits for the replies asked for by refresh_window_state, has to be called with the state locked
+static void collect_refresh(xcb_backend_context_t* context, xcb_backend_window_t* window) {
+	if(!window->refresh_pending) return;
+	window->refresh_pending = 0;
+	xcb_get_geometry_reply_t* geometry = xcb_get_geometry_reply(context->connection, window->geometry_cookie, NULL);
+	xcb_get_window_attributes_reply_t* attributes = xcb_get_window_attributes_reply(context->connection, window->attributes_cookie, NULL);
+	xcb_get_input_focus_reply_t* focus = xcb_get_input_focus_reply(context->connection, window->focus_cookie, NULL);
+	xcb_translate_coordinates_reply_t* position = NULL;
+	if(window->position_requested) position = xcb_translate_coordinates_reply(context->connection, window->position_cookie, NULL);
+	if(position != NULL) {
+		window->x = position->dst_x;
+		window->y = position->dst_y;
+	}
+	else if(geometry != NULL && !window->position_requested) {
+		window->x = geometry->x;
+		window->y = geometry->y;
+	}
+	if(geometry != NULL) {
+		window->width = geometry->width;
+		window->height = geometry->height;
+	}
+	if(attributes != NULL) window->mapped = attributes->map_state != XCB_MAP_STATE_UNMAPPED;
+	if(focus != NULL) window->focused = focus->focus == window->handle;
+	free(geometry);
+	free(attributes);
+	free(focus);
+	free(position);
+}
+
+void xcb_backend_get_window_position(const platform_window_t* platform_window, int32_t* x, int32_t* y) {
+	xcb_backend_context_t* context = &linux_platform_context.xcb;
+	xcb_backend_window_t* window = backend_window(platform_window);
+	lock_state(context);
+	collect_refresh(context, window);
+	if(x) *x = window->x;
+	if(y) *y = window->y;
+	unlock_state(context);
+}
+void xcb_backend_get_window_size(const platform_window_t* platform_window, uint32_t* width, uint32_t* height) {
+	xcb_backend_context_t* context = &linux_platform_context.xcb;
+	xcb_backend_window_t* window = backend_window(platform_window);
+	lock_state(context);
+	collect_refresh(context, window);
+	if(width) *width = window->width;
+	if(height) *height = window->height;
+	unlock_state(context);
+}
+void xcb_backend_refresh_window_state(platform_window_t* platform_window) {
+	xcb_backend_context_t* context = &linux_platform_context.xcb;
+	xcb_backend_window_t* window = backend_window(platform_window);
+	lock_state(context);
+	discard_refresh(context, window);
+	window->geometry_cookie = xcb_get_geometry(context->connection, window->handle);
+	window->attributes_cookie = xcb_get_window_attributes(context->connection, window->handle);
+	window->focus_cookie = xcb_get_input_focus(context->connection);
+	// the geometry is relative to the parent, which is the frame of a reparenting window manager
+	window->position_requested = window->reparented;
+	if(window->reparented) {
+		window->position_cookie = xcb_translate_coordinates(context->connection, window->handle, context->screen->root, 0, 0);
+	}
+	window->refresh_pending = 1;
+	unlock_state(context);
+	xcb_flush(context->connection);
+}
+void xcb_backend_set_window_position(platform_window_t* platform_window, const int32_t x, const int32_t y) {
+	xcb_backend_context_t* context = &linux_platform_context.xcb;
+	xcb_backend_window_t* window = backend_window(platform_window);
+	lock_state(context);
+	x11_pending_set_position(&window->pending, x, y, window->x, window->y);
+	unlock_state(context);
+	queue_pending(context, window);
+}
+void xcb_backend_set_window_size(platform_window_t* platform_window, const uint32_t width, const uint32_t height) {
+	xcb_backend_context_t* context = &linux_platform_context.xcb;
+	xcb_backend_window_t* window = backend_window(platform_window);
+	lock_state(context);
+	x11_pending_set_size(&window->pending, width, height, window->width, window->height);
+	unlock_state(context);
+	queue_pending(context, window);
+}
+// the name is only ever set by the app, so the one it asked for is the one the window has
+void xcb_backend_get_window_name(const platform_window_t* window, char* name, uint32_t max_len) {
+	x11_pending_get_name(&backend_window(window)->pending, name, max_len);
+}
+void xcb_backend_set_window_name(platform_window_t* window, const char* name) {
+	x11_pending_set_name(&backend_window(window)->pending, name);
+	queue_pending(&linux_platform_context.xcb, backend_window(window));
+}
+void xcb_backend_flush(void) {
+	xcb_backend_context_t* context = &linux_platform_context.xcb;
+	send_pending(context);
+	xcb_flush(context->connection);
+}
+
+void xcb_backend_map_window(platform_window_t* window) {
+	xcb_connection_t* connection = linux_platform_context.xcb.connection;
+	// so the window shows up where and how it was asked for
+	send_pending(&linux_platform_context.xcb);
+	xcb_window_t handle = backend_window(window)->handle;
+	// XMapRaised
+	const uint32_t stack_mode = XCB_STACK_MODE_ABOVE;
+	xcb_configure_window(connection, handle, XCB_CONFIG_WINDOW_STACK_MODE, &stack_mode);
+	xcb_map_window(connection, handle);
+}
+void xcb_backend_unmap_window(platform_window_t* window) {
+	xcb_unmap_window(linux_platform_context.xcb.connection, backend_window(window)->handle);
+}
+
+int8_t xcb_backend_window_is_mapped(const platform_window_t* platform_window) {
+	xcb_backend_context_t* context = &linux_platform_context.xcb;
+	xcb_backend_window_t* window = backend_window(platform_window);
+	lock_state(context);
+	collect_refresh(context, window);
+	int8_t mapped = window->mapped;
+	unlock_state(context);
+	return mapped;
+}
+int8_t xcb_backend_window_has_focus(const platform_window_t* platform_window) {
+	xcb_backend_context_t* context = &linux_platform_context.xcb;
+	xcb_backend_window_t* window = backend_window(platform_window);
+	lock_state(context);
+	collect_refresh(context, window);
+	int8_t focused = window->focused;
+	unlock_state(context);
+	return focused;
+}
+
+int8_t xcb_backend_window_should_close(const platform_window_t* platform_window) {
+	xcb_backend_context_t* context = &linux_platform_context.xcb;
+	lock_state(context);
+	int8_t should_close = backend_window(platform_window)->should_close;
+	unlock_state(context);
+	return should_close;
+}
+
+// NOTE: there is no MIT-SHM here, every present copies the damaged pixels into the connection
+int8_t xcb_backend_window_get_framebuffer(platform_window_t* platform_window, platform_framebuffer_t* framebuffer) {
+	xcb_backend_context_t* context = &linux_platform_context.xcb;
+	xcb_backend_window_t* window = backend_window(platform_window);
+	if(!context->framebuffer_supported) return 0;
+	uint32_t width, height;
+	xcb_backend_get_window_size(platform_window, &width, &height);
+	if(window->framebuffer == NULL || window->framebuffer_width != width || window->framebuffer_height != height) {
+		if(window->framebuffer != NULL) platform_allocator_free(window->framebuffer, NULL);
+		uint64_t size = ((uint64_t)width * height * sizeof(uint32_t) + 63) & ~(uint64_t)63;
+		window->framebuffer = size != 0 ? platform_allocator_alloc(size, 64, NULL) : NULL;
+		if(window->framebuffer == NULL) return 0;
+		memset(window->framebuffer, 0, size);
+		window->framebuffer_width = width;
+		window->framebuffer_height = height;
+	}
+	framebuffer->pixels = window->framebuffer;
+	framebuffer->width = width;
+	framebuffer->height = height;
+	framebuffer->stride = width;
+	return 1;
+}
+
+static void put_rect(xcb_backend_context_t* context, const xcb_backend_window_t* window, const uint32_t x, uint32_t y,
+                     const uint32_t width, const uint32_t height) {
+	uint32_t rows_per_request = PUT_IMAGE_CHUNK_SIZE / (width * sizeof(uint32_t));
+	uint32_t end = y + height;
+	while(y < end) {
+		uint32_t rows = end - y < rows_per_request ? end - y : rows_per_request;
+		const uint32_t* pixels = window->framebuffer + (uint64_t)y * window->framebuffer_width + x;
+		// whole rows are already laid out the way put_image wants them
+		if(width != window->framebuffer_width) {
+			pixel_copy_rect(context->scratch, width, pixels, window->framebuffer_width, width, rows);
+			pixels = context->scratch;
+		}
+		xcb_put_image(context->connection, XCB_IMAGE_FORMAT_Z_PIXMAP, window->handle, context->gc, width, rows, x, y, 0,
+		              context->screen->root_depth, rows * width * sizeof(uint32_t), (const uint8_t*)pixels);
+		y += rows;
+	}
+}
+
+void xcb_backend_window_present(platform_window_t* platform_window, const platform_rect_t* damage, const uint32_t damage_count) {
+	xcb_backend_context_t* context = &linux_platform_context.xcb;
+	xcb_backend_window_t* window = backend_window(platform_window);
+	if(window->framebuffer == NULL) return;
+	if(context->gc == 0) {
+		context->gc = xcb_generate_id(context->connection);
+		xcb_create_gc(context->connection, context->gc, context->screen->root, 0, NULL);
+	}
+	if(context->scratch == NULL) {
+		context->scratch = platform_allocator_alloc(PUT_IMAGE_CHUNK_SIZE, 64, NULL);
+		if(context->scratch == NULL) return;
+	}
+	platform_rect_t whole = { 0, 0, window->framebuffer_width, window->framebuffer_height };
+	uint32_t count = damage_count;
+	if(count == 0) {
+		damage = &whole;
+		count = 1;
+	}
+	for(uint32_t i = 0; i < count; i++) {
+		int64_t x0 = damage[i].x > 0 ? damage[i].x : 0;
+		int64_t y0 = damage[i].y > 0 ? damage[i].y : 0;
+		int64_t x1 = (int64_t)damage[i].x + damage[i].width;
+		int64_t y1 = (int64_t)damage[i].y + damage[i].height;
+		if(x1 > window->framebuffer_width) x1 = window->framebuffer_width;
+		if(y1 > window->framebuffer_height) y1 = window->framebuffer_height;
+		if(x0 >= x1 || y0 >= y1) continue;
+		put_rect(context, window, x0, y0, x1 - x0, y1 - y0);
+	}
+	xcb_flush(context->connection);
+}
+
+// the xcb backend does not link xcb-randr, so the whole screen is reported as
+// one monitor without a refresh rate. the xlib backend has the real layout
+uint32_t xcb_backend_get_monitors(platform_monitor_t* monitors, const uint32_t max_count) {
+	const xcb_screen_t* screen = linux_platform_context.xcb.screen;
+	if(max_count == 0) return 0;
+	memset(monitors, 0, sizeof(*monitors));
+	strcpy(monitors->name, "screen");
+	monitors->width = screen->width_in_pixels;
+	monitors->height = screen->height_in_pixels;
+	if(screen->width_in_millimeters != 0) {
+		monitors->dpi = (uint32_t)(screen->width_in_pixels * 25.4 / screen->width_in_millimeters + 0.5);
+	}
+	monitors->primary = 1;
+	return 1;
+}
+
+char** xcb_backend_vulkan_required_extensions(uint32_t* extension_count) {
+	*extension_count = 2;
+	static char* extensions[] = {
+		"VK_KHR_surface",
+		"VK_KHR_xcb_surface"
+	};
+	return extensions;
+}
+
+VkSurfaceKHR xcb_backend_vulkan_create_surface(platform_window_t* window, VkInstance instance) {
+	VkSurfaceKHR surface;
+	VkXcbSurfaceCreateInfoKHR create_info = {
+		VK_STRUCTURE_TYPE_XCB_SURFACE_CREATE_INFO_KHR,
+		NULL,
+		0,
+		linux_platform_context.xcb.connection,
+		backend_window(window)->handle
+	};
+	VkResult surface_result = vkCreateXcbSurfaceKHR(instance, &create_info, NULL, &surface);
+	if(surface_result != VK_SUCCESS) return NULL;
+	return surface;
+}
+
+xcb_window_t xcb_backend_get_window_handle(const platform_window_t* window) {
+	return backend_window(window)->handle;
+}
+
+// the next event in order, the read ahead one comes first. only reads the connection when allowed to
+static inline xcb_generic_event_t* next_event(xcb_backend_context_t* context, const int8_t read) {
+	if(context->lookahead != NULL) {
+		xcb_generic_event_t* e = context->lookahead;
+		context->lookahead = NULL;
+		return e;
+	}
+	return read ? xcb_poll_for_event(context->connection) : xcb_poll_for_queued_event(context->connection);
+}
+
+// without XKB's detectable auto repeat a held key sends a release and a press
+// with the same time, the release is dropped when the press is already there
+static int8_t is_auto_repeat(xcb_backend_context_t* context, const xcb_key_release_event_t* release) {
+	if(context->lookahead == NULL) context->lookahead = xcb_poll_for_event(context->connection);
+	const xcb_key_press_event_t* next = (const xcb_key_press_event_t*)context->lookahead;
+	return next != NULL && (next->response_type & ~0x80) == XCB_KEY_PRESS &&
+	       next->detail == release->detail && next->time == release->time;
+}
+
+static void translate_key(xcb_backend_context_t* context, const xcb_key_press_event_t* e, const int8_t press, platform_event_t* event) {
+	uint8_t bit = 1 << (e->detail & 7);
+	uint8_t* down = &context->keys_down[(e->detail >> 3) & 31];
+	if(press) {
+		event->type = PLATFORM_EVENT_KEY_DOWN;
+		event->key.repeat = (*down & bit) != 0;
+		*down |= bit;
+	}
+	else {
+		event->type = PLATFORM_EVENT_KEY_UP;
+		event->key.repeat = 0;
+		*down &= ~bit;
+	}
+	// the first column is the unshifted symbol, like XLookupKeysym(e, 0)
+	uint32_t index = (uint32_t)(e->detail - context->min_keycode) * context->keysyms_per_keycode;
+	uint32_t keysym = e->detail >= context->min_keycode && index < context->keysym_count ? context->keysyms[index] : 0;
+	event->key.key = x11_translate_keysym(keysym);
+	// X keycodes are evdev codes offset by 8
+	event->key.scancode = e->detail >= 8 ? e->detail - 8 : 0;
+	event->key.modifiers = x11_translate_modifiers(e->state);
+	event->timestamp = x11_server_time_to_timestamp(&context->server_time, e->time);
+}
+
+// the window an event is looked up by, 0 for events without one
+static xcb_window_t event_window(const xcb_generic_event_t* e) {
+	switch(e->response_type & ~0x80) {
+	case XCB_KEY_PRESS:
+	case XCB_KEY_RELEASE:
+	case XCB_BUTTON_PRESS:
+	case XCB_BUTTON_RELEASE:
+	case XCB_MOTION_NOTIFY:
+		return ((const xcb_key_press_event_t*)e)->event;
+	case XCB_FOCUS_IN:
+	case XCB_FOCUS_OUT:
+		return ((const xcb_focus_in_event_t*)e)->event;
+	case XCB_MAP_NOTIFY:
+		return ((const xcb_map_notify_event_t*)e)->event;
+	case XCB_UNMAP_NOTIFY:
+		return ((const xcb_unmap_notify_event_t*)e)->event;
+	case XCB_CONFIGURE_NOTIFY:
+		return ((const xcb_configure_notify_event_t*)e)->event;
+	case XCB_REPARENT_NOTIFY:
+		return ((const xcb_reparent_notify_event_t*)e)->event;
+	case XCB_EXPOSE:
+		return ((const xcb_expose_event_t*)e)->window;
+	case XCB_RESIZE_REQUEST:
+		return ((const xcb_resize_request_event_t*)e)->window;
+	case XCB_CLIENT_MESSAGE:
+		return ((const xcb_client_message_event_t*)e)->window;
+	default:
+		return 0;
+	}
+}
+
+static void update_position(xcb_backend_window_t* window, const int32_t x, const int32_t y, const uint64_t timestamp) {
+	if(x == window->x && y == window->y) return;
+	window->x = x;
+	window->y = y;
+	platform_event_t event = {0};
+	event.type = PLATFORM_EVENT_MOVE;
+	event.window = (platform_window_t*)window;
+	event.timestamp = timestamp;
+	event.move.x = x;
+	event.move.y = y;
+	event_queue_push(&linux_platform_context.events, &event);
+}
+
+static void handle_event(xcb_backend_context_t* context, xcb_generic_event_t* e, const uint64_t timestamp, xcb_backend_window_t** resize_requests) {
+	event_queue_t* queue = &linux_platform_context.events;
+	uint8_t type = e->response_type & ~0x80;
+	if(type == 0) {
+		const xcb_generic_error_t* error = (const xcb_generic_error_t*)e;
+		platform_log(PLATFORM_LOG_LEVEL_WARN, "X error %u for request %u.%u", error->error_code, error->major_code, error->minor_code);
+		return;
+	}
+	if(type == XCB_MAPPING_NOTIFY) {
+		if(((const xcb_mapping_notify_event_t*)e)->request == XCB_MAPPING_KEYBOARD) {
+			load_keyboard_mapping(context, request_keyboard_mapping(context));
+		}
+		return;
+	}
+	xcb_backend_window_t* window = (xcb_backend_window_t*)x11_window_map_find(&context->windows, event_window(e));
+	if(window == NULL) return;
+	// a state query sent before this event happened is older than the event
+	if(window->refresh_pending && (int32_t)(e->full_sequence - window->geometry_cookie.sequence) >= 0) {
+		collect_refresh(context, window);
+	}
+
+	platform_event_t event = {0};
+	event.window = (platform_window_t*)window;
+	event.timestamp = timestamp;
+	switch(type) {
+	case XCB_CLIENT_MESSAGE: {
+		const xcb_client_message_event_t* message = (const xcb_client_message_event_t*)e;
+		if(message->format == 32 && message->data.data32[0] == context->wm_delete_window) {
+			window->should_close = 1;
+			event.type = PLATFORM_EVENT_CLOSE;
+		}
+		break;
+	}
+	case XCB_RESIZE_REQUEST: {
+		const xcb_resize_request_event_t* request = (const xcb_resize_request_event_t*)e;
+		if(!window->resize_requested) {
+			window->resize_requested = 1;
+			window->next_resize_request = *resize_requests;
+			*resize_requests = window;
+		}
+		window->requested_width = request->width;
+		window->requested_height = request->height;
+		break;
+	}
+	case XCB_CONFIGURE_NOTIFY: {
+		const xcb_configure_notify_event_t* configure = (const xcb_configure_notify_event_t*)e;
+		// SubstructureNotifyMask also reports changes to child windows
+		if(configure->window != window->handle) break;
+		x11_pending_configured(&window->pending, e->full_sequence);
+		// the window manager sends synthetic ones in root coordinates when it moves the frame
+		if((configure->response_type & 0x80) != 0 || !window->reparented) {
+			update_position(window, configure->x, configure->y, timestamp);
+		}
+		else {
+			x11_position_query_t* query = x11_position_queries_add(&context->position_queries, window->handle);
+			if(query != NULL) query->sequence = xcb_translate_coordinates(context->connection, window->handle, context->screen->root, 0, 0).sequence;
+		}
+		if(configure->width != window->width || configure->height != window->height) {
+			window->width = configure->width;
+			window->height = configure->height;
+			event.type = PLATFORM_EVENT_RESIZE;
+			event.resize.width = window->width;
+			event.resize.height = window->height;
+			event_queue_push(queue, &event);
+		}
+		event.type = PLATFORM_EVENT_NONE;
+		break;
+	}
+	case XCB_REPARENT_NOTIFY: {
+		const xcb_reparent_notify_event_t* reparent = (const xcb_reparent_notify_event_t*)e;
+		if(reparent->window != window->handle) break;
+		window->reparented = reparent->parent != context->screen->root;
+		break;
+	}
+	case XCB_MAP_NOTIFY:
+		if(((const xcb_map_notify_event_t*)e)->window != window->handle) break;
+		window->mapped = 1;
+		event.type = PLATFORM_EVENT_MAP;
+		// see the xlib backend, setting this at creation makes the window float in bspwm
+		if((window->active_flags & PLATFORM_WF_RESIZABLE) == 0) set_size_hints(context, window, 1);
+		break;
+	case XCB_UNMAP_NOTIFY:
+		if(((const xcb_unmap_notify_event_t*)e)->window != window->handle) break;
+		window->mapped = 0;
+		event.type = PLATFORM_EVENT_UNMAP;
+		break;
+	case XCB_FOCUS_IN:
+		if(window->focused) break;
+		window->focused = 1;
+		context->focused_window = (platform_window_t*)window;
+		event.type = PLATFORM_EVENT_FOCUS_IN;
+		break;
+	case XCB_FOCUS_OUT:
+		if(!window->focused) break;
+		window->focused = 0;
+		if(context->focused_window == (platform_window_t*)window) context->focused_window = NULL;
+		// releases while unfocused are never seen
+		memset(context->keys_down, 0, sizeof(context->keys_down));
+		event.type = PLATFORM_EVENT_FOCUS_OUT;
+		break;
+	case XCB_EXPOSE: {
+		const xcb_expose_event_t* expose = (const xcb_expose_event_t*)e;
+		event.type = PLATFORM_EVENT_EXPOSE;
+		event.expose.x = expose->x;
+		event.expose.y = expose->y;
+		event.expose.width = expose->width;
+		event.expose.height = expose->height;
+		break;
+	}
+	case XCB_MOTION_NOTIFY: {
+		const xcb_motion_notify_event_t* motion = (const xcb_motion_notify_event_t*)e;
+		event.type = PLATFORM_EVENT_MOUSE_MOVE;
+		event.mouse_move.x = motion->event_x;
+		event.mouse_move.y = motion->event_y;
+		event.timestamp = x11_server_time_to_timestamp(&context->server_time, motion->time);
+		break;
+	}
+	case XCB_KEY_PRESS:
+		translate_key(context, (const xcb_key_press_event_t*)e, 1, &event);
+		break;
+	case XCB_KEY_RELEASE:
+		if(is_auto_repeat(context, (const xcb_key_release_event_t*)e)) break;
+		translate_key(context, (const xcb_key_press_event_t*)e, 0, &event);
+		break;
+	case XCB_BUTTON_PRESS:
+	case XCB_BUTTON_RELEASE: {
+		const xcb_button_press_event_t* button = (const xcb_button_press_event_t*)e;
+		event.timestamp = x11_server_time_to_timestamp(&context->server_time, button->time);
+		x11_translate_button(button->detail, type == XCB_BUTTON_PRESS, button->event_x, button->event_y, button->state, &event);
+		break;
+	}
+	default:
+		// window managers cause plenty of events nothing here needs, like GravityNotify
+		break;
+	}
+	if(event.type != PLATFORM_EVENT_NONE) event_queue_push(queue, &event);
+}
+
+// a drag resize can send many requests, each one would flip override redirect twice
+static void apply_resize_requests(xcb_backend_window_t* resize_requests) {
+	while(resize_requests != NULL) {
+		xcb_backend_window_t* window = resize_requests;
+		resize_requests = window->next_resize_request;
+		window->resize_requested = 0;
+		window->next_resize_request = NULL;
+		send_window_size(&linux_platform_context.xcb, window->handle, window->requested_width, window->requested_height);
+	}
+}
+
+// the queries of the whole batch are already sent. the replies are waited for without
+// the state lock, which the event thread holds otherwise, so the app is not held up by
+// the round trip. the windows are looked up again after, the app may have destroyed them
+static void collect_positions(xcb_backend_context_t* context, const uint64_t timestamp) {
+	x11_position_queries_t* queries = &context->position_queries;
+	if(queries->count == 0) return;
+	unlock_state(context);
+	for(uint32_t i = 0; i < queries->count; i++) {
+		xcb_translate_coordinates_cookie_t cookie = { queries->queries[i].sequence };
+		xcb_translate_coordinates_reply_t* position = xcb_translate_coordinates_reply(context->connection, cookie, NULL);
+		if(position == NULL) continue;
+		queries->queries[i].x = position->dst_x;
+		queries->queries[i].y = position->dst_y;
+		queries->queries[i].answered = 1;
+		free(position);
+	}
+	lock_state(context);
+	for(uint32_t i = 0; i < queries->count; i++) {
+		if(!queries->queries[i].answered) continue;
+		xcb_backend_window_t* window = (xcb_backend_window_t*)x11_window_map_find(&context->windows, queries->queries[i].handle);
+		if(window != NULL) update_position(window, queries->queries[i].x, queries->queries[i].y, timestamp);
+	}
+	queries->count = 0;
+}
+
+// handles first and everything already queued behind it, the connection is not read again
+static void handle_batch(xcb_backend_context_t* context, xcb_generic_event_t* first) {
+	xcb_backend_window_t* resize_requests = NULL;
+	// everything handled here arrived before this point
+	uint64_t timestamp = platform_get_timestamp();
+	for(xcb_generic_event_t* e = first; e != NULL; e = next_event(context, 0)) {
+		handle_event(context, e, timestamp, &resize_requests);
+		free(e);
+	}
+	apply_resize_requests(resize_requests);
+	collect_positions(context, timestamp);
+}
+
+void xcb_backend_handle_events(void) {
+	xcb_backend_context_t* context = &linux_platform_context.xcb;
+	send_pending(context);
+	// the event thread reads everything, requests only have to go out
+	if(!linux_platform_context.event_thread) {
+		xcb_generic_event_t* first = next_event(context, 1);
+		if(first != NULL) handle_batch(context, first);
+	}
+	xcb_flush(context->connection);
+}
+int8_t xcb_backend_wait_events(const uint64_t timeout_ns) {
+	xcb_backend_context_t* context = &linux_platform_context.xcb;
+	// events may already be sitting in the xcb queue, in which case
+	// the connection fd will not become readable for them
+	if(context->lookahead == NULL) context->lookahead = xcb_poll_for_queued_event(context->connection);
+	if(context->lookahead == NULL) {
+		send_pending(context);
+		xcb_flush(context->connection);
+		struct pollfd fds[2] = {
+			{ .fd = xcb_get_file_descriptor(context->connection), .events = POLLIN },
+			{ .fd = linux_platform_context.wake_fd, .events = POLLIN }
+		};
+		struct timespec timeout;
+		timeout.tv_sec = timeout_ns / 1000000000;
+		timeout.tv_nsec = timeout_ns % 1000000000;
+		int result = ppoll(fds, 2, timeout_ns == PLATFORM_WAIT_INFINITE ? NULL : &timeout, NULL);
+		if(result <= 0) return 0;
+		if(fds[1].revents & POLLIN) {
+			uint64_t count;
+			while(read(linux_platform_context.wake_fd, &count, sizeof(count)) > 0);
+		}
+	}
+	xcb_backend_handle_events();
+	return 1;
+}
+
+static int event_thread_main(void* data) {
+	xcb_backend_context_t* context = &linux_platform_context.xcb;
+	while(!atomic_load(&context->event_thread_stopping)) {
+		// only this thread reads events, the lookahead is its own
+		xcb_generic_event_t* e = context->lookahead;
+		context->lookahead = NULL;
+		if(e == NULL) e = xcb_wait_for_event(context->connection);
+		// the connection broke
+		if(e == NULL) break;
+
+		mtx_lock(&context->lock);
+		handle_batch(context, e);
+		linux_publish_events();
+		mtx_unlock(&context->lock);
+		xcb_flush(context->connection);
+	}
+	return 0;
+}
+
+int8_t xcb_backend_start_event_thread(void) {
+	xcb_backend_context_t* context = &linux_platform_context.xcb;
+	context->event_thread_window = xcb_generate_id(context->connection);
+	xcb_create_window(context->connection, 0, context->event_thread_window, context->screen->root, 0, 0, 1, 1, 0,
+	                  XCB_WINDOW_CLASS_INPUT_ONLY, XCB_COPY_FROM_PARENT, 0, NULL);
+	xcb_flush(context->connection);
+	atomic_store(&context->event_thread_stopping, 0);
+	if(thrd_create(&context->event_thread, event_thread_main, NULL) != thrd_success) {
+		xcb_destroy_window(context->connection, context->event_thread_window);
+		return 0;
+	}
+	return 1;
+}
+void xcb_backend_stop_event_thread(void) {
+	xcb_backend_context_t* context = &linux_platform_context.xcb;
+	atomic_store(&context->event_thread_stopping, 1);
+	// with an empty event mask the message goes to the window's creator, which is us
+	xcb_client_message_event_t message = {0};
+	message.response_type = XCB_CLIENT_MESSAGE;
+	message.window = context->event_thread_window;
+	message.format = 32;
+	xcb_send_event(context->connection, 0, context->event_thread_window, 0, (const char*)&message);
+	xcb_flush(context->connection);
+	thrd_join(context->event_thread, NULL);
+	xcb_destroy_window(context->connection, context->event_thread_window);
+	xcb_flush(context->connection);
+}
+
+void xcb_backend_publish_backlog(void) {
+	mtx_lock(&linux_platform_context.xcb.lock);
+	linux_publish_events();
+	mtx_unlock(&linux_platform_context.xcb.lock);
+}
@@ -0,0 +1,70 @@
+#ifndef XCB_WINDOW_H
+#define XCB_WINDOW_H
+
+#include "linux_internal.h"
+#include <xcb/xcb.h>
+
+// xcb reserves the xcb_ prefix, everything here is xcb_backend_
+#define XCB_BACKEND_FUNCTIONS (linux_window_functions_t) { \
+	.create_window = xcb_backend_create_window, \
+	.destroy_window = xcb_backend_destroy_window, \
+	.get_window_position = xcb_backend_get_window_position, \
+	.get_window_size = xcb_backend_get_window_size, \
+	.refresh_window_state = xcb_backend_refresh_window_state, \
+	.set_window_position = xcb_backend_set_window_position, \
+	.set_window_size = xcb_backend_set_window_size, \
+	.get_window_name = xcb_backend_get_window_name, \
+	.set_window_name = xcb_backend_set_window_name, \
+	.map_window = xcb_backend_map_window, \
+	.unmap_window = xcb_backend_unmap_window, \
+	.window_is_mapped = xcb_backend_window_is_mapped, \
+	.window_has_focus = xcb_backend_window_has_focus, \
+	.window_should_close = xcb_backend_window_should_close, \
+	.get_framebuffer = xcb_backend_window_get_framebuffer, \
+	.present = xcb_backend_window_present, \
+	.get_monitors = xcb_backend_get_monitors, \
+	.vulkan_required_extensions = xcb_backend_vulkan_required_extensions, \
+	.vulkan_create_surface = xcb_backend_vulkan_create_surface, \
+	.flush = xcb_backend_flush, \
+	.handle_events = xcb_backend_handle_events, \
+	.wait_events = xcb_backend_wait_events, \
+	.start_event_thread = xcb_backend_start_event_thread, \
+	.stop_event_thread = xcb_backend_stop_event_thread, \
+	.publish_backlog = xcb_backend_publish_backlog \
+}
+
+int8_t xcb_backend_init_context(xcb_backend_context_t* context);
+void xcb_backend_cleanup_context(xcb_backend_context_t* context);
+
+platform_window_t* xcb_backend_create_window(const platform_window_create_info_t create_info, platform_allocation_callbacks_t* allocator);
+void xcb_backend_destroy_window(platform_window_t* window, platform_allocation_callbacks_t* allocator);
+void xcb_backend_get_window_position(const platform_window_t* window, int32_t* x, int32_t* y);
+void xcb_backend_get_window_size(const platform_window_t* window, uint32_t* width, uint32_t* height);
+// only sends the queries, the replies are collected when the state is next needed
+void xcb_backend_refresh_window_state(platform_window_t* window);
+void xcb_backend_set_window_position(platform_window_t* window, const int32_t x, const int32_t y);
+void xcb_backend_set_window_size(platform_window_t* window, const uint32_t width, const uint32_t height);
+void xcb_backend_get_window_name(const platform_window_t* window, char* name, uint32_t max_len);
+void xcb_backend_set_window_name(platform_window_t* window, const char* name);
+void xcb_backend_map_window(platform_window_t* window);
+void xcb_backend_unmap_window(platform_window_t* window);
+int8_t xcb_backend_window_is_mapped(const platform_window_t* window);
+int8_t xcb_backend_window_has_focus(const platform_window_t* window);
+int8_t xcb_backend_window_should_close(const platform_window_t* window);
+int8_t xcb_backend_window_get_framebuffer(platform_window_t* window, platform_framebuffer_t* framebuffer);
+void xcb_backend_window_present(platform_window_t* window, const platform_rect_t* damage, const uint32_t damage_count);
+uint32_t xcb_backend_get_monitors(platform_monitor_t* monitors, const uint32_t max_count);
+char** xcb_backend_vulkan_required_extensions(uint32_t* extension_count);
+VkSurfaceKHR xcb_backend_vulkan_create_surface(platform_window_t* window, VkInstance instance);
+
+// the X window behind a platform window, for code that talks to the server directly
+xcb_window_t xcb_backend_get_window_handle(const platform_window_t* window);
+
+void xcb_backend_flush(void);
+void xcb_backend_handle_events(void);
+int8_t xcb_backend_wait_events(const uint64_t timeout_ns);
+int8_t xcb_backend_start_event_thread(void);
+void xcb_backend_stop_event_thread(void);
+void xcb_backend_publish_backlog(void);
+
+#endif // XCB_WINDOW_H
@@ -0,0 +1,79 @@
+#include "xlib_input.h"
+#include <X11/XKBlib.h>
+#include <X11/extensions/XInput2.h>
+#include <string.h>
+
+void xlib_input_init(xlib_context_t* context) {
+	Bool detectable = 0;
+	XkbSetDetectableAutoRepeat(context->dpy, 1, &detectable);
+	memset(context->keys_down, 0, sizeof(context->keys_down));
+	context->server_time.synced = 0;
+	context->focused_window = NULL;
+
+	context->xi_opcode = 0;
+	int first_event, first_error;
+	if(!XQueryExtension(context->dpy, "XInputExtension", &context->xi_opcode, &first_event, &first_error)) {
+		context->xi_opcode = 0;
+		return;
+	}
+	int major = 2, minor = 0;
+	if(XIQueryVersion(context->dpy, &major, &minor) != Success) {
+		context->xi_opcode = 0;
+		return;
+	}
+	// raw events are only ever delivered to the root window
+	uint8_t mask[XIMaskLen(XI_RawMotion)] = {0};
+	XISetMask(mask, XI_RawMotion);
+	XIEventMask event_mask = { XIAllMasterDevices, sizeof(mask), mask };
+	XISelectEvents(context->dpy, DefaultRootWindow(context->dpy), &event_mask, 1);
+}
+
+void xlib_translate_key(xlib_context_t* context, XKeyEvent* e, platform_event_t* event) {
+	uint8_t bit = 1 << (e->keycode & 7);
+	uint8_t* down = &context->keys_down[(e->keycode >> 3) & 31];
+	if(e->type == KeyPress) {
+		event->type = PLATFORM_EVENT_KEY_DOWN;
+		// with detectable auto repeat a held key only sends more presses
+		event->key.repeat = (*down & bit) != 0;
+		*down |= bit;
+	}
+	else {
+		event->type = PLATFORM_EVENT_KEY_UP;
+		event->key.repeat = 0;
+		*down &= ~bit;
+	}
+	// the unshifted symbol, the same key is reported no matter which modifiers are held
+	event->key.key = x11_translate_keysym(XLookupKeysym(e, 0));
+	// X keycodes are evdev codes offset by 8
+	event->key.scancode = e->keycode >= 8 ? e->keycode - 8 : 0;
+	event->key.modifiers = x11_translate_modifiers(e->state);
+	event->timestamp = x11_server_time_to_timestamp(&context->server_time, e->time);
+}
+
+void xlib_translate_button(xlib_context_t* context, const XButtonEvent* e, platform_event_t* event) {
+	event->timestamp = x11_server_time_to_timestamp(&context->server_time, e->time);
+	x11_translate_button(e->button, e->type == ButtonPress, e->x, e->y, e->state, event);
+}
+
+int8_t xlib_translate_generic_event(xlib_context_t* context, XGenericEventCookie* cookie, platform_event_t* event) {
+	if(context->xi_opcode == 0 || cookie->extension != context->xi_opcode) return 0;
+	// raw motion is not tied to a window, it goes to the one with focus
+	if(cookie->evtype != XI_RawMotion || context->focused_window == NULL) return 0;
+	if(!XGetEventData(context->dpy, cookie)) return 0;
+
+	const XIRawEvent* raw = cookie->data;
+	// raw_values only holds the axes set in the mask, in order
+	double values[2] = {0};
+	uint32_t value_index = 0;
+	for(int axis = 0; axis < 2 && axis < raw->valuators.mask_len * 8; axis++) {
+		if(XIMaskIsSet(raw->valuators.mask, axis)) values[axis] = raw->raw_values[value_index++];
+	}
+	event->type = PLATFORM_EVENT_RAW_MOTION;
+	event->window = context->focused_window;
+	event->raw_motion.x = values[0];
+	event->raw_motion.y = values[1];
+	event->timestamp = x11_server_time_to_timestamp(&context->server_time, raw->time);
+
+	XFreeEventData(context->dpy, cookie);
+	return 1;
+}
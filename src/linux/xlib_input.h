@@ -0,0 +1,16 @@
+#ifndef XLIB_INPUT_H
+#define XLIB_INPUT_H
+
+#include "linux_internal.h"
+#include <X11/Xlib.h>
+
+// selects XInput2 raw motion when the server supports it and
+// makes the server report auto repeat as presses without releases
+void xlib_input_init(xlib_context_t* context);
+
+void xlib_translate_key(xlib_context_t* context, XKeyEvent* e, platform_event_t* event);
+void xlib_translate_button(xlib_context_t* context, const XButtonEvent* e, platform_event_t* event);
+// XInput2 events, returns 0 for anything that is not turned into a platform event
+int8_t xlib_translate_generic_event(xlib_context_t* context, XGenericEventCookie* cookie, platform_event_t* event);
+
+#endif // XLIB_INPUT_H
@@ -0,0 +1,137 @@
+#include "xlib_monitors.h"
+#include <X11/extensions/Xrandr.h>
+#include <string.h>
+
+static void set_screen_monitor(xlib_context_t* context) {
+	int scr = DefaultScreen(context->dpy);
+	platform_monitor_t* monitor = &context->monitors[0];
+	memset(monitor, 0, sizeof(*monitor));
+	strcpy(monitor->name, "screen");
+	monitor->width = DisplayWidth(context->dpy, scr);
+	monitor->height = DisplayHeight(context->dpy, scr);
+	int mm_width = DisplayWidthMM(context->dpy, scr);
+	if(mm_width > 0) monitor->dpi = (uint32_t)(monitor->width * 25.4 / mm_width + 0.5);
+	monitor->primary = 1;
+	context->monitor_count = 1;
+}
+
+static uint32_t mode_refresh_mhz(const XRRScreenResources* resources, const RRMode id) {
+	for(int i = 0; i < resources->nmode; i++) {
+		const XRRModeInfo* mode = &resources->modes[i];
+		if(mode->id != id) continue;
+		uint64_t dots = (uint64_t)mode->hTotal * mode->vTotal;
+		if(mode->modeFlags & RR_DoubleScan) dots *= 2;
+		if(mode->modeFlags & RR_Interlace) dots /= 2;
+		if(dots == 0) return 0;
+		return (uint32_t)(((uint64_t)mode->dotClock * 1000 + dots / 2) / dots);
+	}
+	return 0;
+}
+
+static void query_monitors(xlib_context_t* context) {
+	Window root = DefaultRootWindow(context->dpy);
+	// the current resources come from the server's cache, the other call
+	// makes it probe every output which can take long enough to drop frames
+	XRRScreenResources* resources = context->randr_current ? XRRGetScreenResourcesCurrent(context->dpy, root)
+	                                                       : XRRGetScreenResources(context->dpy, root);
+	if(resources == NULL) {
+		set_screen_monitor(context);
+		return;
+	}
+	RROutput primary = XRRGetOutputPrimary(context->dpy, root);
+	RRCrtc crtcs[PLATFORM_MAX_MONITORS];
+	uint32_t count = 0;
+	for(int i = 0; i < resources->noutput && count < PLATFORM_MAX_MONITORS; i++) {
+		XRROutputInfo* output = XRRGetOutputInfo(context->dpy, resources, resources->outputs[i]);
+		if(output == NULL) continue;
+		if(output->connection != RR_Connected || output->crtc == None) {
+			XRRFreeOutputInfo(output);
+			continue;
+		}
+		// mirrored outputs share a crtc and show the same part of the screen
+		uint32_t existing = 0;
+		while(existing < count && crtcs[existing] != output->crtc) existing++;
+		if(existing < count) {
+			if(resources->outputs[i] == primary) context->monitors[existing].primary = 1;
+			XRRFreeOutputInfo(output);
+			continue;
+		}
+		XRRCrtcInfo* crtc = XRRGetCrtcInfo(context->dpy, resources, output->crtc);
+		if(crtc == NULL || crtc->mode == None) {
+			if(crtc != NULL) XRRFreeCrtcInfo(crtc);
+			XRRFreeOutputInfo(output);
+			continue;
+		}
+		platform_monitor_t* monitor = &context->monitors[count];
+		memset(monitor, 0, sizeof(*monitor));
+		strncpy(monitor->name, output->name, sizeof(monitor->name) - 1);
+		monitor->x = crtc->x;
+		monitor->y = crtc->y;
+		monitor->width = crtc->width;
+		monitor->height = crtc->height;
+		monitor->refresh_mhz = mode_refresh_mhz(resources, crtc->mode);
+		// the physical size is reported for the unrotated panel, the crtc size is already rotated
+		unsigned long mm_width = output->mm_width;
+		if(crtc->rotation & (RR_Rotate_90 | RR_Rotate_270)) mm_width = output->mm_height;
+		if(mm_width != 0) monitor->dpi = (uint32_t)(monitor->width * 25.4 / mm_width + 0.5);
+		monitor->primary = resources->outputs[i] == primary;
+		crtcs[count++] = output->crtc;
+		XRRFreeCrtcInfo(crtc);
+		XRRFreeOutputInfo(output);
+	}
+	XRRFreeScreenResources(resources);
+
+	if(count == 0) {
+		// every output is off, windows still have a screen to be on
+		set_screen_monitor(context);
+		return;
+	}
+	for(uint32_t i = 1; i < count; i++) {
+		if(!context->monitors[i].primary) continue;
+		platform_monitor_t monitor = context->monitors[i];
+		memmove(&context->monitors[1], &context->monitors[0], i * sizeof(platform_monitor_t));
+		context->monitors[0] = monitor;
+		break;
+	}
+	// without a primary output the first one stands in for it
+	context->monitors[0].primary = 1;
+	context->monitor_count = count;
+}
+
+void xlib_monitors_init(xlib_context_t* context) {
+	context->randr_event_base = -1;
+	context->randr_current = 0;
+	context->monitors_dirty = 0;
+	int event_base, error_base, major = 0, minor = 0;
+	if(!XRRQueryExtension(context->dpy, &event_base, &error_base) ||
+	   !XRRQueryVersion(context->dpy, &major, &minor) || (major == 1 && minor < 2)) {
+		set_screen_monitor(context);
+		return;
+	}
+	context->randr_event_base = event_base;
+	context->randr_current = major > 1 || minor >= 3;
+	XRRSelectInput(context->dpy, DefaultRootWindow(context->dpy),
+	               RRScreenChangeNotifyMask | RRCrtcChangeNotifyMask | RROutputChangeNotifyMask);
+	query_monitors(context);
+}
+
+int8_t xlib_monitors_handle_event(xlib_context_t* context, XEvent* e) {
+	if(context->randr_event_base < 0) return 0;
+	if(e->type == context->randr_event_base + RRScreenChangeNotify) {
+		// keeps DisplayWidth and friends in sync with the new screen size
+		XRRUpdateConfiguration(e);
+		context->monitors_dirty = 1;
+		return 1;
+	}
+	if(e->type == context->randr_event_base + RRNotify) {
+		context->monitors_dirty = 1;
+		return 1;
+	}
+	return 0;
+}
+
+void xlib_monitors_update(xlib_context_t* context) {
+	if(!context->monitors_dirty) return;
+	context->monitors_dirty = 0;
+	query_monitors(context);
+}
@@ -0,0 +1,17 @@
+#ifndef XLIB_MONITORS_H
+#define XLIB_MONITORS_H
+
+#include "linux_internal.h"
+#include <X11/Xlib.h>
+
+// selects RandR change notifications on the root window and queries the
+// monitors once, without RandR 1.2 the whole screen is the only monitor
+void xlib_monitors_init(xlib_context_t* context);
+
+// RandR events, returns 0 for anything else. only marks the cached monitors
+// as stale, several notifications usually arrive for a single change
+int8_t xlib_monitors_handle_event(xlib_context_t* context, XEvent* e);
+// queries the monitors again when an event marked them as stale
+void xlib_monitors_update(xlib_context_t* context);
+
+#endif // XLIB_MONITORS_H
@@ -1,7 +1,24 @@
+#define _GNU_SOURCE
 #define VK_USE_PLATFORM_XLIB_KHR
 #include "xlib_window.h"
+#include "xlib_input.h"
+#include "xlib_monitors.h"
+#include "common/pixel_kernels.h"
 #include "X11/Xatom.h"
 #include "X11/Xutil.h"
+#include <X11/extensions/XShm.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <poll.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// how long a present may keep the framebuffer from being written again
+#define PRESENT_TIMEOUT_NS 100000000
 
 typedef struct {
 	unsigned long flags;
@@ -11,67 +28,208 @@ typedef struct {
 	unsigned long status;
 } motif_hints_t;
 
-int8_t xlib_init_context(xlib_context_t* context);
+int8_t xlib_init_context(xlib_context_t* context, const int8_t threaded);
 void xlib_cleanup_context(xlib_context_t* context);
 
 struct platform_window_t {
 	Window   handle;
 	uint32_t active_flags;
 	void*    user_data;
+	// cached state, kept up to date by xlib_handle_events so
+	// the getters never have to wait on the server
+	int32_t  x, y;
+	uint32_t width, height;
 	int8_t   mapped;
+	int8_t   focused;
 	int8_t   should_close;
+	// inside the frame of a reparenting window manager, real ConfigureNotify
+	// positions are relative to the frame then
+	int8_t   reparented;
+	// ResizeRequests are collected while handling events and
+	// only the last one for each window is applied afterwards
+	int8_t             resize_requested;
+	uint32_t           requested_width, requested_height;
+	platform_window_t* next_resize_request;
+	// position, size and name set by the app, sent by the next
+	// handle_events or flush, only touched by the app's thread
+	x11_pending_t      pending;
+	// created by the first get_framebuffer, shm.shmid is -1
+	// when the image is in the client's own memory
+	XImage*         image;
+	XShmSegmentInfo shm;
+	// what the app draws into when the image is 16 bit, converted by present
+	uint32_t*       pixels;
+	// the server may still be reading the shared image, with an event
+	// thread it is only touched while holding the context's present_lock
+	int8_t          present_pending;
 };
 
-static inline Atom atom_supported(Atom a, Atom* supported_atoms, uint32_t supported_atom_count) {
-	for(int i = 0; i < supported_atom_count; i++) {
-		if(supported_atoms[i] == a) return a;
-	}
-	return None;
+// every atom is interned in a single round trip, the names
+// are listed with where the result goes in the context
+static const struct {
+	const char* name;
+	size_t      offset;
+} context_atoms[] = {
+	{ "WM_PROTOCOLS",               offsetof(xlib_context_t, wm_protocols) },
+	{ "WM_DELETE_WINDOW",           offsetof(xlib_context_t, wm_delete_window) },
+	{ "_MOTIF_WM_HINTS",            offsetof(xlib_context_t, motif_wm_hints) },
+	{ "_NET_WM_NAME",               offsetof(xlib_context_t, net_wm_name) },
+	{ "_NET_WM_ICON_NAME",          offsetof(xlib_context_t, net_wm_icon_name) },
+	{ "UTF8_STRING",                offsetof(xlib_context_t, utf8_string) },
+	{ "_NET_SUPPORTED",             offsetof(xlib_context_t, net_supported) },
+	{ "_NET_WM_WINDOW_TYPE",        offsetof(xlib_context_t, net_wm_window_type) },
+	{ "_NET_WM_WINDOW_TYPE_SPLASH", offsetof(xlib_context_t, net_wm_window_type_splash) },
+	{ "_NET_WM_WINDOW_TYPE_DIALOG", offsetof(xlib_context_t, net_wm_window_type_dialog) },
+	{ "_NET_WM_WINDOW_TYPE_MENU",   offsetof(xlib_context_t, net_wm_window_type_menu) },
+	{ "_NET_WM_ALLOWED_ACTIONS",    offsetof(xlib_context_t, net_wm_allowed_actions) },
+	{ "_NET_WM_ACTION_RESIZE",      offsetof(xlib_context_t, net_wm_action_resize) },
+};
+#define CONTEXT_ATOM_COUNT (sizeof(context_atoms) / sizeof(context_atoms[0]))
+
+// atoms of _NET_SUPPORTED per XGetWindowProperty request
+#define SUPPORTED_ATOMS_PER_REQUEST 1024
+
+// reads all of _NET_SUPPORTED into a hash set sized by the first reply,
+// usually the whole list arrives with that reply
+static void load_supported_atoms(xlib_context_t* context) {
+	Window root_window = XRootWindow(context->dpy, XDefaultScreen(context->dpy));
+	context->supported_atoms.atoms = NULL;
+
+	long offset = 0;
+	unsigned long bytes_after = 0;
+	do {
+		Atom type;
+		int format;
+		unsigned long count = 0;
+		Atom* atoms = NULL;
+		int result = XGetWindowProperty(context->dpy, root_window, context->net_supported, offset, SUPPORTED_ATOMS_PER_REQUEST,
+		                                0, XA_ATOM, &type, &format, &count, &bytes_after, (uint8_t**)&atoms);
+		if(result != Success || type != XA_ATOM || format != 32) {
+			if(atoms != NULL) XFree(atoms);
+			break;
+		}
+		if(context->supported_atoms.atoms == NULL && !x11_atom_set_init(&context->supported_atoms, count + bytes_after / 4)) {
+			XFree(atoms);
+			break;
+		}
+		// the window manager could grow the list between requests, anything past the capacity is ignored
+		for(unsigned long i = 0; i < count && x11_atom_set_insert(&context->supported_atoms, atoms[i]); i++);
+		offset += count;
+		XFree(atoms);
+	} while(bytes_after != 0);
 }
 
-int8_t xlib_init_context(xlib_context_t* context) {
+int8_t xlib_init_context(xlib_context_t* context, const int8_t threaded) {
+	// has to come before anything else touches Xlib
+	if(threaded && !XInitThreads()) return 0;
 	context->dpy = XOpenDisplay(NULL);
 	if(context->dpy == NULL) return 0;
-	context->wm_protocols = XInternAtom(context->dpy, "WN_PROTOCOLS", 0);
-	context->wm_delete_window = XInternAtom(context->dpy, "WM_DELETE_WINDOW", 0);
-	context->motif_wm_hints = XInternAtom(context->dpy, "_MOTIF_WM_HINTS", 0);
-	context->net_wm_name = XInternAtom(context->dpy, "NET_WM_NAME", 0);
-	context->net_wm_icon_name = XInternAtom(context->dpy, "_NET_WM_ICON_NAME", 0);
-	context->utf8_string = XInternAtom(context->dpy, "UTF8_STRING", 0);
-	context->net_supported = XInternAtom(context->dpy, "_NET_SUPPORTED", 0);
-	context->net_wm_window_type = XInternAtom(context->dpy, "_NET_WM_WINDOW_TYPE", 0);
-	context->net_wm_window_type_splash = XInternAtom(context->dpy, "_NET_WM_WINDOW_TYPE_SPLASH", 0);
-	context->net_wm_window_type_dialog = XInternAtom(context->dpy, "_NET_WM_WINDOW_TYPE_DIALOG", 0);
-	context->net_wm_window_type_menu = XInternAtom(context->dpy, "_NET_WM_WINDOW_TYPE_DIALOG", 0);
-	context->net_wm_allowed_actions = XInternAtom(context->dpy, "_NET_WM_ALLOWED_ACTIONS", 0);
-	context->net_wm_action_resize = XInternAtom(context->dpy, "_NET_WM_ACTION_RESIZE", 0);
 
+	if(!x11_window_map_init(&context->windows)) {
+		XCloseDisplay(context->dpy);
+		context->dpy = NULL;
+		return 0;
+	}
 
-	Window root_window = XRootWindow(context->dpy, XDefaultScreen(context->dpy));
-	Atom type;
-	uint64_t bytes_after = 0;
-	int format;
-	XGetWindowProperty(context->dpy, root_window, context->net_supported, 0, 32, 0, XA_ATOM, &type, &format,
-	                   &context->supported_atom_count, &bytes_after, (uint8_t**)&context->supported_atoms);
-
-	context->net_wm_window_type = atom_supported(context->net_wm_window_type,
-	                                             context->supported_atoms, context->supported_atom_count);
-	context->net_wm_window_type_splash = atom_supported(context->net_wm_window_type_splash,
-	                                                    context->supported_atoms, context->supported_atom_count);
-	context->net_wm_window_type_dialog = atom_supported(context->net_wm_window_type_dialog,
-	                                                    context->supported_atoms, context->supported_atom_count);
-	context->net_wm_window_type_menu = atom_supported(context->net_wm_window_type_menu,
-	                                                  context->supported_atoms, context->supported_atom_count);
-	context->net_wm_allowed_actions = atom_supported(context->net_wm_allowed_actions,
-	                                                 context->supported_atoms, context->supported_atom_count);
+	char* names[CONTEXT_ATOM_COUNT];
+	Atom atoms[CONTEXT_ATOM_COUNT];
+	for(uint32_t i = 0; i < CONTEXT_ATOM_COUNT; i++) names[i] = (char*)context_atoms[i].name;
+	XInternAtoms(context->dpy, names, CONTEXT_ATOM_COUNT, 0, atoms);
+	for(uint32_t i = 0; i < CONTEXT_ATOM_COUNT; i++) {
+		*(Atom*)((uint8_t*)context + context_atoms[i].offset) = atoms[i];
+	}
 
+	load_supported_atoms(context);
+	context->net_wm_window_type = x11_atom_set_find(&context->supported_atoms, context->net_wm_window_type);
+	context->net_wm_window_type_splash = x11_atom_set_find(&context->supported_atoms, context->net_wm_window_type_splash);
+	context->net_wm_window_type_dialog = x11_atom_set_find(&context->supported_atoms, context->net_wm_window_type_dialog);
+	context->net_wm_window_type_menu = x11_atom_set_find(&context->supported_atoms, context->net_wm_window_type_menu);
+	context->net_wm_allowed_actions = x11_atom_set_find(&context->supported_atoms, context->net_wm_allowed_actions);
+
+	xlib_input_init(context);
+	xlib_monitors_init(context);
+	context->pending_windows = NULL;
+	memset(&context->position_queries, 0, sizeof(context->position_queries));
+	context->shm_available = XShmQueryExtension(context->dpy);
+	context->shm_completion_event = context->shm_available ? XShmGetEventBase(context->dpy) + ShmCompletion : -1;
 	return 1;
 }
 void xlib_cleanup_context(xlib_context_t* context) {
+	x11_atom_set_free(&context->supported_atoms);
+	x11_window_map_free(&context->windows);
+	x11_position_queries_free(&context->position_queries);
 	XCloseDisplay(context->dpy);
 	context->dpy = NULL;
 }
 
+static void queue_pending(xlib_context_t* context, platform_window_t* window) {
+	if(window->pending.flags == 0 || window->pending.queued) return;
+	window->pending.queued = 1;
+	window->pending.next = context->pending_windows;
+	context->pending_windows = window;
+}
+static void unqueue_pending(xlib_context_t* context, platform_window_t* window) {
+	if(!window->pending.queued) return;
+	platform_window_t** link = &context->pending_windows;
+	while(*link != window) link = &(*link)->pending.next;
+	*link = window->pending.next;
+	window->pending.queued = 0;
+	window->pending.next = NULL;
+}
+
+// the window manager would otherwise get to decide on the size
+// returns the serial of the resize
+static unsigned long send_window_size(xlib_context_t* context, platform_window_t* window, const uint32_t width, const uint32_t height) {
+	XSetWindowAttributes new_attributes;
+	new_attributes.override_redirect = 1;
+	XChangeWindowAttributes(context->dpy, window->handle, CWOverrideRedirect, &new_attributes);
+	unsigned long serial = NextRequest(context->dpy);
+	XResizeWindow(context->dpy, window->handle, width, height);
+	new_attributes.override_redirect = 0;
+	XChangeWindowAttributes(context->dpy, window->handle, CWOverrideRedirect, &new_attributes);
+	return serial;
+}
+static void send_window_name(xlib_context_t* context, platform_window_t* window) {
+	const char* name = x11_pending_name(&window->pending);
+	if(name == NULL) {
+		XDeleteProperty(context->dpy, window->handle, context->net_wm_name);
+		XDeleteProperty(context->dpy, window->handle, XA_WM_NAME);
+		return;
+	}
+	uint32_t len = window->pending.name_len;
+	XChangeProperty(context->dpy, window->handle, context->net_wm_name,
+	                context->utf8_string, 8, PropModeReplace, (const uint8_t*)name, len);
+	XChangeProperty(context->dpy, window->handle, XA_WM_NAME,
+	                XA_STRING, 8, PropModeReplace, (const uint8_t*)name, len);
+	XChangeProperty(context->dpy, window->handle, XA_WM_ICON_NAME,
+	                XA_STRING, 8, PropModeReplace, (const uint8_t*)name, len);
+	XChangeProperty(context->dpy, window->handle, context->net_wm_icon_name,
+	                context->utf8_string, 8, PropModeReplace, (const uint8_t*)name, len);
+}
+// everything the app changed since the last flush, in one go
+static void send_pending(xlib_context_t* context) {
+	while(context->pending_windows != NULL) {
+		platform_window_t* window = context->pending_windows;
+		x11_pending_t* pending = &window->pending;
+		context->pending_windows = pending->next;
+		// the event thread reads what was sent when the ConfigureNotify comes, and
+		// without the lock a request of its own could take the serial in between
+		XLockDisplay(context->dpy);
+		unsigned long serial = 0;
+		if(pending->flags & X11_PENDING_POSITION) {
+			serial = NextRequest(context->dpy);
+			XMoveWindow(context->dpy, window->handle, pending->x, pending->y);
+		}
+		if(pending->flags & X11_PENDING_SIZE) serial = send_window_size(context, window, pending->width, pending->height);
+		if(pending->flags & X11_PENDING_NAME) send_window_name(context, window);
+		x11_pending_sent(pending, (uint32_t)serial);
+		XUnlockDisplay(context->dpy);
+		pending->flags = 0;
+		pending->queued = 0;
+		pending->next = NULL;
+	}
+}
+
 platform_window_t* xlib_create_window(const platform_window_create_info_t create_info, platform_allocation_callbacks_t* allocator) {
 	int scr = DefaultScreen(linux_platform_context.xlib.dpy);
 	int depth = DefaultDepth(linux_platform_context.xlib.dpy, scr);
@@ -79,7 +237,9 @@ platform_window_t* xlib_create_window(const platform_window_create_info_t create
 
 	uint64_t event_mask = StructureNotifyMask | SubstructureNotifyMask |
 	                      SubstructureRedirectMask | ResizeRedirectMask |
-	                      ExposureMask | PropertyChangeMask;
+	                      ExposureMask | PropertyChangeMask | FocusChangeMask |
+	                      PointerMotionMask | KeyPressMask | KeyReleaseMask |
+	                      ButtonPressMask | ButtonReleaseMask;
 	uint64_t attributes_mask = CWBackPixel | CWEventMask;
 	XSetWindowAttributes attributes = {0};
 	attributes.background_pixel = BlackPixel(linux_platform_context.xlib.dpy, scr);
@@ -167,74 +327,386 @@ platform_window_t* xlib_create_window(const platform_window_create_info_t create
 	window->handle = handle;
 	window->active_flags = create_info.flags;
 	window->user_data = NULL;
+	window->x = create_info.x;
+	window->y = create_info.y;
+	window->width = create_info.width;
+	window->height = create_info.height;
 	window->mapped = 0;
+	window->focused = 0;
 	window->should_close = 0;
-	xlib_set_window_name(window, create_info.name);
+	window->reparented = 0;
+	window->resize_requested = 0;
+	window->next_resize_request = NULL;
+	window->image = NULL;
+	window->pixels = NULL;
+	window->present_pending = 0;
+	// the name has to be there before the window is mapped
+	x11_pending_init(&window->pending);
+	x11_pending_set_name(&window->pending, create_info.name);
+	send_window_name(&linux_platform_context.xlib, window);
+	window->pending.flags = 0;
 
+	XLockDisplay(linux_platform_context.xlib.dpy);
+	int8_t inserted = x11_window_map_insert(&linux_platform_context.xlib.windows, handle, window);
+	XUnlockDisplay(linux_platform_context.xlib.dpy);
+	if(!inserted) {
+		XDestroyWindow(linux_platform_context.xlib.dpy, handle);
+		x11_pending_free(&window->pending);
+		platform_allocator_free(window, allocator);
+		return NULL;
+	}
 	if((create_info.flags & PLATFORM_WF_UNMAPPED) == 0) xlib_map_window(window);
-	XSaveContext(linux_platform_context.xlib.dpy, handle, 0, (const char*)window);
 	return window;
 }
+static void destroy_framebuffer(xlib_context_t* context, platform_window_t* window);
+
 void xlib_destroy_window(platform_window_t* window, platform_allocation_callbacks_t* allocator) {
-	XDeleteContext(linux_platform_context.xlib.dpy, window->handle, 0);
+	destroy_framebuffer(&linux_platform_context.xlib, window);
+	unqueue_pending(&linux_platform_context.xlib, window);
+	x11_pending_free(&window->pending);
+	XLockDisplay(linux_platform_context.xlib.dpy);
+	x11_window_map_remove(&linux_platform_context.xlib.windows, window->handle);
+	event_queue_remove_window(&linux_platform_context.events, window);
+	if(linux_platform_context.xlib.focused_window == window) linux_platform_context.xlib.focused_window = NULL;
+	XUnlockDisplay(linux_platform_context.xlib.dpy);
+	// nothing new can be published for the window once it left the map
+	if(linux_platform_context.event_thread) event_ring_remove_window(&linux_platform_context.ring, window);
 	XDestroyWindow(linux_platform_context.xlib.dpy, window->handle);
 	platform_allocator_free(window, allocator);
 	XFlush(linux_platform_context.xlib.dpy);
 }
+// NOTE: the cached state is written by the event thread when there is one, XLockDisplay
+// does nothing unless XInitThreads was called so single threaded use pays nothing for it
 void xlib_get_window_position(const platform_window_t* window, int32_t* x, int32_t* y) {
-	XWindowAttributes attributes;
-	XGetWindowAttributes(linux_platform_context.xlib.dpy, window->handle, &attributes);
-	if(x) *x = attributes.x;
-	if(x) *y = attributes.y;
+	XLockDisplay(linux_platform_context.xlib.dpy);
+	if(x) *x = window->x;
+	if(y) *y = window->y;
+	XUnlockDisplay(linux_platform_context.xlib.dpy);
 }
 void xlib_get_window_size(const platform_window_t* window, uint32_t* width, uint32_t* height) {
+	XLockDisplay(linux_platform_context.xlib.dpy);
+	if(width) *width = window->width;
+	if(height) *height = window->height;
+	XUnlockDisplay(linux_platform_context.xlib.dpy);
+}
+// NOTE: this is a round trip to the server, only use it
+// when the cached state from the event loop is not good enough
+// window attributes and real ConfigureNotify events are relative to the parent,
+// which is the frame of a reparenting window manager and not the root window
+static void root_position(Display* dpy, const Window handle, int32_t* x, int32_t* y) {
+	int root_x = 0, root_y = 0;
+	Window child;
+	XTranslateCoordinates(dpy, handle, XDefaultRootWindow(dpy), 0, 0, &root_x, &root_y, &child);
+	*x = root_x;
+	*y = root_y;
+}
+
+void xlib_refresh_window_state(platform_window_t* window) {
 	XWindowAttributes attributes;
-	XGetWindowAttributes(linux_platform_context.xlib.dpy, window->handle, &attributes);
-	if(width) *width = attributes.width;
-	if(height) *height = attributes.height;
+	if(XGetWindowAttributes(linux_platform_context.xlib.dpy, window->handle, &attributes) == 0) return;
+	XLockDisplay(linux_platform_context.xlib.dpy);
+	int8_t reparented = window->reparented;
+	XUnlockDisplay(linux_platform_context.xlib.dpy);
+	int32_t x = attributes.x, y = attributes.y;
+	if(reparented) root_position(linux_platform_context.xlib.dpy, window->handle, &x, &y);
+	Window focus;
+	int revert_to;
+	XGetInputFocus(linux_platform_context.xlib.dpy, &focus, &revert_to);
+
+	XLockDisplay(linux_platform_context.xlib.dpy);
+	window->x = x;
+	window->y = y;
+	window->width = attributes.width;
+	window->height = attributes.height;
+	window->mapped = attributes.map_state != IsUnmapped;
+	window->focused = focus == window->handle;
+	XUnlockDisplay(linux_platform_context.xlib.dpy);
 }
 void xlib_set_window_position(platform_window_t* window, const int32_t x, const int32_t y) {
-	XMoveWindow(linux_platform_context.xlib.dpy, window->handle, x, y);
+	XLockDisplay(linux_platform_context.xlib.dpy);
+	x11_pending_set_position(&window->pending, x, y, window->x, window->y);
+	XUnlockDisplay(linux_platform_context.xlib.dpy);
+	queue_pending(&linux_platform_context.xlib, window);
 }
 void xlib_set_window_size(platform_window_t* window, const uint32_t width, const uint32_t height) {
-	XSetWindowAttributes new_attributes;
-	new_attributes.override_redirect = 1;
-	XChangeWindowAttributes(linux_platform_context.xlib.dpy, window->handle, CWOverrideRedirect, &new_attributes);
-	XResizeWindow(linux_platform_context.xlib.dpy, window->handle, width, height);
-	new_attributes.override_redirect = 0;
-	XChangeWindowAttributes(linux_platform_context.xlib.dpy, window->handle, CWOverrideRedirect, &new_attributes);
+	XLockDisplay(linux_platform_context.xlib.dpy);
+	x11_pending_set_size(&window->pending, width, height, window->width, window->height);
+	XUnlockDisplay(linux_platform_context.xlib.dpy);
+	queue_pending(&linux_platform_context.xlib, window);
 }
+// the name is only ever set by the app, so the one it asked for is the one the window has
 void xlib_get_window_name(const platform_window_t* window, char* name, uint32_t max_len) {
-	
+	x11_pending_get_name(&window->pending, name, max_len);
 }
 void xlib_set_window_name(platform_window_t* window, const char* name) {
-	if(name == NULL) {
-		XDeleteProperty(linux_platform_context.xlib.dpy, window->handle, linux_platform_context.xlib.net_wm_name);
-		XDeleteProperty(linux_platform_context.xlib.dpy, window->handle, XA_WM_NAME);
-	}
-	else {
-		uint32_t len = 0;
-		while(name[len] != '\0') len++;
-		XChangeProperty(linux_platform_context.xlib.dpy, window->handle, linux_platform_context.xlib.net_wm_name,
-		                linux_platform_context.xlib.utf8_string, 8, PropModeReplace, (const uint8_t*)name, len);
-		XChangeProperty(linux_platform_context.xlib.dpy, window->handle, XA_WM_NAME,
-		                XA_STRING, 8, PropModeReplace, (const uint8_t*)name, len);
-		XChangeProperty(linux_platform_context.xlib.dpy, window->handle, XA_WM_ICON_NAME,
-		                XA_STRING, 8, PropModeReplace, (const uint8_t*)name, len);
-		XChangeProperty(linux_platform_context.xlib.dpy, window->handle, linux_platform_context.xlib.net_wm_icon_name,
-		                linux_platform_context.xlib.utf8_string, 8, PropModeReplace, (const uint8_t*)name, len);
-	}
+	x11_pending_set_name(&window->pending, name);
+	queue_pending(&linux_platform_context.xlib, window);
+}
+void xlib_flush(void) {
+	xlib_context_t* context = &linux_platform_context.xlib;
+	send_pending(context);
+	XFlush(context->dpy);
 }
 
 void xlib_map_window(platform_window_t* window) {
+	// so the window shows up where and how it was asked for
+	send_pending(&linux_platform_context.xlib);
 	XMapRaised(linux_platform_context.xlib.dpy, window->handle);
 }
 void xlib_unmap_window(platform_window_t* window) {
 	XUnmapWindow(linux_platform_context.xlib.dpy, window->handle);
 }
 
+int8_t xlib_window_is_mapped(const platform_window_t* window) {
+	XLockDisplay(linux_platform_context.xlib.dpy);
+	int8_t mapped = window->mapped;
+	XUnlockDisplay(linux_platform_context.xlib.dpy);
+	return mapped;
+}
+int8_t xlib_window_has_focus(const platform_window_t* window) {
+	XLockDisplay(linux_platform_context.xlib.dpy);
+	int8_t focused = window->focused;
+	XUnlockDisplay(linux_platform_context.xlib.dpy);
+	return focused;
+}
+
 int8_t xlib_window_should_close(const platform_window_t* window) {
-	return window->should_close;
+	XLockDisplay(linux_platform_context.xlib.dpy);
+	int8_t should_close = window->should_close;
+	XUnlockDisplay(linux_platform_context.xlib.dpy);
+	return should_close;
+}
+
+// the handler is process wide and whichever thread reads an error calls it,
+// so it only takes the attach's own error and passes everything else on
+static unsigned long shm_attach_serial;
+static int8_t shm_error;
+static int (*shm_previous_handler)(Display*, XErrorEvent*);
+static int shm_error_handler(Display* dpy, XErrorEvent* e) {
+	if(e->serial == shm_attach_serial) {
+		shm_error = 1;
+		return 0;
+	}
+	return shm_previous_handler(dpy, e);
+}
+// attaching only fails with an error, which comes back when the server is not on this machine
+static int8_t attach_shm(Display* dpy, XShmSegmentInfo* shm) {
+	// keeps the event thread out while the handler is swapped
+	XLockDisplay(dpy);
+	shm_error = 0;
+	shm_attach_serial = NextRequest(dpy);
+	shm_previous_handler = XSetErrorHandler(shm_error_handler);
+	XShmAttach(dpy, shm);
+	XSync(dpy, False);
+	XSetErrorHandler(shm_previous_handler);
+	int8_t attached = !shm_error;
+	XUnlockDisplay(dpy);
+	return attached;
+}
+
+static XImage* create_shm_image(xlib_context_t* context, Visual* visual, const int depth, XShmSegmentInfo* shm,
+                                const uint32_t width, const uint32_t height) {
+	XImage* image = XShmCreateImage(context->dpy, visual, depth, ZPixmap, NULL, shm, width, height);
+	if(image == NULL) return NULL;
+	shm->shmid = shmget(IPC_PRIVATE, (size_t)image->bytes_per_line * height, IPC_CREAT | 0600);
+	if(shm->shmid != -1) {
+		shm->shmaddr = image->data = shmat(shm->shmid, NULL, 0);
+		shm->readOnly = False;
+		if(shm->shmaddr != (char*)-1 && attach_shm(context->dpy, shm)) {
+			// freed once both sides detached
+			shmctl(shm->shmid, IPC_RMID, NULL);
+			return image;
+		}
+		if(shm->shmaddr != (char*)-1) shmdt(shm->shmaddr);
+		shmctl(shm->shmid, IPC_RMID, NULL);
+		context->shm_available = 0;
+		platform_log(PLATFORM_LOG_LEVEL_DEBUG, "MIT-SHM unusable, framebuffers are sent with XPutImage");
+	}
+	image->data = NULL;
+	XDestroyImage(image);
+	return NULL;
+}
+
+static int8_t create_framebuffer(xlib_context_t* context, platform_window_t* window, const uint32_t width, const uint32_t height) {
+	int screen = DefaultScreen(context->dpy);
+	Visual* visual = DefaultVisual(context->dpy, screen);
+	int depth = DefaultDepth(context->dpy, screen);
+	// visuals that take 0x00RRGGBB as it is, like the xcb backend, and 16 bit ones
+	// the pixels are converted for. anything else has no framebuffer
+	int8_t bgrx = (depth == 24 || depth == 32) && visual->red_mask == 0xff0000 && visual->green_mask == 0xff00 && visual->blue_mask == 0xff;
+	int8_t rgb565 = depth == 16 && visual->red_mask == 0xf800 && visual->green_mask == 0x7e0 && visual->blue_mask == 0x1f;
+	if(!bgrx && !rgb565) return 0;
+	uint32_t pixel_size = rgb565 ? sizeof(uint16_t) : sizeof(uint32_t);
+	window->pixels = NULL;
+	if(rgb565) {
+		window->pixels = calloc((size_t)width * height, sizeof(uint32_t));
+		if(window->pixels == NULL) return 0;
+	}
+	window->image = NULL;
+	if(context->shm_available) window->image = create_shm_image(context, visual, depth, &window->shm, width, height);
+	if(window->image == NULL) {
+		window->shm.shmid = -1;
+		char* data = calloc((size_t)width * height, pixel_size);
+		if(data != NULL) {
+			window->image = XCreateImage(context->dpy, visual, depth, ZPixmap, 0, data, width, height, pixel_size * 8, width * pixel_size);
+		}
+		if(window->image == NULL) free(data);
+	}
+	if(window->image == NULL) {
+		free(window->pixels);
+		window->pixels = NULL;
+		return 0;
+	}
+	return 1;
+}
+
+// the event thread takes the ShmCompletion out of the queue itself and signals present_done
+static void wait_present_event_thread(xlib_context_t* context, platform_window_t* window) {
+	struct timespec deadline;
+	timespec_get(&deadline, TIME_UTC);
+	deadline.tv_nsec += PRESENT_TIMEOUT_NS;
+	if(deadline.tv_nsec >= 1000000000) {
+		deadline.tv_sec++;
+		deadline.tv_nsec -= 1000000000;
+	}
+	mtx_lock(&context->present_lock);
+	while(window->present_pending) {
+		if(cnd_timedwait(&context->present_done, &context->present_lock, &deadline) == thrd_timedout) {
+			platform_log(PLATFORM_LOG_LEVEL_WARN, "framebuffer present did not complete");
+			window->present_pending = 0;
+		}
+	}
+	mtx_unlock(&context->present_lock);
+}
+
+// waits for the ShmCompletion of the last present, without an event thread
+// it is picked out of the queue here
+static void wait_present(xlib_context_t* context, platform_window_t* window) {
+	if(linux_platform_context.event_thread) {
+		wait_present_event_thread(context, window);
+		return;
+	}
+	uint64_t deadline = platform_get_timestamp() + PRESENT_TIMEOUT_NS;
+	while(window->present_pending) {
+		XEvent e;
+		if(XCheckTypedWindowEvent(context->dpy, window->handle, context->shm_completion_event, &e)) {
+			window->present_pending = 0;
+			break;
+		}
+		if(platform_get_timestamp() > deadline) {
+			platform_log(PLATFORM_LOG_LEVEL_WARN, "framebuffer present did not complete");
+			window->present_pending = 0;
+			break;
+		}
+		struct pollfd fd = { .fd = ConnectionNumber(context->dpy), .events = POLLIN };
+		poll(&fd, 1, 1);
+	}
+}
+
+static void destroy_framebuffer(xlib_context_t* context, platform_window_t* window) {
+	if(window->image == NULL) return;
+	if(window->shm.shmid != -1) {
+		wait_present(context, window);
+		XShmDetach(context->dpy, &window->shm);
+		shmdt(window->shm.shmaddr);
+		window->image->data = NULL;
+	}
+	XDestroyImage(window->image);
+	window->image = NULL;
+	free(window->pixels);
+	window->pixels = NULL;
+}
+
+int8_t xlib_window_get_framebuffer(platform_window_t* window, platform_framebuffer_t* framebuffer) {
+	xlib_context_t* context = &linux_platform_context.xlib;
+	XLockDisplay(context->dpy);
+	uint32_t width = window->width, height = window->height;
+	XUnlockDisplay(context->dpy);
+	if(window->image != NULL && ((uint32_t)window->image->width != width || (uint32_t)window->image->height != height)) {
+		destroy_framebuffer(context, window);
+	}
+	if(window->image == NULL && !create_framebuffer(context, window, width, height)) return 0;
+	wait_present(context, window);
+
+	framebuffer->width = width;
+	framebuffer->height = height;
+	if(window->pixels != NULL) {
+		framebuffer->pixels = window->pixels;
+		framebuffer->stride = width;
+		return 1;
+	}
+	framebuffer->pixels = (uint32_t*)window->image->data;
+	framebuffer->stride = window->image->bytes_per_line / sizeof(uint32_t);
+	return 1;
+}
+
+// clips the rectangle to the image, returns 0 if nothing is left
+static inline int8_t clip_rect(const XImage* image, const platform_rect_t* rect, platform_rect_t* clipped) {
+	int64_t x0 = rect->x > 0 ? rect->x : 0;
+	int64_t y0 = rect->y > 0 ? rect->y : 0;
+	int64_t x1 = (int64_t)rect->x + rect->width < image->width ? (int64_t)rect->x + rect->width : image->width;
+	int64_t y1 = (int64_t)rect->y + rect->height < image->height ? (int64_t)rect->y + rect->height : image->height;
+	if(x0 >= x1 || y0 >= y1) return 0;
+	clipped->x = x0;
+	clipped->y = y0;
+	clipped->width = x1 - x0;
+	clipped->height = y1 - y0;
+	return 1;
+}
+
+void xlib_window_present(platform_window_t* window, const platform_rect_t* damage, const uint32_t damage_count) {
+	xlib_context_t* context = &linux_platform_context.xlib;
+	if(window->image == NULL) return;
+	platform_rect_t whole = { 0, 0, window->image->width, window->image->height };
+	uint32_t count = damage_count;
+	if(count == 0) {
+		damage = &whole;
+		count = 1;
+	}
+	GC gc = DefaultGC(context->dpy, DefaultScreen(context->dpy));
+	// requests are handled in order, only the last one has to report completion
+	uint32_t last = count;
+	platform_rect_t rect;
+	for(uint32_t i = 0; i < count; i++) {
+		if(clip_rect(window->image, &damage[i], &rect)) last = i;
+	}
+	if(window->pixels != NULL) {
+		// the app draws without waiting when its pixels are apart from the image
+		wait_present(context, window);
+		for(uint32_t i = 0; i < count; i++) {
+			if(!clip_rect(window->image, &damage[i], &rect)) continue;
+			for(uint32_t y = rect.y; y < (uint32_t)rect.y + rect.height; y++) {
+				uint16_t* row = (uint16_t*)(window->image->data + (size_t)y * window->image->bytes_per_line);
+				pixel_kernels.bgrx_to_rgb565(row + rect.x, window->pixels + (size_t)y * window->image->width + rect.x, rect.width);
+			}
+		}
+	}
+	// set first, the event thread could see the completion before the requests return
+	if(last != count && window->shm.shmid != -1) {
+		if(linux_platform_context.event_thread) mtx_lock(&context->present_lock);
+		window->present_pending = 1;
+		if(linux_platform_context.event_thread) mtx_unlock(&context->present_lock);
+	}
+	for(uint32_t i = 0; i < count; i++) {
+		if(!clip_rect(window->image, &damage[i], &rect)) continue;
+		if(window->shm.shmid != -1) {
+			XShmPutImage(context->dpy, window->handle, gc, window->image, rect.x, rect.y, rect.x, rect.y,
+			             rect.width, rect.height, i == last);
+		}
+		else {
+			XPutImage(context->dpy, window->handle, gc, window->image, rect.x, rect.y, rect.x, rect.y, rect.width, rect.height);
+		}
+	}
+	XFlush(context->dpy);
+}
+
+uint32_t xlib_get_monitors(platform_monitor_t* monitors, const uint32_t max_count) {
+	xlib_context_t* context = &linux_platform_context.xlib;
+	XLockDisplay(context->dpy);
+	uint32_t count = context->monitor_count < max_count ? context->monitor_count : max_count;
+	memcpy(monitors, context->monitors, count * sizeof(platform_monitor_t));
+	XUnlockDisplay(context->dpy);
+	return count;
 }
 
 char** xlib_vulkan_required_extensions(uint32_t* extension_count) {
@@ -260,87 +732,298 @@ VkSurfaceKHR xlib_vulkan_create_surface(platform_window_t* window, VkInstance in
 	return surface;
 }
 
-void xlib_handle_events(void) {
-	uint32_t event_count = XPending(linux_platform_context.xlib.dpy);
-	for(uint32_t i = 0; i < event_count; i++) {
-		XEvent e;
-		XNextEvent(linux_platform_context.xlib.dpy, &e);
+Window xlib_get_window_handle(const platform_window_t* window) {
+	return window->handle;
+}
 
-		platform_window_t* window;
-		int context_result = XFindContext(linux_platform_context.xlib.dpy, e.xany.window, 0, (XPointer*)&window);
-		if(context_result != 0) continue;
+static void update_position(platform_window_t* window, const int32_t x, const int32_t y, const uint64_t timestamp) {
+	if(x == window->x && y == window->y) return;
+	window->x = x;
+	window->y = y;
+	platform_event_t event = {0};
+	event.type = PLATFORM_EVENT_MOVE;
+	event.window = window;
+	event.timestamp = timestamp;
+	event.move.x = x;
+	event.move.y = y;
+	event_queue_push(&linux_platform_context.events, &event);
+}
 
-		XWindowAttributes attributes;
-		XGetWindowAttributes(linux_platform_context.xlib.dpy, window->handle, &attributes);
+static void handle_event(xlib_context_t* context, XEvent* e, const uint64_t timestamp, platform_window_t** resize_requests) {
+	event_queue_t* queue = &linux_platform_context.events;
+	if(e->type == GenericEvent) {
+		platform_event_t event = {0};
+		if(xlib_translate_generic_event(context, &e->xcookie, &event)) event_queue_push(queue, &event);
+		return;
+	}
+	// sent to the root window, which is not in the map
+	if(xlib_monitors_handle_event(context, e)) return;
+	platform_window_t* window = x11_window_map_find(&context->windows, e->xany.window);
+	if(window == NULL) return;
+	if(e->type == context->shm_completion_event) {
+		if(!linux_platform_context.event_thread) {
+			window->present_pending = 0;
+			return;
+		}
+		mtx_lock(&context->present_lock);
+		window->present_pending = 0;
+		cnd_broadcast(&context->present_done);
+		mtx_unlock(&context->present_lock);
+		return;
+	}
 
-		switch (e.type)
-		{
-		case ClientMessage:
-			if(e.xclient.data.l[0] == linux_platform_context.xlib.wm_delete_window) {
-				window->should_close = 1;
-			}
-			break;
-		case PropertyNotify:
-			//platform_terminal_print("Property Notify Event.\n", 0, 0, 0);
-			break;
-		case ResizeRequest:
-			xlib_set_window_size(window, e.xresizerequest.width, e.xresizerequest.height);
-			break;
-		case CirculateNotify:
-			platform_terminal_print("Circulate Notify Event.\n", 0, 0, 0);
-			break;
-		case ConfigureNotify:
-			break;
-		case DestroyNotify:
-			platform_terminal_print("Destroy Notify Event.\n", 0, 0, 0);
-			break;
-		case GravityNotify:
-			platform_terminal_print("Gravity Notify Event.\n", 0, 0, 0);
-			break;
-		case MapNotify:
-			// changing this property at window creation caused the window to
-			// be floating in bspwm, placing here prevents that while making the
-			// window not resizable, at least on ubuntu
-			if((window->active_flags & PLATFORM_WF_RESIZABLE) == 0) {
-				uint32_t w, h;
-				xlib_get_window_size(window, &w, &h);
-				XSizeHints size_hints;
-				window->mapped = 1;
-				size_hints.flags = PPosition;
-				size_hints.min_width = size_hints.max_width = w;
-				size_hints.min_height = size_hints.max_height = h;
-				size_hints.flags |= PMinSize | PMaxSize;
-				XSetWMNormalHints(linux_platform_context.xlib.dpy, window->handle, &size_hints);
-			}
+	platform_event_t event = {0};
+	event.window = window;
+	event.timestamp = timestamp;
+	switch (e->type)
+	{
+	case ClientMessage:
+		if((Atom)e->xclient.data.l[0] == context->wm_delete_window) {
+			window->should_close = 1;
+			event.type = PLATFORM_EVENT_CLOSE;
+		}
+		break;
+	case ResizeRequest:
+		if(!window->resize_requested) {
+			window->resize_requested = 1;
+			window->next_resize_request = *resize_requests;
+			*resize_requests = window;
+		}
+		window->requested_width = e->xresizerequest.width;
+		window->requested_height = e->xresizerequest.height;
+		break;
+	case ConfigureNotify: {
+		// SubstructureNotifyMask also reports changes to child windows
+		if(e->xconfigure.window != window->handle) break;
+		x11_pending_configured(&window->pending, (uint32_t)e->xconfigure.serial);
+		// the window manager sends synthetic ones in root coordinates when it moves the frame
+		if(e->xconfigure.send_event || !window->reparented) {
+			update_position(window, e->xconfigure.x, e->xconfigure.y, timestamp);
+		}
+		else {
+			x11_position_queries_add(&context->position_queries, (uint32_t)window->handle);
+		}
+		if((uint32_t)e->xconfigure.width != window->width || (uint32_t)e->xconfigure.height != window->height) {
+			window->width = e->xconfigure.width;
+			window->height = e->xconfigure.height;
+			event.type = PLATFORM_EVENT_RESIZE;
+			event.resize.width = window->width;
+			event.resize.height = window->height;
+			event_queue_push(queue, &event);
+		}
+		event.type = PLATFORM_EVENT_NONE;
+		break;
+	}
+	case ReparentNotify:
+		if(e->xreparent.window != window->handle) break;
+		window->reparented = e->xreparent.parent != DefaultRootWindow(context->dpy);
+		break;
+	case MapNotify:
+		if(e->xmap.window != window->handle) break;
+		window->mapped = 1;
+		event.type = PLATFORM_EVENT_MAP;
+		// changing this property at window creation caused the window to
+		// be floating in bspwm, placing here prevents that while making the
+		// window not resizable, at least on ubuntu
+		if((window->active_flags & PLATFORM_WF_RESIZABLE) == 0) {
+			XSizeHints size_hints;
+			size_hints.flags = PPosition;
+			size_hints.min_width = size_hints.max_width = window->width;
+			size_hints.min_height = size_hints.max_height = window->height;
+			size_hints.flags |= PMinSize | PMaxSize;
+			XSetWMNormalHints(context->dpy, window->handle, &size_hints);
+		}
+		break;
+	case UnmapNotify:
+		if(e->xunmap.window != window->handle) break;
+		window->mapped = 0;
+		event.type = PLATFORM_EVENT_UNMAP;
+		break;
+	case FocusIn:
+		if(window->focused) break;
+		window->focused = 1;
+		context->focused_window = window;
+		event.type = PLATFORM_EVENT_FOCUS_IN;
+		break;
+	case FocusOut:
+		if(!window->focused) break;
+		window->focused = 0;
+		if(context->focused_window == window) context->focused_window = NULL;
+		// releases while unfocused are never seen
+		memset(context->keys_down, 0, sizeof(context->keys_down));
+		event.type = PLATFORM_EVENT_FOCUS_OUT;
+		break;
+	case Expose:
+		event.type = PLATFORM_EVENT_EXPOSE;
+		event.expose.x = e->xexpose.x;
+		event.expose.y = e->xexpose.y;
+		event.expose.width = e->xexpose.width;
+		event.expose.height = e->xexpose.height;
+		break;
+	case MotionNotify:
+		event.type = PLATFORM_EVENT_MOUSE_MOVE;
+		event.mouse_move.x = e->xmotion.x;
+		event.mouse_move.y = e->xmotion.y;
+		event.timestamp = x11_server_time_to_timestamp(&context->server_time, e->xmotion.time);
+		break;
+	case KeyPress:
+	case KeyRelease:
+		xlib_translate_key(context, &e->xkey, &event);
+		break;
+	case ButtonPress:
+	case ButtonRelease:
+		xlib_translate_button(context, &e->xbutton, &event);
+		break;
 
-			platform_terminal_print("Map Notify Event.\n", 0, 0, 0);
-			break;
-		case ReparentNotify:
-			platform_terminal_print("Reparent Notify Event.\n", 0, 0, 0);
-			break;
-		case UnmapNotify:
-			platform_terminal_print("Unmap Notify Event.\n", 0, 0, 0);
-			break;
-		case CreateNotify:
-			platform_terminal_print("Create Notify Event.\n", 0, 0, 0);
-			break;
-		case CirculateRequest:
-			platform_terminal_print("Circulate Request Event.\n", 0, 0, 0);
-			break;
-		case ConfigureRequest:
-			platform_terminal_print("Configure Request Event.\n", 0, 0, 0);
-			break;
-		case MapRequest:
-			platform_terminal_print("Map Request Event.\n", 0, 0, 0);
-			break;
+	case PropertyNotify:
+	case CirculateNotify:
+	case DestroyNotify:
+	case GravityNotify:
+	case CreateNotify:
+	case CirculateRequest:
+	case ConfigureRequest:
+	case MapRequest:
+	case MappingNotify:
+	case SelectionClear:
+	case SelectionNotify:
+		break;
+	default:
+		// window managers cause plenty of events nothing here needs, like GravityNotify
+		break;
+	}
+	if(event.type != PLATFORM_EVENT_NONE) event_queue_push(queue, &event);
+}
 
-		case MappingNotify: break;
-		case SelectionClear: break;
-		case SelectionNotify: break;
-		case Expose:
-			break;
-		default:
-			platform_terminal_print("Unkown Event.\n", 0, 0, 0);
+// a drag resize can send many requests, each one would flip override redirect twice
+static void apply_resize_requests(platform_window_t* resize_requests) {
+	while(resize_requests != NULL) {
+		platform_window_t* window = resize_requests;
+		resize_requests = window->next_resize_request;
+		window->resize_requested = 0;
+		window->next_resize_request = NULL;
+		send_window_size(&linux_platform_context.xlib, window, window->requested_width, window->requested_height);
+	}
+}
+// one round trip per window and batch. Xlib cannot have several queries in flight,
+// and the display stays locked since translating a window the app destroyed in
+// between would be an error
+static void collect_positions(xlib_context_t* context, const uint64_t timestamp) {
+	x11_position_queries_t* queries = &context->position_queries;
+	for(uint32_t i = 0; i < queries->count; i++) {
+		platform_window_t* window = x11_window_map_find(&context->windows, queries->queries[i].handle);
+		if(window == NULL) continue;
+		int32_t x, y;
+		root_position(context->dpy, window->handle, &x, &y);
+		update_position(window, x, y, timestamp);
+	}
+	queries->count = 0;
+}
+void xlib_handle_events(void) {
+	xlib_context_t* context = &linux_platform_context.xlib;
+	// the event thread only ever flushes while reading, requests made here would wait for the next event
+	send_pending(context);
+	if(linux_platform_context.event_thread) {
+		XFlush(context->dpy);
+		return;
+	}
+	platform_window_t* resize_requests = NULL;
+	// everything handled here arrived before this point
+	uint64_t timestamp = platform_get_timestamp();
+
+	uint32_t event_count = XPending(context->dpy);
+	for(uint32_t i = 0; i < event_count; i++) {
+		XEvent e;
+		XNextEvent(context->dpy, &e);
+		handle_event(context, &e, timestamp, &resize_requests);
+	}
+	apply_resize_requests(resize_requests);
+	collect_positions(context, timestamp);
+	xlib_monitors_update(context);
+}
+int8_t xlib_wait_events(const uint64_t timeout_ns) {
+	Display* dpy = linux_platform_context.xlib.dpy;
+	// XPending flushes them along with everything else
+	send_pending(&linux_platform_context.xlib);
+	// events may already be sitting in the Xlib queue, in which case
+	// the connection fd will not become readable for them
+	if(XPending(dpy) == 0) {
+		struct pollfd fds[2] = {
+			{ .fd = ConnectionNumber(dpy), .events = POLLIN },
+			{ .fd = linux_platform_context.wake_fd, .events = POLLIN }
+		};
+		struct timespec timeout;
+		timeout.tv_sec = timeout_ns / 1000000000;
+		timeout.tv_nsec = timeout_ns % 1000000000;
+		int result = ppoll(fds, 2, timeout_ns == PLATFORM_WAIT_INFINITE ? NULL : &timeout, NULL);
+		if(result <= 0) return 0;
+		if(fds[1].revents & POLLIN) {
+			uint64_t count;
+			while(read(linux_platform_context.wake_fd, &count, sizeof(count)) > 0);
+		}
+	}
+	xlib_handle_events();
+	return 1;
+}
+
+static int event_thread_main(void* data) {
+	xlib_context_t* context = &linux_platform_context.xlib;
+	while(!atomic_load(&context->event_thread_stopping)) {
+		// blocks without the display lock, Xlib wakes it for events read by the app thread as well
+		XEvent e;
+		XNextEvent(context->dpy, &e);
+
+		XLockDisplay(context->dpy);
+		platform_window_t* resize_requests = NULL;
+		uint64_t timestamp = platform_get_timestamp();
+		handle_event(context, &e, timestamp, &resize_requests);
+		// whatever else already arrived goes out in the same batch
+		uint32_t event_count = XPending(context->dpy);
+		for(uint32_t i = 0; i < event_count; i++) {
+			XNextEvent(context->dpy, &e);
+			handle_event(context, &e, timestamp, &resize_requests);
 		}
+		apply_resize_requests(resize_requests);
+	collect_positions(context, timestamp);
+		xlib_monitors_update(context);
+		linux_publish_events();
+		XUnlockDisplay(context->dpy);
+	}
+	return 0;
+}
+
+int8_t xlib_start_event_thread(void) {
+	xlib_context_t* context = &linux_platform_context.xlib;
+	context->event_thread_window = XCreateWindow(context->dpy, DefaultRootWindow(context->dpy), 0, 0, 1, 1, 0,
+	                                             CopyFromParent, InputOnly, CopyFromParent, 0, NULL);
+	atomic_store(&context->event_thread_stopping, 0);
+	mtx_init(&context->present_lock, mtx_plain);
+	cnd_init(&context->present_done);
+	if(thrd_create(&context->event_thread, event_thread_main, NULL) != thrd_success) {
+		cnd_destroy(&context->present_done);
+		mtx_destroy(&context->present_lock);
+		XDestroyWindow(context->dpy, context->event_thread_window);
+		return 0;
 	}
-}
\ No newline at end of file
+	return 1;
+}
+void xlib_stop_event_thread(void) {
+	xlib_context_t* context = &linux_platform_context.xlib;
+	atomic_store(&context->event_thread_stopping, 1);
+	// with an empty event mask the message goes to the window's creator, which is us
+	XClientMessageEvent message = {0};
+	message.type = ClientMessage;
+	message.window = context->event_thread_window;
+	message.format = 32;
+	XSendEvent(context->dpy, context->event_thread_window, False, 0, (XEvent*)&message);
+	XFlush(context->dpy);
+	thrd_join(context->event_thread, NULL);
+	cnd_destroy(&context->present_done);
+	mtx_destroy(&context->present_lock);
+	XDestroyWindow(context->dpy, context->event_thread_window);
+}
+
+void xlib_publish_backlog(void) {
+	XLockDisplay(linux_platform_context.xlib.dpy);
+	linux_publish_events();
+	XUnlockDisplay(linux_platform_context.xlib.dpy);
+}
@@ -9,35 +9,60 @@
 	.destroy_window = xlib_destroy_window, \
 	.get_window_position = xlib_get_window_position, \
 	.get_window_size = xlib_get_window_size, \
+	.refresh_window_state = xlib_refresh_window_state, \
 	.set_window_position = xlib_set_window_position, \
 	.set_window_size = xlib_set_window_size, \
 	.get_window_name = xlib_get_window_name, \
 	.set_window_name = xlib_set_window_name, \
 	.map_window = xlib_map_window, \
 	.unmap_window = xlib_unmap_window, \
+	.window_is_mapped = xlib_window_is_mapped, \
+	.window_has_focus = xlib_window_has_focus, \
 	.window_should_close = xlib_window_should_close, \
+	.get_framebuffer = xlib_window_get_framebuffer, \
+	.present = xlib_window_present, \
+	.get_monitors = xlib_get_monitors, \
 	.vulkan_required_extensions = xlib_vulkan_required_extensions, \
 	.vulkan_create_surface = xlib_vulkan_create_surface, \
-	.handle_events = xlib_handle_events \
+	.flush = xlib_flush, \
+	.handle_events = xlib_handle_events, \
+	.wait_events = xlib_wait_events, \
+	.start_event_thread = xlib_start_event_thread, \
+	.stop_event_thread = xlib_stop_event_thread, \
+	.publish_backlog = xlib_publish_backlog \
 }
 
-int8_t xlib_init_context(xlib_context_t* context);
+int8_t xlib_init_context(xlib_context_t* context, const int8_t threaded);
 void xlib_cleanup_context(xlib_context_t* context);
 
 platform_window_t* xlib_create_window(const platform_window_create_info_t create_info, platform_allocation_callbacks_t* allocator);
 void xlib_destroy_window(platform_window_t* window, platform_allocation_callbacks_t* allocator);
 void xlib_get_window_position(const platform_window_t* window, int32_t* x, int32_t* y);
 void xlib_get_window_size(const platform_window_t* window, uint32_t* width, uint32_t* height);
+void xlib_refresh_window_state(platform_window_t* window);
 void xlib_set_window_position(platform_window_t* window, const int32_t x, const int32_t y);
 void xlib_set_window_size(platform_window_t* window, const uint32_t width, const uint32_t height);
 void xlib_get_window_name(const platform_window_t* window, char* name, uint32_t max_len);
 void xlib_set_window_name(platform_window_t* window, const char* name);
 void xlib_map_window(platform_window_t* window);
 void xlib_unmap_window(platform_window_t* window);
+int8_t xlib_window_is_mapped(const platform_window_t* window);
+int8_t xlib_window_has_focus(const platform_window_t* window);
 int8_t xlib_window_should_close(const platform_window_t* window);
+int8_t xlib_window_get_framebuffer(platform_window_t* window, platform_framebuffer_t* framebuffer);
+void xlib_window_present(platform_window_t* window, const platform_rect_t* damage, const uint32_t damage_count);
+uint32_t xlib_get_monitors(platform_monitor_t* monitors, const uint32_t max_count);
 char** xlib_vulkan_required_extensions(uint32_t* extension_count);
 VkSurfaceKHR xlib_vulkan_create_surface(platform_window_t* window, VkInstance instance);
 
+// the X window behind a platform window, for code that talks to the server directly
+Window xlib_get_window_handle(const platform_window_t* window);
+
+void xlib_flush(void);
 void xlib_handle_events(void);
+int8_t xlib_wait_events(const uint64_t timeout_ns);
+int8_t xlib_start_event_thread(void);
+void xlib_stop_event_thread(void);
+void xlib_publish_backlog(void);
 
 #endif // XLIB_WINDOW_H
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "platform/platform.h"
+#include "common/event_queue.h"
+#include "common/pixel_kernels.h"
 
 #define WIN32_LEAN_AND_MEAN
 #define NOGDICAPMASKS
@@ -6,7 +8,6 @@
 #define NOMENUS
 #define NOICONS
 #define NOSYSCOMMANDS
-#define NORASTEROPS
 #define OEMRESOURCE
 #define NOATOM
 #define NOCLIPBOARD
@@ -42,12 +43,22 @@
 #include <vulkan/vulkan.h>
 #include <timeapi.h>
 #include <malloc.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
 
 #define DEFAULT_CLASS_NAME "WIN32_PLATFORM_CLASS"
 
 typedef struct win32_context_t {
 	HINSTANCE instance;
 	char* class_name;
+	HANDLE wake_event;
+	event_queue_t events;
+	// enumerated again after WM_DISPLAYCHANGE
+	int8_t monitors_valid;
+	uint32_t monitor_count;
+	platform_monitor_t monitors[PLATFORM_MAX_MONITORS];
+	HMONITOR monitor_handles[PLATFORM_MAX_MONITORS];
 } win32_context_t;
 
 static win32_context_t context;
@@ -55,6 +66,12 @@ static win32_context_t context;
 struct platform_window_t {
 	HWND handle;
 	int8_t should_close;
+	// a dib section selected into a memory dc, NULL until the framebuffer is first asked for
+	HDC framebuffer_dc;
+	HBITMAP framebuffer_bitmap;
+	HGDIOBJ framebuffer_previous;
+	uint32_t* framebuffer_pixels;
+	uint32_t framebuffer_width, framebuffer_height;
 };
 
 static inline void* platform_allocator_alloc(uint64_t size, uint64_t alignment, platform_allocation_callbacks_t* allocator) {
@@ -108,12 +125,26 @@ int8_t platform_init(const platform_settings_t* settings) {
 	ATOM class_result = RegisterClassExA(&class);
 	if(class_result == 0) return 0;
 
+	context.wake_event = CreateEventA(NULL, FALSE, FALSE, NULL);
+	if(context.wake_event == NULL) {
+		UnregisterClassA(DEFAULT_CLASS_NAME, instance);
+		return 0;
+	}
+
+	// relative mouse motion as WM_INPUT, delivered to whichever window has focus
+	RAWINPUTDEVICE mouse = { .usUsagePage = 0x01, .usUsage = 0x02, .dwFlags = 0, .hwndTarget = NULL };
+	RegisterRawInputDevices(&mouse, 1, sizeof(mouse));
+
+	pixel_kernels_init();
 	context.instance = instance;
 	context.class_name = DEFAULT_CLASS_NAME;
+	event_queue_init(&context.events);
 	return 1;
 }
 
 void platform_shutdown(void) {
+	platform_tracking_report_leaks();
+	CloseHandle(context.wake_event);
 	UnregisterClassA(context.class_name, context.instance);
 }
 
@@ -162,10 +193,28 @@ platform_window_t* platform_create_window(const platform_window_create_info_t cr
 
 	window->handle = handle;
 	window->should_close = 0;
+	window->framebuffer_dc = NULL;
+	window->framebuffer_bitmap = NULL;
+	window->framebuffer_previous = NULL;
+	window->framebuffer_pixels = NULL;
+	window->framebuffer_width = 0;
+	window->framebuffer_height = 0;
 	return window;
 }
+static void destroy_framebuffer(platform_window_t* window) {
+	if(window->framebuffer_dc == NULL) return;
+	SelectObject(window->framebuffer_dc, window->framebuffer_previous);
+	DeleteObject(window->framebuffer_bitmap);
+	DeleteDC(window->framebuffer_dc);
+	window->framebuffer_dc = NULL;
+	window->framebuffer_bitmap = NULL;
+	window->framebuffer_pixels = NULL;
+}
+
 void platform_destroy_window( platform_window_t* window, platform_allocation_callbacks_t* allocator) {
+	destroy_framebuffer(window);
 	DestroyWindow(window->handle);
+	event_queue_remove_window(&context.events, window);
 	platform_allocator_free(window, allocator);
 }
 void platform_get_window_position(const platform_window_t* window, int32_t* x, int32_t* y) {
@@ -178,7 +227,10 @@ void platform_get_window_size(const platform_window_t* window, uint32_t* width,
 	RECT cr;
 	GetClientRect(window->handle, &cr);
 	if(width) *width = cr.right - cr.left;
-	if(width) *width = cr.bottom - cr.top;
+	if(height) *height = cr.bottom - cr.top;
+}
+void platform_refresh_window_state(platform_window_t* window) {
+	// window state is always queried directly on win32
 }
 void platform_set_window_position(platform_window_t* window, const int32_t x, const int32_t y) {
 	RECT wr;
@@ -215,6 +267,13 @@ void platform_unmap_window(platform_window_t* window) {
 	ShowWindow(window->handle, SW_HIDE);
 }
 
+int8_t platform_window_is_mapped(const platform_window_t* window) {
+	return IsWindowVisible(window->handle) != 0;
+}
+int8_t platform_window_has_focus(const platform_window_t* window) {
+	return GetForegroundWindow() == window->handle;
+}
+
 int8_t platform_window_should_close(const platform_window_t* window) {
 	return window->should_close;
 }
@@ -237,6 +296,9 @@ VkSurfaceKHR platform_vulkan_create_surface(platform_window_t* window, VkInstanc
 	return surface;
 }
 
+// the setters call into user32 right away, there is nothing to send
+void platform_flush(void) {
+}
 void platform_handle_events(void) {
 	// while context is not needed here, it is needed by the linux platform
 	MSG msg;
@@ -246,6 +308,218 @@ void platform_handle_events(void) {
 	}
 }
 
+int8_t platform_wait_events(const uint64_t timeout_ns) {
+	DWORD timeout_ms = INFINITE;
+	if(timeout_ns != PLATFORM_WAIT_INFINITE) {
+		uint64_t ms = (timeout_ns + 999999) / 1000000;
+		timeout_ms = ms >= INFINITE ? INFINITE - 1 : (DWORD)ms;
+	}
+	DWORD result = MsgWaitForMultipleObjectsEx(1, &context.wake_event, timeout_ms, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+	if(result == WAIT_TIMEOUT || result == WAIT_FAILED) return 0;
+	platform_handle_events();
+	return 1;
+}
+void platform_wake(void) {
+	SetEvent(context.wake_event);
+}
+
+int8_t platform_poll_event(platform_event_t* event) {
+	return event_queue_pop(&context.events, event);
+}
+uint64_t platform_event_dropped_count(void) {
+	return atomic_load_explicit(&context.events.dropped, memory_order_relaxed);
+}
+
+// a top down 32 bit dib is laid out as 0x00RRGGBB, so it is handed out as is
+int8_t platform_window_get_framebuffer(platform_window_t* window, platform_framebuffer_t* framebuffer) {
+	RECT client_rect;
+	GetClientRect(window->handle, &client_rect);
+	uint32_t width = client_rect.right - client_rect.left;
+	uint32_t height = client_rect.bottom - client_rect.top;
+	if(width == 0 || height == 0) return 0;
+
+	if(window->framebuffer_dc == NULL || window->framebuffer_width != width || window->framebuffer_height != height) {
+		destroy_framebuffer(window);
+		BITMAPINFO info = {0};
+		info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+		info.bmiHeader.biWidth = width;
+		info.bmiHeader.biHeight = -(LONG)height; // negative for top down rows
+		info.bmiHeader.biPlanes = 1;
+		info.bmiHeader.biBitCount = 32;
+		info.bmiHeader.biCompression = BI_RGB;
+		void* pixels = NULL;
+		HBITMAP bitmap = CreateDIBSection(NULL, &info, DIB_RGB_COLORS, &pixels, NULL, 0);
+		if(bitmap == NULL) return 0;
+		HDC dc = CreateCompatibleDC(NULL);
+		if(dc == NULL) {
+			DeleteObject(bitmap);
+			return 0;
+		}
+		window->framebuffer_previous = SelectObject(dc, bitmap);
+		window->framebuffer_dc = dc;
+		window->framebuffer_bitmap = bitmap;
+		window->framebuffer_pixels = pixels;
+		window->framebuffer_width = width;
+		window->framebuffer_height = height;
+	}
+	framebuffer->pixels = window->framebuffer_pixels;
+	framebuffer->width = window->framebuffer_width;
+	framebuffer->height = window->framebuffer_height;
+	framebuffer->stride = window->framebuffer_width;
+	return 1;
+}
+void platform_window_present(platform_window_t* window, const platform_rect_t* damage, const uint32_t damage_count) {
+	if(window->framebuffer_dc == NULL) return;
+	HDC dc = GetDC(window->handle);
+	if(damage_count == 0) {
+		BitBlt(dc, 0, 0, window->framebuffer_width, window->framebuffer_height, window->framebuffer_dc, 0, 0, SRCCOPY);
+	}
+	for(uint32_t i = 0; i < damage_count; i++) {
+		BitBlt(dc, damage[i].x, damage[i].y, damage[i].width, damage[i].height, window->framebuffer_dc, damage[i].x, damage[i].y, SRCCOPY);
+	}
+	ReleaseDC(window->handle, dc);
+}
+
+static BOOL __stdcall add_monitor(HMONITOR handle, HDC dc, LPRECT rect, LPARAM data) {
+	if(context.monitor_count == PLATFORM_MAX_MONITORS) return FALSE;
+	MONITORINFOEXA info;
+	info.cbSize = sizeof(info);
+	if(!GetMonitorInfoA(handle, (MONITORINFO*)&info)) return TRUE;
+
+	platform_monitor_t* monitor = &context.monitors[context.monitor_count];
+	memset(monitor, 0, sizeof(platform_monitor_t));
+	// device names look like \\.\DISPLAY1
+	strncpy(monitor->name, info.szDevice, sizeof(monitor->name) - 1);
+	monitor->x = info.rcMonitor.left;
+	monitor->y = info.rcMonitor.top;
+	monitor->width = info.rcMonitor.right - info.rcMonitor.left;
+	monitor->height = info.rcMonitor.bottom - info.rcMonitor.top;
+	monitor->primary = (info.dwFlags & MONITORINFOF_PRIMARY) != 0;
+	DEVMODEA mode;
+	mode.dmSize = sizeof(mode);
+	mode.dmDriverExtra = 0;
+	// 0 and 1 stand for the hardware default rate
+	if(EnumDisplaySettingsA(info.szDevice, ENUM_CURRENT_SETTINGS, &mode) && mode.dmDisplayFrequency > 1) {
+		monitor->refresh_mhz = mode.dmDisplayFrequency * 1000;
+	}
+	HDC device = CreateDCA(NULL, info.szDevice, NULL, NULL);
+	if(device != NULL) {
+		int mm_width = GetDeviceCaps(device, HORZSIZE);
+		if(mm_width > 0) monitor->dpi = (uint32_t)(monitor->width * 25.4 / mm_width + 0.5);
+		DeleteDC(device);
+	}
+	context.monitor_handles[context.monitor_count] = handle;
+	// the primary monitor goes first
+	if(monitor->primary && context.monitor_count != 0) {
+		platform_monitor_t primary = *monitor;
+		context.monitors[context.monitor_count] = context.monitors[0];
+		context.monitor_handles[context.monitor_count] = context.monitor_handles[0];
+		context.monitors[0] = primary;
+		context.monitor_handles[0] = handle;
+	}
+	context.monitor_count++;
+	return TRUE;
+}
+static void update_monitors(void) {
+	if(context.monitors_valid) return;
+	context.monitor_count = 0;
+	EnumDisplayMonitors(NULL, NULL, add_monitor, 0);
+	context.monitors_valid = 1;
+}
+
+uint32_t platform_get_monitors(platform_monitor_t* monitors, const uint32_t max_count) {
+	update_monitors();
+	uint32_t count = context.monitor_count < max_count ? context.monitor_count : max_count;
+	for(uint32_t i = 0; i < count; i++) monitors[i] = context.monitors[i];
+	return count;
+}
+int8_t platform_window_get_monitor(const platform_window_t* window, platform_monitor_t* monitor) {
+	update_monitors();
+	if(context.monitor_count == 0) return 0;
+	HMONITOR handle = MonitorFromWindow(window->handle, MONITOR_DEFAULTTOPRIMARY);
+	uint32_t index = 0;
+	for(uint32_t i = 0; i < context.monitor_count; i++) {
+		if(context.monitor_handles[i] == handle) index = i;
+	}
+	*monitor = context.monitors[index];
+	return 1;
+}
+
+// there is no headless backend on windows, windows always belong to the window system
+int8_t platform_headless_inject_event(const platform_event_t* event) {
+	return 0;
+}
+uint32_t* platform_headless_window_pixels(platform_window_t* window, uint32_t* width, uint32_t* height) {
+	return NULL;
+}
+
+// GetMessageTime is on the GetTickCount clock, the age of the message is carried over to ours
+static uint64_t message_timestamp(void) {
+	uint64_t now = platform_get_timestamp();
+	uint64_t age = (uint64_t)(DWORD)(GetTickCount() - (DWORD)GetMessageTime()) * 1000000;
+	return age < now ? now - age : now;
+}
+
+static uint32_t translate_virtual_key(const WPARAM vk, const uint32_t scancode, const int8_t extended) {
+	if(vk >= 'A' && vk <= 'Z') return vk - 'A' + 'a';
+	if((vk >= '0' && vk <= '9') || vk == VK_SPACE) return vk;
+	if(vk >= VK_F1 && vk <= VK_F12) return PLATFORM_KEY_F1 + (vk - VK_F1);
+	switch(vk) {
+		case VK_OEM_1:      return ';';
+		case VK_OEM_PLUS:   return '=';
+		case VK_OEM_COMMA:  return ',';
+		case VK_OEM_MINUS:  return '-';
+		case VK_OEM_PERIOD: return '.';
+		case VK_OEM_2:      return '/';
+		case VK_OEM_3:      return '`';
+		case VK_OEM_4:      return '[';
+		case VK_OEM_5:      return '\\';
+		case VK_OEM_6:      return ']';
+		case VK_OEM_7:      return '\'';
+		case VK_ESCAPE:     return 27;
+		case VK_RETURN:     return '\r';
+		case VK_TAB:        return '\t';
+		case VK_BACK:       return 8;
+		case VK_INSERT:     return PLATFORM_KEY_INSERT;
+		case VK_DELETE:     return PLATFORM_KEY_DELETE;
+		case VK_RIGHT:      return PLATFORM_KEY_RIGHT;
+		case VK_LEFT:       return PLATFORM_KEY_LEFT;
+		case VK_DOWN:       return PLATFORM_KEY_DOWN;
+		case VK_UP:         return PLATFORM_KEY_UP;
+		case VK_PRIOR:      return PLATFORM_KEY_PAGE_UP;
+		case VK_NEXT:       return PLATFORM_KEY_PAGE_DOWN;
+		case VK_HOME:       return PLATFORM_KEY_HOME;
+		case VK_END:        return PLATFORM_KEY_END;
+		case VK_CAPITAL:    return PLATFORM_KEY_CAPS_LOCK;
+		// the messages only say which modifier, not which side
+		case VK_SHIFT:
+			return MapVirtualKeyA(scancode, MAPVK_VSC_TO_VK_EX) == VK_RSHIFT ? PLATFORM_KEY_RIGHT_SHIFT : PLATFORM_KEY_LEFT_SHIFT;
+		case VK_CONTROL:    return extended ? PLATFORM_KEY_RIGHT_CONTROL : PLATFORM_KEY_LEFT_CONTROL;
+		case VK_MENU:       return extended ? PLATFORM_KEY_RIGHT_ALT : PLATFORM_KEY_LEFT_ALT;
+		case VK_LWIN:       return PLATFORM_KEY_LEFT_SUPER;
+		case VK_RWIN:       return PLATFORM_KEY_RIGHT_SUPER;
+	}
+	return PLATFORM_KEY_UNKNOWN;
+}
+
+static uint32_t current_modifiers(void) {
+	uint32_t modifiers = 0;
+	if(GetKeyState(VK_SHIFT) & 0x8000) modifiers |= PLATFORM_MOD_SHIFT;
+	if(GetKeyState(VK_CONTROL) & 0x8000) modifiers |= PLATFORM_MOD_CONTROL;
+	if(GetKeyState(VK_MENU) & 0x8000) modifiers |= PLATFORM_MOD_ALT;
+	if((GetKeyState(VK_LWIN) | GetKeyState(VK_RWIN)) & 0x8000) modifiers |= PLATFORM_MOD_SUPER;
+	return modifiers;
+}
+
+static void translate_mouse_button(platform_event_t* event, const uint32_t type, const uint32_t button, const LPARAM l_param) {
+	event->type = type;
+	event->timestamp = message_timestamp();
+	event->mouse_button.x = (int16_t)LOWORD(l_param);
+	event->mouse_button.y = (int16_t)HIWORD(l_param);
+	event->mouse_button.button = button;
+	event->mouse_button.modifiers = current_modifiers();
+}
+
 // based off of code written by ChiliTomatoNoodle (youtube channel)
 LRESULT __stdcall window_proc_setup(HWND hwnd, UINT msg, WPARAM w_param, LPARAM l_param) {
 	if(msg == WM_NCCREATE) {
@@ -261,18 +535,102 @@ LRESULT __stdcall window_proc_setup(HWND hwnd, UINT msg, WPARAM w_param, LPARAM
 LRESULT __stdcall window_proc(HWND hwnd, UINT msg, WPARAM w_param, LPARAM l_param) {
 	platform_window_t* window = (platform_window_t*)GetWindowLongPtrA(hwnd, GWLP_USERDATA);
 
+	platform_event_t event = {0};
+	event.window = window;
+	event.timestamp = platform_get_timestamp();
 	switch(msg)
 	{
 	case WM_CLOSE: // window wants to close
 		window->should_close = 1;
+		event.type = PLATFORM_EVENT_CLOSE;
+		event_queue_push(&context.events, &event);
 		return 0;
 	case WM_DESTROY: break;
+	case WM_DISPLAYCHANGE:
+		context.monitors_valid = 0;
+		break;
 	case WM_SIZE:
-		platform_terminal_print("Size Event.\n", 0, 0, 0);
+		event.type = PLATFORM_EVENT_RESIZE;
+		event.resize.width = LOWORD(l_param);
+		event.resize.height = HIWORD(l_param);
+		break;
+	case WM_MOVE:
+		event.type = PLATFORM_EVENT_MOVE;
+		event.move.x = (int16_t)LOWORD(l_param);
+		event.move.y = (int16_t)HIWORD(l_param);
 		break;
-	case WM_KEYDOWN: break;
-	case WM_KEYUP: break;
+	case WM_PAINT: {
+		RECT rect;
+		if(!GetUpdateRect(hwnd, &rect, FALSE)) break;
+		event.type = PLATFORM_EVENT_EXPOSE;
+		event.expose.x = rect.left;
+		event.expose.y = rect.top;
+		event.expose.width = rect.right - rect.left;
+		event.expose.height = rect.bottom - rect.top;
+	} break;
+	case WM_SHOWWINDOW:
+		event.type = w_param ? PLATFORM_EVENT_MAP : PLATFORM_EVENT_UNMAP;
+		break;
+	case WM_SETFOCUS:
+		event.type = PLATFORM_EVENT_FOCUS_IN;
+		break;
+	case WM_KILLFOCUS:
+		event.type = PLATFORM_EVENT_FOCUS_OUT;
+		break;
+	case WM_MOUSEMOVE:
+		event.type = PLATFORM_EVENT_MOUSE_MOVE;
+		event.mouse_move.x = (int16_t)LOWORD(l_param);
+		event.mouse_move.y = (int16_t)HIWORD(l_param);
+		event.timestamp = message_timestamp();
+		break;
+	// alt and F10 come as system keys, they still have to reach DefWindowProc for alt+f4
+	case WM_KEYDOWN:
+	case WM_KEYUP:
+	case WM_SYSKEYDOWN:
+	case WM_SYSKEYUP: {
+		int8_t down = msg == WM_KEYDOWN || msg == WM_SYSKEYDOWN;
+		event.type = down ? PLATFORM_EVENT_KEY_DOWN : PLATFORM_EVENT_KEY_UP;
+		event.timestamp = message_timestamp();
+		// set 1 scan code, the same numbers as evdev for the main block
+		event.key.scancode = (l_param >> 16) & 0xff;
+		event.key.key = translate_virtual_key(w_param, event.key.scancode, (l_param >> 24) & 1);
+		event.key.modifiers = current_modifiers();
+		// bit 30 is the previous key state
+		event.key.repeat = down && (l_param & (1 << 30)) != 0;
+	} break;
+	case WM_LBUTTONDOWN: translate_mouse_button(&event, PLATFORM_EVENT_MOUSE_DOWN, PLATFORM_MOUSE_BUTTON_LEFT, l_param); break;
+	case WM_LBUTTONUP:   translate_mouse_button(&event, PLATFORM_EVENT_MOUSE_UP, PLATFORM_MOUSE_BUTTON_LEFT, l_param); break;
+	case WM_MBUTTONDOWN: translate_mouse_button(&event, PLATFORM_EVENT_MOUSE_DOWN, PLATFORM_MOUSE_BUTTON_MIDDLE, l_param); break;
+	case WM_MBUTTONUP:   translate_mouse_button(&event, PLATFORM_EVENT_MOUSE_UP, PLATFORM_MOUSE_BUTTON_MIDDLE, l_param); break;
+	case WM_RBUTTONDOWN: translate_mouse_button(&event, PLATFORM_EVENT_MOUSE_DOWN, PLATFORM_MOUSE_BUTTON_RIGHT, l_param); break;
+	case WM_RBUTTONUP:   translate_mouse_button(&event, PLATFORM_EVENT_MOUSE_UP, PLATFORM_MOUSE_BUTTON_RIGHT, l_param); break;
+	case WM_XBUTTONDOWN:
+	case WM_XBUTTONUP:
+		translate_mouse_button(&event, msg == WM_XBUTTONDOWN ? PLATFORM_EVENT_MOUSE_DOWN : PLATFORM_EVENT_MOUSE_UP,
+		                       HIWORD(w_param) == XBUTTON1 ? PLATFORM_MOUSE_BUTTON_BACK : PLATFORM_MOUSE_BUTTON_FORWARD, l_param);
+		break;
+	case WM_MOUSEWHEEL:
+	case WM_MOUSEHWHEEL: {
+		float steps = (float)GET_WHEEL_DELTA_WPARAM(w_param) / WHEEL_DELTA;
+		event.type = PLATFORM_EVENT_WHEEL;
+		event.timestamp = message_timestamp();
+		if(msg == WM_MOUSEWHEEL) event.wheel.y = steps;
+		else event.wheel.x = steps;
+	} break;
+	case WM_INPUT: {
+		RAWINPUT raw;
+		UINT size = sizeof(raw);
+		if(GetRawInputData((HRAWINPUT)l_param, RID_INPUT, &raw, &size, sizeof(RAWINPUTHEADER)) == (UINT)-1) break;
+		// absolute devices like tablets and remote desktop sessions have no relative motion
+		if(raw.header.dwType != RIM_TYPEMOUSE || (raw.data.mouse.usFlags & MOUSE_MOVE_ABSOLUTE)) break;
+		if(raw.data.mouse.lLastX == 0 && raw.data.mouse.lLastY == 0) break;
+		event.type = PLATFORM_EVENT_RAW_MOTION;
+		event.timestamp = message_timestamp();
+		event.raw_motion.x = raw.data.mouse.lLastX;
+		event.raw_motion.y = raw.data.mouse.lLastY;
+	} break;
 	}
+	if(event.type != PLATFORM_EVENT_NONE) event_queue_push(&context.events, &event);
 
 	return DefWindowProcA(hwnd, msg, w_param, l_param);
 }
@@ -338,6 +696,80 @@ void platform_terminal_print_error(const char* msg, const uint8_t forground, con
 	_terminal_print(msg, forground, background, flags, stderr_handle);
 }
 
+// console attributes can only be changed between writes, so each span is still written separately
+void platform_terminal_print_spans(const platform_terminal_span_t* spans, const uint32_t span_count) {
+	HANDLE stdout_handle = GetStdHandle(STD_OUTPUT_HANDLE);
+	for(uint32_t i = 0; i < span_count; i++) {
+		_terminal_print(spans[i].text, spans[i].forground, spans[i].background, spans[i].flags, stdout_handle);
+	}
+}
+// prints on windows are synchronous by design. colors are console attributes set around
+// each WriteConsole instead of escape sequences in the text, so there is no byte stream a
+// writer thread could buffer. starting fails, callers keep printing directly and nothing is dropped
+int8_t platform_terminal_async_start(uint64_t buffer_size, const uint8_t overflow_policy) {
+	return 0;
+}
+void platform_terminal_async_stop(void) {}
+void platform_terminal_flush(void) {}
+uint64_t platform_terminal_dropped_count(void) {
+	return 0;
+}
+
+// the status region redraws its lines with cursor movement escape sequences, which need
+// virtual terminal processing that the console output above does not turn on. so there is
+// no status region on windows, beginning one fails and the other calls do nothing
+int8_t platform_terminal_status_begin(const uint32_t line_count, const uint32_t refresh_rate) {
+	return 0;
+}
+void platform_terminal_status_end(void) {}
+void platform_terminal_status_set_line(const uint32_t line, const char* text, const uint8_t forground, const uint8_t background, const uint8_t flags) {}
+void platform_terminal_status_update(void) {}
+
+void platform_terminal_print_spans_error(const platform_terminal_span_t* spans, const uint32_t span_count) {
+	HANDLE stderr_handle = GetStdHandle(STD_ERROR_HANDLE);
+	for(uint32_t i = 0; i < span_count; i++) {
+		_terminal_print(spans[i].text, spans[i].forground, spans[i].background, spans[i].flags, stderr_handle);
+	}
+}
+
+static const struct {
+	const char* text;
+	uint8_t     color;
+} log_prefixes[] = {
+	{ "[TRACE] ", PLATFORM_COLOR_BRIGHT_BLACK },
+	{ "[DEBUG] ", PLATFORM_COLOR_CYAN },
+	{ "[INFO] ",  PLATFORM_COLOR_GREEN },
+	{ "[WARN] ",  PLATFORM_COLOR_YELLOW },
+	{ "[ERROR] ", PLATFORM_COLOR_RED },
+};
+
+static void log_write(uint8_t level, const char* fmt, va_list args) {
+	if(level > PLATFORM_LOG_LEVEL_ERROR) level = PLATFORM_LOG_LEVEL_ERROR;
+	HANDLE handle = GetStdHandle(level >= PLATFORM_LOG_LEVEL_WARN ? STD_ERROR_HANDLE : STD_OUTPUT_HANDLE);
+	char msg[4096];
+	int len = vsnprintf(msg, sizeof(msg) - 1, fmt, args);
+	if(len < 0) return;
+	if(len > (int)sizeof(msg) - 2) len = sizeof(msg) - 2;
+	msg[len] = '\n';
+	msg[len + 1] = '\0';
+	_terminal_print(log_prefixes[level].text, log_prefixes[level].color, 0, 0, handle);
+	_terminal_print(msg, 0, 0, 0, handle);
+}
+
+void platform_log_write(const uint8_t level, const char* fmt, ...) {
+	va_list args;
+	va_start(args, fmt);
+	log_write(level, fmt, args);
+	va_end(args);
+}
+// there is no async writer on windows to hand the arguments to
+void platform_log_deferred_write(const uint8_t level, const char* fmt, ...) {
+	va_list args;
+	va_start(args, fmt);
+	log_write(level, fmt, args);
+	va_end(args);
+}
+
 
 void* platform_map_memory(void* addr_hint, uint64_t size) {
 	return VirtualAlloc(addr_hint, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
@@ -346,12 +778,108 @@ int8_t platform_unmap_memory(void* addr, uint64_t size) {
 	return VirtualFree(addr, size, MEM_RELEASE) != 0;
 }
 
+// large pages need SeLockMemoryPrivilege, without it VirtualAlloc fails and normal pages are used
+void* platform_map_memory_ex(void* addr_hint, uint64_t size, const uint32_t flags, uint64_t* granted_page_size) {
+	uint64_t page_size = platform_get_page_size();
+	void* mem = NULL;
+	if(flags & PLATFORM_MF_HUGE_PAGES) {
+		uint64_t large_size = GetLargePageMinimum();
+		if(large_size != 0) {
+			uint64_t large_mapping_size = (size + large_size - 1) & ~(large_size - 1);
+			mem = VirtualAlloc(addr_hint, large_mapping_size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+			if(mem != NULL) page_size = large_size;
+		}
+	}
+	if(mem == NULL) {
+		mem = VirtualAlloc(addr_hint, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+		if(mem == NULL) return NULL;
+	}
+
+	// large pages are always resident
+	if(flags & PLATFORM_MF_PREFAULT && page_size == platform_get_page_size()) {
+		for(uint64_t offset = 0; offset < size; offset += page_size) ((volatile uint8_t*)mem)[offset] = 0;
+	}
+	else if(flags & PLATFORM_MF_WILLNEED) {
+		WIN32_MEMORY_RANGE_ENTRY range = { mem, size };
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+	}
+
+	if(granted_page_size) *granted_page_size = page_size;
+	return mem;
+}
+
+void* platform_reserve_memory(void* addr_hint, uint64_t size) {
+	return VirtualAlloc(addr_hint, size, MEM_RESERVE, PAGE_NOACCESS);
+}
+int8_t platform_commit_memory(void* addr, uint64_t size) {
+	return VirtualAlloc(addr, size, MEM_COMMIT, PAGE_READWRITE) != NULL;
+}
+int8_t platform_decommit_memory(void* addr, uint64_t size) {
+	return VirtualFree(addr, size, MEM_DECOMMIT) != 0;
+}
+int8_t platform_release_memory(void* addr, uint64_t size) {
+	// MEM_RELEASE requires a size of 0 and frees the whole reservation
+	return VirtualFree(addr, 0, MEM_RELEASE) != 0;
+}
+
+uint64_t platform_get_page_size(void) {
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwPageSize;
+}
+uint64_t platform_get_allocation_granularity(void) {
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwAllocationGranularity;
+}
+
 
 uint64_t platform_get_timestamp(void) {
+	static LARGE_INTEGER frequency = {0};
+	if(frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	uint64_t seconds = counter.QuadPart / frequency.QuadPart;
+	uint64_t remainder = counter.QuadPart % frequency.QuadPart;
+	return seconds * 1000000000 + remainder * 1000000000 / frequency.QuadPart;
+}
+uint64_t platform_get_timestamp_frequency(void) {
+	return 1000000000;
+}
+// QueryPerformanceCounter is already backed by the tsc when it is invariant
+int8_t platform_calibrate_fast_timestamp(const uint32_t miliseconds) {
+	return 0;
+}
+uint64_t platform_get_fast_timestamp(void) {
+	return platform_get_timestamp();
+}
+uint64_t platform_get_fast_timestamp_tick_frequency(void) {
 	return 0;
 }
 void platform_sleep_miliseconds(const uint32_t miliseconds) {
 	timeBeginPeriod(1);
 	Sleep(miliseconds);
 	timeEndPeriod(1);
+}
+void platform_sleep_until(const uint64_t deadline_ns) {
+	static HANDLE timer = NULL;
+	if(timer == NULL) {
+		timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+	}
+
+	// high resolution timers still wake up to a few hundred microseconds late
+	const uint64_t margin = 1000000;
+	uint64_t now = platform_get_timestamp();
+	if(timer != NULL && deadline_ns > now + margin) {
+		LARGE_INTEGER due;
+		// relative time in 100 ns units
+		due.QuadPart = -(LONGLONG)((deadline_ns - now - margin) / 100);
+		SetWaitableTimer(timer, &due, 0, NULL, NULL, FALSE);
+		WaitForSingleObject(timer, INFINITE);
+		now = platform_get_timestamp();
+	}
+	while(now < deadline_ns) {
+		YieldProcessor();
+		now = platform_get_timestamp();
+	}
 }
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include <platform/platform.h>
+#include "linux/xlib_window.h"
+#include <stdlib.h>
+
+// measures how fast platform_handle_events gets through queued events spread
+// over many windows. the events are put straight into the Xlib queue so the
+// server is only needed to create the windows, e.g. Xvfb :99 & DISPLAY=:99 ./bench_dispatch
+#define EVENTS_PER_ROUND 4096
+#define ROUNDS           200
+
+static inline uint32_t next_random(uint32_t* state) {
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+static void bench(const uint32_t window_count) {
+	platform_window_create_info_t create_info = {0};
+	create_info.name = "bench";
+	create_info.width = 64;
+	create_info.height = 64;
+	create_info.flags = PLATFORM_WF_UNMAPPED;
+
+	platform_window_t** windows = malloc(window_count * sizeof(platform_window_t*));
+	for(uint32_t i = 0; i < window_count; i++) windows[i] = platform_create_window(create_info, NULL);
+	// anything the server sent while creating them is not part of the measurement
+	XSync(linux_platform_context.xlib.dpy, 0);
+	platform_handle_events();
+
+	// events arrive in short runs for the same window
+	XEvent* events = malloc(EVENTS_PER_ROUND * sizeof(XEvent));
+	uint32_t state = 0x9e3779b9;
+	Window handle = None;
+	for(uint32_t i = 0; i < EVENTS_PER_ROUND; i++) {
+		if(i % 4 == 0) handle = xlib_get_window_handle(windows[next_random(&state) % window_count]);
+		XEvent e = {0};
+		e.xconfigure.type = ConfigureNotify;
+		e.xconfigure.display = linux_platform_context.xlib.dpy;
+		e.xconfigure.event = handle;
+		e.xconfigure.window = handle;
+		e.xconfigure.x = i;
+		e.xconfigure.width = 64;
+		e.xconfigure.height = 64;
+		events[i] = e;
+	}
+
+	uint64_t total = 0;
+	for(uint32_t round = 0; round < ROUNDS; round++) {
+		for(uint32_t i = 0; i < EVENTS_PER_ROUND; i++) XPutBackEvent(linux_platform_context.xlib.dpy, &events[i]);
+		uint64_t start = platform_get_timestamp();
+		platform_handle_events();
+		total += platform_get_timestamp() - start;
+	}
+	double ns_per_event = (double)total / ((double)EVENTS_PER_ROUND * ROUNDS);
+	platform_log(PLATFORM_LOG_LEVEL_INFO, "%4u windows: %6.1f ns/event, %5.2f M events/s", window_count, ns_per_event, 1000.0 / ns_per_event);
+
+	for(uint32_t i = 0; i < window_count; i++) platform_destroy_window(windows[i], NULL);
+	free(windows);
+	free(events);
+}
+
+int main(void) {
+	if(!platform_init(NULL)) {
+		platform_log(PLATFORM_LOG_LEVEL_ERROR, "platform_init failed, is a display available?");
+		return 1;
+	}
+	bench(1);
+	bench(16);
+	bench(1000);
+	platform_shutdown();
+	return 0;
+}
@@ -0,0 +1,157 @@
+#include <platform/platform.h>
+#include "linux/xlib_window.h"
+#include <stdlib.h>
+#include <threads.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// measures how long an input event takes from being sent until platform_poll_event
+// returns it while the app is busy with long frames, with and without
+// PLATFORM_SF_EVENT_THREAD. a second connection sends MotionNotify events with a
+// sequence number in x at random intervals. every mode runs in its own process
+// since XInitThreads has to come before any other Xlib call
+#define FRAME_NS       16000000
+#define EVENT_COUNT    500
+#define SAMPLE_SLICE_NS 1000000 // when sampling during the frame, poll this often
+
+typedef struct {
+	const char* name;
+	uint32_t    flags;
+	int8_t      sample_during_frame;
+} bench_mode_t;
+
+static const bench_mode_t modes[] = {
+	{ "handle at frame start        ", 0, 0 },
+	{ "event thread, frame start    ", PLATFORM_SF_EVENT_THREAD, 0 },
+	{ "handle every 1 ms            ", 0, 1 },
+	{ "event thread, poll every 1 ms", PLATFORM_SF_EVENT_THREAD, 1 },
+};
+
+static uint64_t sent_at[EVENT_COUNT];
+static uint64_t seen_at[EVENT_COUNT];
+static Window target;
+static atomic_int injector_done;
+
+static inline uint32_t next_random(uint32_t* state) {
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+static int injector_main(void* data) {
+	Display* dpy = XOpenDisplay(NULL);
+	uint32_t state = 0x9e3779b9;
+	for(uint32_t i = 0; i < EVENT_COUNT; i++) {
+		platform_sleep_until(platform_get_timestamp() + 1000000 + next_random(&state) % 4000000);
+		XEvent e = {0};
+		e.xmotion.type = MotionNotify;
+		e.xmotion.window = target;
+		e.xmotion.x = i;
+		sent_at[i] = platform_get_timestamp();
+		XSendEvent(dpy, target, False, PointerMotionMask, &e);
+		XFlush(dpy);
+	}
+	XSync(dpy, False);
+	XCloseDisplay(dpy);
+	atomic_store(&injector_done, 1);
+	return 0;
+}
+
+static uint64_t poll_all(const uint64_t now) {
+	platform_event_t event;
+	uint64_t handled = 0;
+	while(platform_poll_event(&event)) {
+		if(event.type != PLATFORM_EVENT_MOUSE_MOVE) continue;
+		uint32_t i = event.mouse_move.x;
+		if(i < EVENT_COUNT && seen_at[i] == 0) seen_at[i] = now;
+		handled++;
+	}
+	return handled;
+}
+
+static int compare(const void* a, const void* b) {
+	uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+	return x < y ? -1 : x > y;
+}
+
+static int run(const bench_mode_t* mode) {
+	platform_settings_t settings = {0};
+	settings.flags = mode->flags;
+	if(!platform_init(&settings)) {
+		platform_log(PLATFORM_LOG_LEVEL_ERROR, "platform_init failed, is a display available?");
+		return 1;
+	}
+	platform_window_create_info_t create_info = {0};
+	create_info.name = "bench";
+	create_info.width = 64;
+	create_info.height = 64;
+	create_info.flags = PLATFORM_WF_UNMAPPED;
+	platform_window_t* window = platform_create_window(create_info, NULL);
+	target = xlib_get_window_handle(window);
+	platform_handle_events();
+
+	thrd_t injector;
+	thrd_create(&injector, injector_main, NULL);
+	uint64_t event_time = 0, frames = 0;
+	while(!atomic_load(&injector_done)) {
+		uint64_t frame_start = platform_get_timestamp();
+		uint64_t start = frame_start;
+		platform_handle_events();
+		poll_all(platform_get_timestamp());
+		event_time += platform_get_timestamp() - start;
+		// the frame's work, optionally looking at input again as it goes
+		while(platform_get_timestamp() - frame_start < FRAME_NS) {
+			uint64_t slice_end = platform_get_timestamp() + SAMPLE_SLICE_NS;
+			while(platform_get_timestamp() < slice_end);
+			if(mode->sample_during_frame) {
+				start = platform_get_timestamp();
+				platform_handle_events();
+				poll_all(platform_get_timestamp());
+				event_time += platform_get_timestamp() - start;
+			}
+		}
+		frames++;
+	}
+	thrd_join(injector, NULL);
+	// the last events may still be on their way
+	for(uint32_t i = 0; i < 10; i++) {
+		platform_wait_events(FRAME_NS);
+		poll_all(platform_get_timestamp());
+	}
+
+	// a motion event merged into a later one became visible when that one did
+	uint64_t latencies[EVENT_COUNT];
+	uint32_t count = 0, seen = 0;
+	uint64_t visible_at = 0;
+	for(uint32_t i = EVENT_COUNT; i-- > 0;) {
+		if(seen_at[i] != 0) {
+			seen++;
+			if(visible_at == 0 || seen_at[i] < visible_at) visible_at = seen_at[i];
+		}
+		if(visible_at != 0) latencies[count++] = visible_at - sent_at[i];
+	}
+	qsort(latencies, count, sizeof(uint64_t), compare);
+	if(count == 0) {
+		platform_log(PLATFORM_LOG_LEVEL_WARN, "%s: no events arrived", mode->name);
+	}
+	else {
+		platform_log(PLATFORM_LOG_LEVEL_INFO, "%s: median %6.2f ms, p99 %6.2f ms, %3u/%u not coalesced, %5.1f us/frame handling events",
+		             mode->name, latencies[count / 2] / 1e6, latencies[count * 99 / 100] / 1e6, seen, EVENT_COUNT,
+		             (double)event_time / frames / 1e3);
+	}
+	platform_destroy_window(window, NULL);
+	platform_shutdown();
+	return 0;
+}
+
+int main(void) {
+	for(uint32_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+		pid_t child = fork();
+		if(child == 0) return run(&modes[i]);
+		int status;
+		waitpid(child, &status, 0);
+		if(!WIFEXITED(status) || WEXITSTATUS(status) != 0) return 1;
+	}
+	return 0;
+}
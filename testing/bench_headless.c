@@ -0,0 +1,126 @@
+#include <platform/platform.h>
+#include <stdatomic.h>
+#include <threads.h>
+
+// runs the event path of the headless backend at full speed, what it reports is
+// the platform's own cost per event without any window system behind it. a
+// scripted mix of input, motion and resize events is injected either by the
+// polling thread itself or by a second thread while the first waits for them
+#define EVENT_COUNT 4000000
+#define BATCH_SIZE  256
+
+static platform_window_t* window;
+static atomic_int injector_done;
+
+// mostly input, motion and resizes are coalesced by the queue
+static void script_event(const uint32_t i, platform_event_t* event) {
+	event->window = window;
+	event->timestamp = 0;
+	switch(i & 7) {
+	case 0:
+	case 1:
+	case 2:
+		event->type = PLATFORM_EVENT_MOUSE_MOVE;
+		event->mouse_move.x = i & 1023;
+		event->mouse_move.y = i >> 10 & 1023;
+		break;
+	case 3:
+		event->type = PLATFORM_EVENT_KEY_DOWN;
+		event->key.key = 'a' + (i >> 3) % 26;
+		event->key.scancode = 30;
+		event->key.modifiers = 0;
+		event->key.repeat = 0;
+		break;
+	case 4:
+		event->type = PLATFORM_EVENT_KEY_UP;
+		event->key.key = 'a' + (i >> 3) % 26;
+		event->key.scancode = 30;
+		event->key.modifiers = 0;
+		event->key.repeat = 0;
+		break;
+	case 5:
+		event->type = PLATFORM_EVENT_WHEEL;
+		event->wheel.x = 0;
+		event->wheel.y = 1;
+		break;
+	case 6:
+		event->type = PLATFORM_EVENT_MOUSE_DOWN;
+		event->mouse_button.button = PLATFORM_MOUSE_BUTTON_LEFT;
+		event->mouse_button.x = 1;
+		event->mouse_button.y = 2;
+		event->mouse_button.modifiers = 0;
+		break;
+	case 7:
+		// every resize reallocates the window's pixels
+		event->type = PLATFORM_EVENT_RESIZE;
+		event->resize.width = 64 + (i >> 3 & 63);
+		event->resize.height = 64;
+		break;
+	}
+}
+
+static uint64_t poll_all(void) {
+	platform_event_t event;
+	uint64_t count = 0;
+	while(platform_poll_event(&event)) count++;
+	return count;
+}
+
+static int injector_main(void* data) {
+	platform_event_t event = {0};
+	for(uint32_t i = 0; i < EVENT_COUNT; i++) {
+		script_event(i, &event);
+		while(!platform_headless_inject_event(&event)) thrd_yield();
+	}
+	atomic_store(&injector_done, 1);
+	platform_wake();
+	return 0;
+}
+
+static void report(const char* name, const uint64_t time, const uint64_t delivered) {
+	platform_log(PLATFORM_LOG_LEVEL_INFO, "%s: %6.1f ns per injected event, %5.2f M events/s, %u injected, %llu polled",
+	             name, (double)time / EVENT_COUNT, EVENT_COUNT * 1e3 / time, EVENT_COUNT, (unsigned long long)delivered);
+}
+
+int main(void) {
+	platform_settings_t settings = {0};
+	settings.backend = PLATFORM_BACKEND_HEADLESS;
+	if(!platform_init(&settings)) return 1;
+	platform_window_create_info_t create_info = {0};
+	create_info.name = "bench";
+	create_info.width = 64;
+	create_info.height = 64;
+	window = platform_create_window(create_info, NULL);
+	platform_handle_events();
+	poll_all();
+
+	platform_event_t event = {0};
+	uint64_t delivered = 0;
+	uint64_t start = platform_get_timestamp();
+	for(uint32_t i = 0; i < EVENT_COUNT; i += BATCH_SIZE) {
+		for(uint32_t j = i; j < i + BATCH_SIZE && j < EVENT_COUNT; j++) {
+			script_event(j, &event);
+			platform_headless_inject_event(&event);
+		}
+		platform_handle_events();
+		delivered += poll_all();
+	}
+	report("same thread     ", platform_get_timestamp() - start, delivered);
+
+	delivered = 0;
+	thrd_t injector;
+	start = platform_get_timestamp();
+	thrd_create(&injector, injector_main, NULL);
+	while(!atomic_load(&injector_done)) {
+		platform_wait_events(PLATFORM_WAIT_INFINITE);
+		delivered += poll_all();
+	}
+	thrd_join(injector, NULL);
+	platform_handle_events();
+	delivered += poll_all();
+	report("injector thread ", platform_get_timestamp() - start, delivered);
+
+	platform_destroy_window(window, NULL);
+	platform_shutdown();
+	return 0;
+}
@@ -0,0 +1,55 @@
+#include <platform/platform.h>
+#include <stdio.h>
+
+#define MESSAGES 100000
+
+// run with stdout redirected, e.g. ./bench_log > /dev/null, the results go to stderr.
+// the async buffer holds every message so the numbers are what the printing thread pays
+
+static double sprintf_print(void) {
+	uint64_t start = platform_get_timestamp();
+	for(uint32_t i = 0; i < MESSAGES; i++) {
+		char buffer[128];
+		sprintf(buffer, "frame %u took %.3f ms (%s)\n", i, i * 0.001, "main");
+		platform_terminal_print(buffer, PLATFORM_COLOR_GREEN, 0, 0);
+	}
+	return (double)(platform_get_timestamp() - start) / MESSAGES;
+}
+
+static double log_immediate(void) {
+	uint64_t start = platform_get_timestamp();
+	for(uint32_t i = 0; i < MESSAGES; i++) {
+		platform_log(PLATFORM_LOG_LEVEL_INFO, "frame %u took %.3f ms (%s)", i, i * 0.001, "main");
+	}
+	return (double)(platform_get_timestamp() - start) / MESSAGES;
+}
+
+static double log_deferred(void) {
+	uint64_t start = platform_get_timestamp();
+	for(uint32_t i = 0; i < MESSAGES; i++) {
+		platform_log_deferred(PLATFORM_LOG_LEVEL_INFO, "frame %u took %.3f ms (%s)", i, i * 0.001, "main");
+	}
+	return (double)(platform_get_timestamp() - start) / MESSAGES;
+}
+
+int main(void) {
+	double sync_sprintf = sprintf_print();
+	double sync_log = log_immediate();
+
+	platform_terminal_async_start(16 * 1024 * 1024, PLATFORM_TERMINAL_OVERFLOW_BLOCK);
+	double async_sprintf = sprintf_print();
+	platform_terminal_flush();
+	double async_log = log_immediate();
+	platform_terminal_flush();
+	uint64_t start = platform_get_timestamp();
+	double async_deferred = log_deferred();
+	platform_terminal_flush();
+	double deferred_total = (double)(platform_get_timestamp() - start) / MESSAGES;
+	platform_terminal_async_stop();
+
+	fprintf(stderr, "ns per message, %u messages\n", MESSAGES);
+	fprintf(stderr, "sprintf + print:         %8.1f sync %8.1f async\n", sync_sprintf, async_sprintf);
+	fprintf(stderr, "platform_log:            %8.1f sync %8.1f async\n", sync_log, async_log);
+	fprintf(stderr, "platform_log_deferred:                %8.1f async (%.1f including the writer)\n", async_deferred, deferred_total);
+	return 0;
+}
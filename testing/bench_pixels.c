@@ -0,0 +1,101 @@
+#include <platform/platform.h>
+#include "common/pixel_kernels.h"
+#include <stdlib.h>
+
+// gigapixels per second of every pixel kernel at every instruction set level the
+// cpu has. a frame is 1920x1080, the scalers fill it from a 1280x720 source.
+// the frames do not fit in most caches so the simple kernels end up memory bound
+#define WIDTH        1920
+#define HEIGHT       1080
+#define SRC_WIDTH    1280
+#define SRC_HEIGHT   720
+#define MIN_TIME_NS  200000000
+
+typedef struct {
+	uint8_t*  rgba;
+	uint32_t* src;
+	uint32_t* dst;
+	uint16_t* rgb565;
+} buffers_t;
+
+typedef void (*bench_fn)(const pixel_kernels_t* kernels, const buffers_t* buffers);
+
+static void run_rgba_to_bgrx(const pixel_kernels_t* kernels, const buffers_t* buffers) {
+	kernels->rgba_to_bgrx(buffers->dst, buffers->rgba, WIDTH * HEIGHT);
+}
+static void run_rgba_premultiply(const pixel_kernels_t* kernels, const buffers_t* buffers) {
+	kernels->rgba_premultiply(buffers->dst, buffers->rgba, WIDTH * HEIGHT);
+}
+static void run_bgrx_to_rgb565(const pixel_kernels_t* kernels, const buffers_t* buffers) {
+	kernels->bgrx_to_rgb565(buffers->rgb565, buffers->src, WIDTH * HEIGHT);
+}
+static void run_fill(const pixel_kernels_t* kernels, const buffers_t* buffers) {
+	kernels->fill(buffers->dst, 0x336699, WIDTH * HEIGHT);
+}
+static void run_copy(const pixel_kernels_t* kernels, const buffers_t* buffers) {
+	kernels->copy(buffers->dst, buffers->src, WIDTH * HEIGHT);
+}
+static void run_scale_nearest(const pixel_kernels_t* kernels, const buffers_t* buffers) {
+	pixel_scale(kernels, PIXEL_FILTER_NEAREST, buffers->dst, WIDTH, HEIGHT, WIDTH, buffers->src, SRC_WIDTH, SRC_HEIGHT, SRC_WIDTH);
+}
+static void run_scale_bilinear(const pixel_kernels_t* kernels, const buffers_t* buffers) {
+	pixel_scale(kernels, PIXEL_FILTER_BILINEAR, buffers->dst, WIDTH, HEIGHT, WIDTH, buffers->src, SRC_WIDTH, SRC_HEIGHT, SRC_WIDTH);
+}
+
+static const struct {
+	const char* name;
+	bench_fn    run;
+} benches[] = {
+	{ "rgba_to_bgrx    ", run_rgba_to_bgrx },
+	{ "rgba_premultiply", run_rgba_premultiply },
+	{ "bgrx_to_rgb565  ", run_bgrx_to_rgb565 },
+	{ "fill            ", run_fill },
+	{ "copy            ", run_copy },
+	{ "scale_nearest   ", run_scale_nearest },
+	{ "scale_bilinear  ", run_scale_bilinear },
+};
+
+int main(void) {
+	buffers_t buffers;
+	buffers.rgba = aligned_alloc(64, WIDTH * HEIGHT * 4);
+	buffers.src = aligned_alloc(64, WIDTH * HEIGHT * 4);
+	buffers.dst = aligned_alloc(64, WIDTH * HEIGHT * 4);
+	buffers.rgb565 = aligned_alloc(64, WIDTH * HEIGHT * 2);
+	if(buffers.rgba == NULL || buffers.src == NULL || buffers.dst == NULL || buffers.rgb565 == NULL) return 1;
+	uint32_t state = 0x9e3779b9;
+	for(uint32_t i = 0; i < WIDTH * HEIGHT; i++) {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		buffers.src[i] = state & 0xffffff;
+		((uint32_t*)buffers.rgba)[i] = state;
+	}
+
+	platform_log(PLATFORM_LOG_LEVEL_INFO, "pixel_kernels_init picked %s", pixel_isa_names[pixel_kernels_init()]);
+	for(uint32_t b = 0; b < sizeof(benches) / sizeof(benches[0]); b++) {
+		double scalar_rate = 0;
+		for(uint32_t isa = 0; isa < PIXEL_ISA_COUNT; isa++) {
+			pixel_kernels_t kernels;
+			if(!pixel_kernels_get(isa, &kernels)) continue;
+			// once to fault the pages in
+			benches[b].run(&kernels, &buffers);
+			uint64_t frames = 0;
+			uint64_t start = platform_get_timestamp(), elapsed;
+			do {
+				benches[b].run(&kernels, &buffers);
+				frames++;
+				elapsed = platform_get_timestamp() - start;
+			} while(elapsed < MIN_TIME_NS);
+			double rate = (double)frames * WIDTH * HEIGHT / elapsed;
+			if(isa == PIXEL_ISA_SCALAR) scalar_rate = rate;
+			platform_log(PLATFORM_LOG_LEVEL_INFO, "%s %-6s %6.2f Gpixels/s, %5.2fx scalar",
+			             benches[b].name, pixel_isa_names[isa], rate, rate / scalar_rate);
+		}
+	}
+
+	free(buffers.rgba);
+	free(buffers.src);
+	free(buffers.dst);
+	free(buffers.rgb565);
+	return 0;
+}
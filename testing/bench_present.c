@@ -0,0 +1,108 @@
+#include <platform/platform.h>
+#include "linux/linux_internal.h"
+#include <stdlib.h>
+
+// measures how fast framebuffer pixels reach the X server through MIT-SHM,
+// plain XPutImage and the xcb backend's put_image, for whole frames and for a
+// few damaged rectangles. only the time spent in get_framebuffer and present
+// counts, not drawing. every run ends with a round trip so the server has
+// taken all pixels. to compare against a local server run it under Xvfb, e.g.
+//   Xvfb :99 & DISPLAY=:99 ./bench_present
+#define WIDTH       1280
+#define HEIGHT      720
+#define FRAME_COUNT 200
+#define DAMAGE_SIZE 128 // damaged rectangles are this big on each side
+#define DAMAGE_RECT_COUNT 8
+
+typedef struct {
+	const char* name;
+	uint32_t    backend;
+	int8_t      shm;
+} bench_mode_t;
+
+static const bench_mode_t modes[] = {
+	{ "xlib MIT-SHM       ", PLATFORM_BACKEND_XLIB, 1 },
+	{ "xlib XPutImage     ", PLATFORM_BACKEND_XLIB, 0 },
+	{ "xcb put_image      ", PLATFORM_BACKEND_XCB,  0 },
+};
+
+// returns the bytes presented, the time spent in the platform is added to time
+static uint64_t run(platform_window_t* window, const uint32_t damage_count, uint64_t* time) {
+	platform_rect_t damage[DAMAGE_RECT_COUNT];
+	uint64_t bytes = 0;
+	for(uint32_t frame = 0; frame < FRAME_COUNT; frame++) {
+		uint64_t start = platform_get_timestamp();
+		platform_framebuffer_t framebuffer;
+		platform_window_get_framebuffer(window, &framebuffer);
+		*time += platform_get_timestamp() - start;
+		for(uint32_t i = 0; i < damage_count; i++) {
+			damage[i].x = (frame * 97 + i * 151) % (WIDTH - DAMAGE_SIZE);
+			damage[i].y = (frame * 53 + i * 89) % (HEIGHT - DAMAGE_SIZE);
+			damage[i].width = DAMAGE_SIZE;
+			damage[i].height = DAMAGE_SIZE;
+			for(uint32_t y = 0; y < DAMAGE_SIZE; y++) {
+				uint32_t* row = framebuffer.pixels + (uint64_t)(damage[i].y + y) * framebuffer.stride + damage[i].x;
+				for(uint32_t x = 0; x < DAMAGE_SIZE; x++) row[x] = frame * 0x010203;
+			}
+			bytes += DAMAGE_SIZE * DAMAGE_SIZE * sizeof(uint32_t);
+		}
+		if(damage_count == 0) {
+			for(uint64_t i = 0; i < (uint64_t)framebuffer.stride * framebuffer.height; i++) framebuffer.pixels[i] = frame;
+			bytes += (uint64_t)WIDTH * HEIGHT * sizeof(uint32_t);
+		}
+		start = platform_get_timestamp();
+		platform_window_present(window, damage, damage_count);
+		*time += platform_get_timestamp() - start;
+	}
+	uint64_t start = platform_get_timestamp();
+	// a reply comes after everything sent before it was handled
+	platform_refresh_window_state(window);
+	uint32_t width, height;
+	platform_get_window_size(window, &width, &height);
+	platform_framebuffer_t framebuffer;
+	platform_window_get_framebuffer(window, &framebuffer);
+	*time += platform_get_timestamp() - start;
+	return bytes;
+}
+
+int main(void) {
+	for(uint32_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+		platform_settings_t settings = {0};
+		settings.backend = modes[m].backend;
+		if(!platform_init(&settings)) {
+			platform_log(PLATFORM_LOG_LEVEL_ERROR, "platform_init failed, is a display available?");
+			return 1;
+		}
+		if(modes[m].backend == PLATFORM_BACKEND_XLIB && !modes[m].shm) linux_platform_context.xlib.shm_available = 0;
+		if(modes[m].backend == PLATFORM_BACKEND_XLIB && modes[m].shm && !linux_platform_context.xlib.shm_available) {
+			platform_log(PLATFORM_LOG_LEVEL_WARN, "%s: the server has no MIT-SHM", modes[m].name);
+			platform_shutdown();
+			continue;
+		}
+		platform_window_create_info_t create_info = {0};
+		create_info.name = "bench";
+		create_info.width = WIDTH;
+		create_info.height = HEIGHT;
+		create_info.flags = PLATFORM_WF_UNMAPPED;
+		platform_window_t* window = platform_create_window(create_info, NULL);
+		platform_framebuffer_t framebuffer;
+		if(!platform_window_get_framebuffer(window, &framebuffer)) {
+			platform_log(PLATFORM_LOG_LEVEL_ERROR, "%s: the visual is not supported", modes[m].name);
+			return 1;
+		}
+
+		uint64_t full_time = 0;
+		uint64_t bytes = run(window, 0, &full_time);
+		platform_log(PLATFORM_LOG_LEVEL_INFO, "%s whole frames:     %8.1f MB/s, %6.3f ms per frame",
+		             modes[m].name, bytes / (full_time / 1e3), full_time / 1e6 / FRAME_COUNT);
+
+		uint64_t damage_time = 0;
+		bytes = run(window, DAMAGE_RECT_COUNT, &damage_time);
+		platform_log(PLATFORM_LOG_LEVEL_INFO, "%s %u damaged rects: %8.1f MB/s, %6.3f ms per frame",
+		             modes[m].name, DAMAGE_RECT_COUNT, bytes / (damage_time / 1e3), damage_time / 1e6 / FRAME_COUNT);
+
+		platform_destroy_window(window, NULL);
+		platform_shutdown();
+	}
+	return 0;
+}
@@ -0,0 +1,84 @@
+#include <platform/platform.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <threads.h>
+
+#define LIVE_OBJECTS 1024
+#define OPERATIONS   2000000
+
+typedef struct {
+	platform_allocation_callbacks_t* allocator; // NULL for malloc
+	uint32_t seed;
+} churn_args_t;
+
+static inline uint32_t next_random(uint32_t* state) {
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+// replaces random live objects with new ones of random small sizes
+static int churn(void* data) {
+	churn_args_t* args = data;
+	platform_allocation_callbacks_t* a = args->allocator;
+	void* live[LIVE_OBJECTS] = {0};
+	uint32_t state = args->seed;
+	for(uint32_t i = 0; i < OPERATIONS; i++) {
+		uint32_t index = next_random(&state) % LIVE_OBJECTS;
+		uint64_t size = 16 + next_random(&state) % 496;
+		if(a) {
+			a->free(a->user_data, live[index]);
+			live[index] = a->alloc(a->user_data, size, 16);
+		}
+		else {
+			free(live[index]);
+			live[index] = malloc(size);
+		}
+		*(volatile uint8_t*)live[index] = 1;
+	}
+	for(uint32_t i = 0; i < LIVE_OBJECTS; i++) {
+		if(a) a->free(a->user_data, live[i]);
+		else free(live[i]);
+	}
+	return 0;
+}
+
+static double run(platform_allocation_callbacks_t* allocator, const uint32_t thread_count) {
+	thrd_t threads[16];
+	churn_args_t args[16];
+	uint64_t start = platform_get_timestamp();
+	for(uint32_t i = 0; i < thread_count; i++) {
+		args[i].allocator = allocator;
+		args[i].seed = 0x9e3779b9 * (i + 1);
+		thrd_create(&threads[i], churn, &args[i]);
+	}
+	for(uint32_t i = 0; i < thread_count; i++) thrd_join(threads[i], NULL);
+	uint64_t end = platform_get_timestamp();
+	return (double)(end - start) / ((double)OPERATIONS * thread_count);
+}
+
+int main(void) {
+	platform_slab_allocator_t* slab = platform_slab_allocator_create();
+	if(slab == NULL) return -1;
+	platform_allocation_callbacks_t callbacks = platform_slab_callbacks(slab);
+	// the tracking allocator over the slab one, its overhead is what production builds pay
+	platform_tracking_allocator_t* tracker = platform_tracking_allocator_create("bench", &callbacks);
+	if(tracker == NULL) return -1;
+	platform_allocation_callbacks_t tracked_callbacks = platform_tracking_callbacks(tracker);
+
+	const uint32_t thread_counts[] = { 1, 2, 4, 8, 16 };
+	for(uint32_t i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]); i++) {
+		double malloc_ns = run(NULL, thread_counts[i]);
+		double slab_ns = run(&callbacks, thread_counts[i]);
+		double tracked_ns = run(&tracked_callbacks, thread_counts[i]);
+		char buffer[160];
+		sprintf(buffer, "%2u threads: malloc/free %6.2f ns/op  slab %6.2f ns/op  tracked slab %6.2f ns/op (%+.1f%%)\n", thread_counts[i],
+		        malloc_ns, slab_ns, tracked_ns, (tracked_ns - slab_ns) / slab_ns * 100.0);
+		platform_terminal_print(buffer, 0, 0, 0);
+	}
+
+	platform_tracking_allocator_destroy(tracker);
+	platform_slab_allocator_destroy(slab);
+	return 0;
+}
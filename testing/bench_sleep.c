@@ -0,0 +1,53 @@
+#include <platform/platform.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define FRAMES 500
+#define PERIOD_MS 4
+
+static int compare_u64(const void* a, const void* b) {
+	uint64_t x = *(const uint64_t*)a;
+	uint64_t y = *(const uint64_t*)b;
+	return (x > y) - (x < y);
+}
+
+// lateness[i] is how far frame i woke up past its ideal deadline
+static void report(const char* name, uint64_t* lateness, const uint64_t drift) {
+	qsort(lateness, FRAMES, sizeof(uint64_t), compare_u64);
+	char buffer[256];
+	sprintf(buffer, "%-28s p50 %8.1f us  p90 %8.1f us  p99 %8.1f us  max %8.1f us  drift %10.1f us\n", name,
+	        lateness[FRAMES / 2] / 1000.0, lateness[FRAMES * 9 / 10] / 1000.0,
+	        lateness[FRAMES * 99 / 100] / 1000.0, lateness[FRAMES - 1] / 1000.0, drift / 1000.0);
+	platform_terminal_print(buffer, 0, 0, 0);
+}
+
+static uint64_t lateness[FRAMES];
+
+int main(void) {
+	const uint64_t period = PERIOD_MS * 1000000ull;
+
+	// relative sleeps: each frame's error is carried into the next
+	uint64_t start = platform_get_timestamp();
+	uint64_t previous = start;
+	for(uint32_t i = 0; i < FRAMES; i++) {
+		platform_sleep_miliseconds(PERIOD_MS);
+		uint64_t now = platform_get_timestamp();
+		lateness[i] = now - previous - period;
+		previous = now;
+	}
+	report("platform_sleep_miliseconds", lateness, previous - start - FRAMES * period);
+
+	platform_frame_pacer_t pacer;
+	platform_frame_pacer_init(&pacer, period);
+	uint64_t now = 0;
+	uint64_t deadline = 0;
+	for(uint32_t i = 0; i < FRAMES; i++) {
+		deadline = platform_frame_pacer_wait(&pacer);
+		now = platform_get_timestamp();
+		lateness[i] = now - deadline;
+	}
+	// deadlines stay on the grid, so the error never accumulates past the last frame's
+	report("platform_frame_pacer_wait", lateness, now - deadline);
+
+	return 0;
+}
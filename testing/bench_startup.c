@@ -0,0 +1,82 @@
+#include <platform/platform.h>
+#include <stdlib.h>
+
+// measures platform_init, window creation and a window state query for every
+// backend, most of it is spent waiting on the X server. to compare against a
+// local server run it under Xvfb, e.g.
+//   Xvfb :99 & DISPLAY=:99 ./bench_startup
+#define ITERATIONS 50
+// work done between asking for the window state and reading it
+#define QUERY_WORK_NS 1000000
+
+static const struct {
+	const char* name;
+	uint32_t    backend;
+} backends[] = {
+	{ "xlib    ", PLATFORM_BACKEND_XLIB },
+	{ "xcb     ", PLATFORM_BACKEND_XCB },
+	// the platform's own share of the cost
+	{ "headless", PLATFORM_BACKEND_HEADLESS },
+};
+
+static int compare(const void* a, const void* b) {
+	uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+	return (x > y) - (x < y);
+}
+
+static void report(const char* backend, const char* what, uint64_t* times) {
+	qsort(times, ITERATIONS, sizeof(times[0]), compare);
+	uint64_t total = 0;
+	for(uint32_t i = 0; i < ITERATIONS; i++) total += times[i];
+	platform_log(PLATFORM_LOG_LEVEL_INFO, "%s %-22s over %u runs: min %.3f ms, median %.3f ms, mean %.3f ms, max %.3f ms",
+	             backend, what, ITERATIONS, times[0] / 1e6, times[ITERATIONS / 2] / 1e6, total / (ITERATIONS * 1e6), times[ITERATIONS - 1] / 1e6);
+}
+
+int main(void) {
+	for(uint32_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++) {
+		platform_settings_t settings = {0};
+		settings.backend = backends[b].backend;
+		uint64_t init_times[ITERATIONS];
+		uint64_t window_times[ITERATIONS];
+		uint64_t query_times[ITERATIONS];
+		uint32_t i = 0;
+		for(; i < ITERATIONS; i++) {
+			uint64_t start = platform_get_timestamp();
+			if(!platform_init(&settings)) {
+				platform_log(PLATFORM_LOG_LEVEL_ERROR, "%s platform_init failed, is a display available?", backends[b].name);
+				break;
+			}
+			init_times[i] = platform_get_timestamp() - start;
+
+			platform_window_create_info_t create_info = {0};
+			create_info.name = "bench";
+			create_info.width = 64;
+			create_info.height = 64;
+			create_info.flags = PLATFORM_WF_UNMAPPED;
+			start = platform_get_timestamp();
+			platform_window_t* window = platform_create_window(create_info, NULL);
+			platform_handle_events();
+			window_times[i] = platform_get_timestamp() - start;
+
+			// only the time spent inside the calls counts, the xcb backend
+			// overlaps the round trip with the work in between
+			start = platform_get_timestamp();
+			platform_refresh_window_state(window);
+			uint64_t blocked = platform_get_timestamp() - start;
+			uint64_t work_end = platform_get_timestamp() + QUERY_WORK_NS;
+			while(platform_get_timestamp() < work_end);
+			start = platform_get_timestamp();
+			uint32_t width, height;
+			platform_get_window_size(window, &width, &height);
+			query_times[i] = blocked + platform_get_timestamp() - start;
+
+			platform_destroy_window(window, NULL);
+			platform_shutdown();
+		}
+		if(i != ITERATIONS) continue;
+		report(backends[b].name, "platform_init", init_times);
+		report(backends[b].name, "create window", window_times);
+		report(backends[b].name, "refresh window state", query_times);
+	}
+	return 0;
+}
@@ -0,0 +1,235 @@
+#include <platform/platform.h>
+#include <stdio.h>
+
+// presents frames that only clear the image with every latency policy and
+// reports the present mode it ended up with and where the time went. halfway
+// through the window is resized so the swapchain gets recreated. runs on any
+// driver, including lavapipe under Xvfb
+#define FRAMES 300
+
+typedef struct {
+	VkInstance       instance;
+	VkSurfaceKHR     surface;
+	VkPhysicalDevice physical_device;
+	uint32_t         queue_family;
+	VkDevice         device;
+	VkQueue          queue;
+	VkCommandPool    command_pool;
+	VkCommandBuffer  command_buffers[PLATFORM_SWAPCHAIN_MAX_FRAMES];
+} context_t;
+
+static const char* present_mode_name(const VkPresentModeKHR mode) {
+	switch(mode) {
+	case VK_PRESENT_MODE_IMMEDIATE_KHR: return "immediate";
+	case VK_PRESENT_MODE_MAILBOX_KHR:   return "mailbox";
+	case VK_PRESENT_MODE_FIFO_KHR:      return "fifo";
+	default:                            return "other";
+	}
+}
+
+static int8_t init_vulkan(context_t* context, platform_window_t* window) {
+	uint32_t extension_count;
+	char** extensions = platform_vulkan_required_extensions(&extension_count);
+	VkApplicationInfo app_info = {0};
+	app_info.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+	app_info.pApplicationName = "bench_swapchain";
+	app_info.apiVersion = VK_API_VERSION_1_0;
+	VkInstanceCreateInfo instance_info = {0};
+	instance_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+	instance_info.pApplicationInfo = &app_info;
+	instance_info.enabledExtensionCount = extension_count;
+	instance_info.ppEnabledExtensionNames = (const char* const*)extensions;
+	if(vkCreateInstance(&instance_info, NULL, &context->instance) != VK_SUCCESS) return 0;
+	context->surface = platform_vulkan_create_surface(window, context->instance);
+	if(context->surface == VK_NULL_HANDLE) return 0;
+
+	// the first device with a queue that can draw and present
+	VkPhysicalDevice devices[16];
+	uint32_t device_count = 16;
+	vkEnumeratePhysicalDevices(context->instance, &device_count, devices);
+	context->physical_device = VK_NULL_HANDLE;
+	for(uint32_t i = 0; i < device_count && context->physical_device == VK_NULL_HANDLE; i++) {
+		VkQueueFamilyProperties families[16];
+		uint32_t family_count = 16;
+		vkGetPhysicalDeviceQueueFamilyProperties(devices[i], &family_count, families);
+		for(uint32_t f = 0; f < family_count; f++) {
+			VkBool32 present = VK_FALSE;
+			vkGetPhysicalDeviceSurfaceSupportKHR(devices[i], f, context->surface, &present);
+			if(present && (families[f].queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
+				context->physical_device = devices[i];
+				context->queue_family = f;
+				break;
+			}
+		}
+	}
+	if(context->physical_device == VK_NULL_HANDLE) return 0;
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(context->physical_device, &properties);
+	platform_log(PLATFORM_LOG_LEVEL_INFO, "device: %s", properties.deviceName);
+
+	float priority = 1.0f;
+	VkDeviceQueueCreateInfo queue_info = {0};
+	queue_info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+	queue_info.queueFamilyIndex = context->queue_family;
+	queue_info.queueCount = 1;
+	queue_info.pQueuePriorities = &priority;
+	const char* device_extensions[] = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+	VkDeviceCreateInfo device_info = {0};
+	device_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	device_info.queueCreateInfoCount = 1;
+	device_info.pQueueCreateInfos = &queue_info;
+	device_info.enabledExtensionCount = 1;
+	device_info.ppEnabledExtensionNames = device_extensions;
+	if(vkCreateDevice(context->physical_device, &device_info, NULL, &context->device) != VK_SUCCESS) return 0;
+	vkGetDeviceQueue(context->device, context->queue_family, 0, &context->queue);
+
+	VkCommandPoolCreateInfo pool_info = {0};
+	pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	pool_info.queueFamilyIndex = context->queue_family;
+	if(vkCreateCommandPool(context->device, &pool_info, NULL, &context->command_pool) != VK_SUCCESS) return 0;
+	VkCommandBufferAllocateInfo allocate_info = {0};
+	allocate_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocate_info.commandPool = context->command_pool;
+	allocate_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocate_info.commandBufferCount = PLATFORM_SWAPCHAIN_MAX_FRAMES;
+	return vkAllocateCommandBuffers(context->device, &allocate_info, context->command_buffers) == VK_SUCCESS;
+}
+
+static void cleanup_vulkan(context_t* context) {
+	if(context->device != VK_NULL_HANDLE) {
+		vkDestroyCommandPool(context->device, context->command_pool, NULL);
+		vkDestroyDevice(context->device, NULL);
+	}
+	if(context->surface != VK_NULL_HANDLE) vkDestroySurfaceKHR(context->instance, context->surface, NULL);
+	if(context->instance != VK_NULL_HANDLE) vkDestroyInstance(context->instance, NULL);
+}
+
+static void image_barrier(VkCommandBuffer command_buffer, VkImage image, VkImageLayout from, VkImageLayout to,
+                          VkAccessFlags src_access, VkAccessFlags dst_access, VkPipelineStageFlags src_stage, VkPipelineStageFlags dst_stage) {
+	VkImageMemoryBarrier barrier = {0};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcAccessMask = src_access;
+	barrier.dstAccessMask = dst_access;
+	barrier.oldLayout = from;
+	barrier.newLayout = to;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.layerCount = 1;
+	vkCmdPipelineBarrier(command_buffer, src_stage, dst_stage, 0, 0, NULL, 0, NULL, 1, &barrier);
+}
+
+static void draw_frame(context_t* context, const platform_swapchain_frame_t* frame, const uint32_t index) {
+	VkCommandBuffer command_buffer = context->command_buffers[frame->frame_index];
+	vkResetCommandBuffer(command_buffer, 0);
+	VkCommandBufferBeginInfo begin_info = {0};
+	begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(command_buffer, &begin_info);
+	image_barrier(command_buffer, frame->image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+	              0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+	VkClearColorValue color = { { (index % 64) / 64.0f, 0.2f, 0.4f, 1.0f } };
+	VkImageSubresourceRange range = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+	vkCmdClearColorImage(command_buffer, frame->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &color, 1, &range);
+	image_barrier(command_buffer, frame->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+	              VK_ACCESS_TRANSFER_WRITE_BIT, 0, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+	vkEndCommandBuffer(command_buffer);
+
+	// the layout change at the start waits for the image to be acquired
+	VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	VkSubmitInfo submit_info = {0};
+	submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submit_info.waitSemaphoreCount = 1;
+	submit_info.pWaitSemaphores = &frame->image_available;
+	submit_info.pWaitDstStageMask = &wait_stage;
+	submit_info.commandBufferCount = 1;
+	submit_info.pCommandBuffers = &command_buffer;
+	submit_info.signalSemaphoreCount = 1;
+	submit_info.pSignalSemaphores = &frame->render_finished;
+	vkQueueSubmit(context->queue, 1, &submit_info, frame->fence);
+}
+
+static void run(context_t* context, platform_window_t* window, const uint32_t latency, const char* name) {
+	platform_set_window_size(window, 640, 480);
+	platform_handle_events();
+	platform_swapchain_create_info_t create_info = {0};
+	create_info.physical_device = context->physical_device;
+	create_info.device = context->device;
+	create_info.present_queue = context->queue;
+	create_info.surface = context->surface;
+	create_info.window = window;
+	create_info.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	create_info.latency = latency;
+	create_info.frames_in_flight = 2;
+	platform_swapchain_t* swapchain = platform_swapchain_create(&create_info, NULL);
+	if(swapchain == NULL) {
+		platform_log(PLATFORM_LOG_LEVEL_ERROR, "%s: could not create the swapchain", name);
+		return;
+	}
+
+	platform_swapchain_timing_t sum = {0}, timing;
+	uint32_t presented = 0, skipped = 0;
+	uint64_t start = platform_get_timestamp();
+	for(uint32_t i = 0; i < FRAMES && !platform_window_should_close(window); i++) {
+		if(i == FRAMES / 2) platform_set_window_size(window, 800, 600);
+		platform_handle_events();
+		platform_event_t event;
+		while(platform_poll_event(&event));
+		platform_swapchain_frame_t frame;
+		if(!platform_swapchain_acquire(swapchain, &frame)) {
+			skipped++;
+			continue;
+		}
+		draw_frame(context, &frame, i);
+		platform_swapchain_present(swapchain);
+		platform_swapchain_get_timing(swapchain, &timing);
+		sum.fence_wait_ns += timing.fence_wait_ns;
+		sum.acquire_ns += timing.acquire_ns;
+		sum.cpu_ns += timing.cpu_ns;
+		sum.present_ns += timing.present_ns;
+		presented++;
+	}
+	uint64_t elapsed = platform_get_timestamp() - start;
+	VkPresentModeKHR mode = platform_swapchain_present_mode(swapchain);
+	platform_swapchain_destroy(swapchain, NULL);
+	if(presented == 0) {
+		platform_log(PLATFORM_LOG_LEVEL_WARN, "%s: nothing was presented", name);
+		return;
+	}
+	platform_log(PLATFORM_LOG_LEVEL_INFO, "%s %-9s %7.1f fps, per frame: fence wait %6.3f ms, acquire %6.3f ms, cpu %6.3f ms, present %6.3f ms, %u skipped",
+	             name, present_mode_name(mode), presented * 1e9 / elapsed,
+	             sum.fence_wait_ns / 1e6 / presented, sum.acquire_ns / 1e6 / presented, sum.cpu_ns / 1e6 / presented,
+	             sum.present_ns / 1e6 / presented, skipped);
+}
+
+int main(void) {
+	if(!platform_init(NULL)) {
+		platform_log(PLATFORM_LOG_LEVEL_ERROR, "platform_init failed, is a display available?");
+		return 1;
+	}
+	platform_window_create_info_t window_info = {0};
+	window_info.name = "bench_swapchain";
+	window_info.width = 640;
+	window_info.height = 480;
+	platform_window_t* window = platform_create_window(window_info, NULL);
+	context_t context = {0};
+	if(window == NULL || !init_vulkan(&context, window)) {
+		platform_log(PLATFORM_LOG_LEVEL_ERROR, "could not set up vulkan");
+		cleanup_vulkan(&context);
+		if(window != NULL) platform_destroy_window(window, NULL);
+		platform_shutdown();
+		return 1;
+	}
+
+	run(&context, window, PLATFORM_LATENCY_VSYNC, "vsync ");
+	run(&context, window, PLATFORM_LATENCY_LOW, "low   ");
+	run(&context, window, PLATFORM_LATENCY_LOWEST, "lowest");
+
+	cleanup_vulkan(&context);
+	platform_destroy_window(window, NULL);
+	platform_shutdown();
+	return 0;
+}
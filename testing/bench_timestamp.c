@@ -0,0 +1,41 @@
+#include <platform/platform.h>
+#include <stdio.h>
+
+#define ITERATIONS 10000000
+
+typedef uint64_t (*timestamp_fn)(void);
+
+static void bench(const char* name, timestamp_fn fn) {
+	volatile uint64_t sink = 0;
+	uint64_t start = platform_get_timestamp();
+	for(uint32_t i = 0; i < ITERATIONS; i++) sink += fn();
+	uint64_t end = platform_get_timestamp();
+
+	char buffer[128];
+	sprintf(buffer, "%-40s %6.2f ns/call\n", name, (double)(end - start) / ITERATIONS);
+	platform_terminal_print(buffer, 0, 0, 0);
+}
+
+int main(void) {
+	bench("platform_get_timestamp", platform_get_timestamp);
+	bench("platform_get_fast_timestamp (fallback)", platform_get_fast_timestamp);
+
+	if(platform_calibrate_fast_timestamp(100)) {
+		char buffer[128];
+		sprintf(buffer, "calibrated tick frequency: %llu Hz\n",
+		        (unsigned long long)platform_get_fast_timestamp_tick_frequency());
+		platform_terminal_print(buffer, PLATFORM_COLOR_GREEN, 0, 0);
+		bench("platform_get_fast_timestamp (ticks)", platform_get_fast_timestamp);
+
+		// drift between the two clocks after calibration
+		platform_sleep_miliseconds(500);
+		int64_t drift = (int64_t)(platform_get_fast_timestamp() - platform_get_timestamp());
+		sprintf(buffer, "drift after 500 ms: %lld ns\n", (long long)drift);
+		platform_terminal_print(buffer, 0, 0, 0);
+	}
+	else {
+		platform_terminal_print("no invariant tick counter, fast timestamp unavailable\n", PLATFORM_COLOR_YELLOW, 0, 0);
+	}
+
+	return 0;
+}
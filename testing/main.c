@@ -20,16 +20,33 @@ int main(void) {
 
 	platform_window_t* window = platform_create_window(create_info, NULL);
 	if(window == NULL) return platform_shutdown(), 0;
+	platform_log(PLATFORM_LOG_LEVEL_INFO, "created \"%s\" at %d, %d (%ux%u)", create_info.name, create_info.x, create_info.y, create_info.width, create_info.height);
 
+	platform_terminal_status_begin(1, 30);
 	uint32_t i = 0;
 	while(!platform_window_should_close(window)) {
-		platform_handle_events();
+		// waits for one refresh of whichever monitor the window is on
+		uint64_t frame_ns = 16000000;
+		platform_monitor_t monitor;
+		if(platform_window_get_monitor(window, &monitor) && monitor.refresh_mhz != 0) {
+			frame_ns = 1000000000000ull / monitor.refresh_mhz;
+		}
+		platform_wait_events(frame_ns);
+		platform_event_t event;
+		while(platform_poll_event(&event)) {
+			if(event.type == PLATFORM_EVENT_RESIZE) {
+				platform_log(PLATFORM_LOG_LEVEL_DEBUG, "resized to %ux%u", event.resize.width, event.resize.height);
+			}
+			else if(event.type == PLATFORM_EVENT_KEY_DOWN && !event.key.repeat) {
+				platform_log(PLATFORM_LOG_LEVEL_DEBUG, "key %u (scancode %u) pressed", event.key.key, event.key.scancode);
+			}
+		}
 		char buffer[32] = {0};
-		sprintf(buffer, "\rIteration: %d", i++);
-		platform_terminal_print(buffer, PLATFORM_COLOR_BLUE, 0, PLATFORM_TEXT_BOLD);
-		putchar('\r'); // TODO: This works only when a newly printed line is longer than the Iteration counter line
-		platform_sleep_miliseconds(16);
+		sprintf(buffer, "Iteration: %d", i++);
+		platform_terminal_status_set_line(0, buffer, PLATFORM_COLOR_BLUE, 0, PLATFORM_TEXT_BOLD);
+		platform_terminal_status_update();
 	}
+	platform_terminal_status_end();
 
 	platform_destroy_window(window, NULL);
 	platform_shutdown();